@@ -154,6 +154,8 @@ function Player.transferMoneyTo(self, target, amount)
 	if targetPlayer then
 		targetPlayer:setBankBalance(targetPlayer:getBankBalance() + amount)
 	else
+		-- a cached offline copy would overwrite the new balance when it is saved
+		Game.releaseOfflinePlayer(target.guid)
 		db.query("UPDATE `players` SET `balance` = `balance` + " .. amount .. " WHERE `id` = '" .. target.guid .. "'")
 	end
 
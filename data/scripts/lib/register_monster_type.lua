@@ -160,6 +160,19 @@ registerMonsterType.targetDistance = function(mtype, mask)
 	end
 end
 
+registerMonsterType.factions = function(mtype, mask)
+	if not mask.factions then
+		return
+	end
+
+	if mask.factions.friends then
+		mtype:friendFactions(mask.factions.friends)
+	end
+	if mask.factions.opponents then
+		mtype:opponentFactions(mask.factions.opponents)
+	end
+end
+
 registerMonsterType.staticAttackChance = function(mtype, mask)
 	if mask.staticAttackChance then
 		mtype:staticAttackChance(mask.staticAttackChance)
@@ -7,6 +7,9 @@ local reloadTypes = {
 	["augment"] = RELOAD_TYPE_AUGMENTS,
 	["augments"] = RELOAD_TYPE_AUGMENTS,
 
+	["ban"] = RELOAD_TYPE_BANS,
+	["bans"] = RELOAD_TYPE_BANS,
+
 	["chat"] = RELOAD_TYPE_CHAT,
 	["channel"] = RELOAD_TYPE_CHAT,
 	["chatchannels"] = RELOAD_TYPE_CHAT,
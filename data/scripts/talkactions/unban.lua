@@ -8,9 +8,10 @@ local function onSay(player, words, param)
 		return false
 	end
 
-	db.asyncQuery("DELETE FROM `account_bans` WHERE `account_id` = " .. result.getNumber(resultId, "account_id"))
-	db.asyncQuery("DELETE FROM `ip_bans` WHERE `ip` = " .. result.getNumber(resultId, "lastip"))
+	db.query("DELETE FROM `account_bans` WHERE `account_id` = " .. result.getNumber(resultId, "account_id"))
+	db.query("DELETE FROM `ip_bans` WHERE `ip` = " .. result.getNumber(resultId, "lastip"))
 	result.free(resultId)
+	Game.reload(RELOAD_TYPE_BANS)
 	player:sendTextMessage(MESSAGE_EVENT_ADVANCE, param .. " has been unbanned.")
 	return false
 end
@@ -140,3 +140,108 @@ project "Black-Tek-Server"
     -- macOS-specific settings
     filter { "system:macosx", "action:gmake" }
         buildoptions { "-fvisibility=hidden" }
+
+-- Settings shared by the tool projects, call right after `project`; the
+-- project adds its files, includes and links afterwards
+function toolProject(name)
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    targetdir "%{wks.location}"
+    objdir("build/%{cfg.buildcfg}/" .. name)
+    location ""
+
+    if _OPTIONS["custom-includes"] then
+        includedirs { string.explode(_OPTIONS["custom-includes"], ",") }
+    end
+
+    if _OPTIONS["custom-libs"] then
+        libdirs { string.explode(_OPTIONS["custom-libs"], ",") }
+    end
+
+    filter "configurations:Debug"
+        defines { "DEBUG" }
+        symbols "On"
+        optimize "Debug"
+
+    filter "configurations:Release"
+        defines { "NDEBUG" }
+        optimize "Full"
+
+    filter "platforms:64"
+        architecture "x86_64"
+
+    filter "platforms:ARM64"
+        architecture "ARM64"
+
+    filter "platforms:ARM"
+        architecture "ARM"
+
+    filter "architecture:x86_64"
+        vectorextensions "AVX"
+
+    filter "system:windows"
+        vsprops { VcpkgEnableManifest = "true" }
+
+    filter { "system:linux", "architecture:x86_64" }
+        libdirs { "vcpkg_installed/x64-linux/lib" }
+        includedirs { "vcpkg_installed/x64-linux/include" }
+
+    filter { "system:linux", "architecture:ARM64" }
+        libdirs { "vcpkg_installed/arm64-linux/lib" }
+        includedirs { "vcpkg_installed/arm64-linux/include" }
+
+    filter { "system:linux", "architecture:ARM" }
+        libdirs { "vcpkg_installed/arm-linux/lib" }
+        includedirs { "vcpkg_installed/arm-linux/include" }
+
+    filter {}
+end
+
+-- Offline world-tick simulator, the game core in simulated time without sockets or a database
+project "simulator"
+    toolProject("simulator")
+    files { "src/**.cpp", "src/**.h", "tools/simulator/**.cpp", "tools/simulator/**.h" }
+    removefiles { "src/otserv.cpp" }
+    includedirs { "src", "tools/simulator" }
+    flags { "MultiProcessorCompile" }
+    enableunitybuild "On"
+    intrinsics "On"
+
+    -- symbols stay on so profilers can attribute the samples
+    filter "configurations:Release"
+        symbols "On"
+
+    filter "system:not windows"
+        buildoptions { "-pipe", "-fno-omit-frame-pointer" }
+
+    filter "system:windows"
+        openmp "On"
+        characterset "MBCS"
+        buildoptions { "/bigobj", "/utf-8" }
+
+    filter "system:linux"
+        libdirs { "/usr/lib" }
+        includedirs { "/usr/include", "/usr/include/lua5.*" }
+        links { "pugixml", _OPTIONS["lua"], "fmt", "mariadb", "cryptopp", "boost_iostreams", "zstd", "z", "curl", "ssl", "crypto" }
+
+    filter "toolset:gcc"
+        buildoptions { "-fno-strict-aliasing" }
+
+-- Replays packet captures (packetCaptureDirectory) against a test world
+project "replay"
+    toolProject("replay")
+    files { "tools/replay/**.cpp", "tools/replay/**.h", "tools/common/**.cpp", "tools/common/**.h", "src/xtea.cpp", "src/adler32.cpp", "src/rsa.cpp" }
+    includedirs { "src", "tools/common" }
+
+    filter "system:linux"
+        links { "fmt", "cryptopp", "pthread" }
+
+-- Headless load-generator bots playing scripted profiles against a test world
+project "bots"
+    toolProject("bots")
+    files { "tools/bots/**.cpp", "tools/bots/**.h", "tools/common/**.cpp", "tools/common/**.h", "src/xtea.cpp", "src/adler32.cpp", "src/rsa.cpp" }
+    includedirs { "src", "tools/common" }
+
+    filter "system:linux"
+        links { "fmt", "cryptopp", "pthread" }
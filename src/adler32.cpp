@@ -0,0 +1,241 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "adler32.h"
+#include "const.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define ADLER_AVX2
+#if defined(__SSSE3__) || defined(__AVX__)
+#define ADLER_SSSE3
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ADLER_NEON
+#endif
+
+#if defined(ADLER_AVX2) && !defined(_MSC_VER)
+#define ADLER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define ADLER_AVX2_TARGET
+#endif
+
+namespace {
+
+constexpr uint32_t ADLER_BASE = 65521;
+// largest number of bytes that can be summed before b overflows 32 bits
+constexpr size_t ADLER_NMAX = 5552;
+
+uint32_t adlerScalar(uint32_t adler, const uint8_t* data, size_t length)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+
+	while (length > 0) {
+		size_t tmp = std::min(length, ADLER_NMAX);
+		length -= tmp;
+
+		do {
+			a += *data++;
+			b += a;
+		} while (--tmp);
+
+		a %= ADLER_BASE;
+		b %= ADLER_BASE;
+	}
+
+	return (b << 16) | a;
+}
+
+// The vector versions sum 32 (16 on NEON) byte chunks: a gets the plain byte sums,
+// b gets the bytes weighted by their distance to the chunk end plus the chunk size
+// times every previous value of a, kept apart in vps and scaled once per block.
+
+#ifdef ADLER_SSSE3
+uint32_t adlerSSSE3(uint32_t adler, const uint8_t* data, size_t length)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	size_t blocks = length / 32;
+	length -= blocks * 32;
+
+	const __m128i tapsLow = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+	const __m128i tapsHigh = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+
+	while (blocks > 0) {
+		size_t n = std::min(blocks, ADLER_NMAX / 32);
+		blocks -= n;
+
+		__m128i vps = _mm_setr_epi32(static_cast<int>(a * n), 0, 0, 0);
+		__m128i vs1 = zero;
+		__m128i vs2 = _mm_setr_epi32(static_cast<int>(b), 0, 0, 0);
+		do {
+			const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+			vps = _mm_add_epi32(vps, vs1);
+			vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(low, zero));
+			vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(low, tapsLow), ones));
+			vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(high, zero));
+			vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(high, tapsHigh), ones));
+			data += 32;
+		} while (--n);
+		vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vps, 5));
+
+		vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+		vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(2, 3, 0, 1)));
+		vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+		vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+		a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(vs1))) % ADLER_BASE;
+		b = static_cast<uint32_t>(_mm_cvtsi128_si32(vs2)) % ADLER_BASE;
+	}
+
+	return adlerScalar((b << 16) | a, data, length);
+}
+#endif
+
+#ifdef ADLER_AVX2
+ADLER_AVX2_TARGET uint32_t adlerAVX2(uint32_t adler, const uint8_t* data, size_t length)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	size_t blocks = length / 32;
+	length -= blocks * 32;
+
+	const __m256i taps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+	                                      16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi16(1);
+
+	while (blocks > 0) {
+		size_t n = std::min(blocks, ADLER_NMAX / 32);
+		blocks -= n;
+
+		__m256i vps = _mm256_setr_epi32(static_cast<int>(a * n), 0, 0, 0, 0, 0, 0, 0);
+		__m256i vs1 = zero;
+		__m256i vs2 = _mm256_setr_epi32(static_cast<int>(b), 0, 0, 0, 0, 0, 0, 0);
+		do {
+			const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+			vps = _mm256_add_epi32(vps, vs1);
+			vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(bytes, zero));
+			vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, taps), ones));
+			data += 32;
+		} while (--n);
+		vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(vps, 5));
+
+		__m128i s1 = _mm_add_epi32(_mm256_castsi256_si128(vs1), _mm256_extracti128_si256(vs1, 1));
+		__m128i s2 = _mm_add_epi32(_mm256_castsi256_si128(vs2), _mm256_extracti128_si256(vs2, 1));
+		s1 = _mm_add_epi32(s1, _mm_shuffle_epi32(s1, _MM_SHUFFLE(1, 0, 3, 2)));
+		s1 = _mm_add_epi32(s1, _mm_shuffle_epi32(s1, _MM_SHUFFLE(2, 3, 0, 1)));
+		s2 = _mm_add_epi32(s2, _mm_shuffle_epi32(s2, _MM_SHUFFLE(1, 0, 3, 2)));
+		s2 = _mm_add_epi32(s2, _mm_shuffle_epi32(s2, _MM_SHUFFLE(2, 3, 0, 1)));
+		a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(s1))) % ADLER_BASE;
+		b = static_cast<uint32_t>(_mm_cvtsi128_si32(s2)) % ADLER_BASE;
+	}
+
+	return adlerScalar((b << 16) | a, data, length);
+}
+
+bool hasAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// the OS has to save the ymm registers too
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef ADLER_NEON
+uint32_t adlerNEON(uint32_t adler, const uint8_t* data, size_t length)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	size_t blocks = length / 16;
+	length -= blocks * 16;
+
+	static constexpr uint8_t tapValues[16] = {16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+	const uint8x16_t taps = vld1q_u8(tapValues);
+	const uint32x4_t zero = vdupq_n_u32(0);
+
+	while (blocks > 0) {
+		size_t n = std::min(blocks, ADLER_NMAX / 16);
+		blocks -= n;
+
+		uint32x4_t vps = vsetq_lane_u32(static_cast<uint32_t>(a * n), zero, 0);
+		uint32x4_t vs1 = zero;
+		uint32x4_t vs2 = vsetq_lane_u32(b, zero, 0);
+		do {
+			const uint8x16_t bytes = vld1q_u8(data);
+			vps = vaddq_u32(vps, vs1);
+			vs1 = vpadalq_u16(vs1, vpaddlq_u8(bytes));
+			uint16x8_t products = vmull_u8(vget_low_u8(bytes), vget_low_u8(taps));
+			products = vmlal_u8(products, vget_high_u8(bytes), vget_high_u8(taps));
+			vs2 = vpadalq_u16(vs2, products);
+			data += 16;
+		} while (--n);
+		vs2 = vaddq_u32(vs2, vshlq_n_u32(vps, 4));
+
+		const uint32x2_t s1 = vpadd_u32(vget_low_u32(vs1), vget_high_u32(vs1));
+		const uint32x2_t s2 = vpadd_u32(vget_low_u32(vs2), vget_high_u32(vs2));
+		a = (a + vget_lane_u32(s1, 0) + vget_lane_u32(s1, 1)) % ADLER_BASE;
+		b = (vget_lane_u32(s2, 0) + vget_lane_u32(s2, 1)) % ADLER_BASE;
+	}
+
+	return adlerScalar((b << 16) | a, data, length);
+}
+#endif
+
+using AdlerFunction = uint32_t(*)(uint32_t, const uint8_t*, size_t);
+
+AdlerFunction selectAdler()
+{
+#ifdef ADLER_AVX2
+	if (hasAVX2()) {
+		return adlerAVX2;
+	}
+#endif
+
+#if defined(ADLER_SSSE3)
+	return adlerSSSE3;
+#elif defined(ADLER_NEON)
+	return adlerNEON;
+#else
+	return adlerScalar;
+#endif
+}
+
+const AdlerFunction adlerImplementation = selectAdler();
+
+}
+
+uint32_t adlerUpdate(uint32_t adler, const uint8_t* data, size_t length)
+{
+	return adlerImplementation(adler, data, length);
+}
+
+uint32_t adlerChecksum(const uint8_t* data, size_t length)
+{
+	if (length > NETWORKMESSAGE_MAXSIZE) {
+		return 0;
+	}
+
+	return adlerUpdate(1, data, length);
+}
@@ -0,0 +1,13 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_ADLER32_H
+#define FS_ADLER32_H
+
+/** Continues an Adler-32 checksum, start from 1 for a new one.
+ * Uses the widest SIMD implementation the CPU supports.
+ */
+uint32_t adlerUpdate(uint32_t adler, const uint8_t* data, size_t length);
+uint32_t adlerChecksum(const uint8_t* data, size_t length);
+
+#endif
@@ -6,23 +6,90 @@
 #include "ban.h"
 #include "database.h"
 #include "databasetasks.h"
+#include "scheduler.h"
 #include "tools.h"
 
 #include <fmt/format.h>
+#include <queue>
+#include <shared_mutex>
 
-bool Ban::acceptConnection(uint32_t clientIP)
+namespace {
+
+// connection attempts are counted over this window, see Ban::acceptConnection
+constexpr uint64_t CONNECT_WINDOW = 5000;
+constexpr uint32_t CONNECT_SWEEP_INTERVAL = 60 * 1000;
+
+// splitmix64 finalizer, spreads neighbouring addresses over shards and slots
+uint64_t mixConnectKey(uint64_t key)
+{
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
+}
+
+}
+
+bool Ban::ConnectBlock::isExpired(const uint64_t currentTime) const
+{
+	return key == 0 || (blockTime <= currentTime && currentTime - lastAttempt > CONNECT_WINDOW);
+}
+
+bool Ban::acceptConnection(const boost::asio::ip::address& address)
+{
+	if (address.is_v4()) {
+		return acceptConnection(static_cast<uint64_t>(address.to_v4().to_uint()) + 1);
+	}
+
+	// IPv6 clients are limited per /64 network, the high bit keeps the keys apart from IPv4
+	const auto bytes = address.to_v6().to_bytes();
+	uint64_t prefix = 0;
+	for (size_t i = 0; i < 8; ++i) {
+		prefix = (prefix << 8) | bytes[i];
+	}
+	return acceptConnection(prefix | (1ULL << 63));
+}
+
+bool Ban::acceptConnection(const uint64_t key)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(lock);
+	const uint64_t hash = mixConnectKey(key);
+	Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+
+	std::lock_guard<std::mutex> lockClass(shard.lock);
 
-	uint64_t currentTime = OTSYS_TIME();
+	const uint64_t currentTime = OTSYS_TIME();
 
-	auto it = ipConnectMap.find(clientIP);
-	if (it == ipConnectMap.end()) {
-		ipConnectMap.emplace(clientIP, ConnectBlock(currentTime, 0, 1));
+	// free or expired entries go first, then unblocked ones, blocked ones last: a blocked
+	// entry keeps its lastAttempt, so by age alone a flood of new addresses would evict it
+	const auto evictionRank = [currentTime](const ConnectBlock& block) {
+		if (block.isExpired(currentTime)) {
+			return 0;
+		}
+		return block.blockTime > currentTime ? 2 : 1;
+	};
+
+	ConnectBlock* victim = nullptr;
+	int victimRank = 0;
+	for (size_t i = 0; i < PROBE_LENGTH; ++i) {
+		ConnectBlock& block = shard.blocks[(hash + i) & (SHARD_CAPACITY - 1)];
+		if (block.key == key) {
+			victim = &block;
+			break;
+		}
+
+		// within a rank the least recently seen one
+		const int rank = evictionRank(block);
+		if (!victim || rank < victimRank || (rank == victimRank && block.lastAttempt < victim->lastAttempt)) {
+			victim = &block;
+			victimRank = rank;
+		}
+	}
+
+	ConnectBlock& connectBlock = *victim;
+	if (connectBlock.key != key) {
+		connectBlock = { key, currentTime, 0, 1 };
 		return true;
 	}
 
-	ConnectBlock& connectBlock = it->second;
 	if (connectBlock.blockTime > currentTime) {
 		connectBlock.blockTime += 250;
 		return false;
@@ -30,7 +97,7 @@ bool Ban::acceptConnection(uint32_t clientIP)
 
 	int64_t timeDiff = currentTime - connectBlock.lastAttempt;
 	connectBlock.lastAttempt = currentTime;
-	if (timeDiff <= 5000) {
+	if (timeDiff <= static_cast<int64_t>(CONNECT_WINDOW)) {
 		if (++connectBlock.count > 5) {
 			connectBlock.count = 0;
 			if (timeDiff <= 500) {
@@ -44,55 +111,220 @@ bool Ban::acceptConnection(uint32_t clientIP)
 	return true;
 }
 
-bool IOBan::isAccountBanned(uint32_t accountId, BanInfo& banInfo)
+void Ban::sweep()
 {
-	Database& db = Database::getInstance();
+	for (Shard& shard : shards) {
+		std::lock_guard<std::mutex> lockClass(shard.lock);
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, `banned_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+		const uint64_t currentTime = OTSYS_TIME();
+		for (ConnectBlock& block : shard.blocks) {
+			if (block.key != 0 && block.isExpired(currentTime)) {
+				block = {};
+			}
+		}
+	}
+
+	g_scheduler.addEvent(createSchedulerTask(CONNECT_SWEEP_INTERVAL, [this]() { sweep(); }));
+}
+
+namespace {
+
+struct BanEntry {
+	BanInfo info;
+	time_t bannedAt;
+	uint32_t bannedBy;
+};
+
+using BanExpiry = std::pair<time_t, uint32_t>;
+using BanExpiryQueue = std::priority_queue<BanExpiry, std::vector<BanExpiry>, std::greater<>>;
+
+struct BanTable {
+	gtl::flat_hash_map<uint32_t, BanEntry> bans;
+	BanExpiryQueue expiry; // expiring bans, soonest first
+};
+
+// read from the network threads, written on the dispatcher
+std::shared_mutex banLock;
+BanTable accountBans;
+BanTable ipBans;
+gtl::flat_hash_set<uint32_t> namelocks;
+
+// bumped by every synchronous load, a background reload queued before it carries an
+// older snapshot and must not replace the tables (dispatcher only)
+uint64_t banGeneration = 0;
+
+const std::string ACCOUNT_BANS_QUERY = "SELECT `b`.`account_id` AS `id`, `b`.`reason`, `b`.`banned_at`, `b`.`expires_at`, `b`.`banned_by`, `p`.`name` FROM `account_bans` AS `b` LEFT JOIN `players` AS `p` ON `p`.`id` = `b`.`banned_by`";
+const std::string IP_BANS_QUERY = "SELECT `b`.`ip` AS `id`, `b`.`reason`, `b`.`banned_at`, `b`.`expires_at`, `b`.`banned_by`, `p`.`name` FROM `ip_bans` AS `b` LEFT JOIN `players` AS `p` ON `p`.`id` = `b`.`banned_by`";
+const std::string NAMELOCKS_QUERY = "SELECT `player_id` FROM `player_namelocks`";
+
+BanTable readBanTable(const DBResult_ptr& result)
+{
+	BanTable table;
+	if (!result) {
+		return table;
+	}
+
+	const auto columns = result->getColumnIndexes("id", "reason", "banned_at", "expires_at", "banned_by", "name");
+	do {
+		const auto [id, reason, bannedAt, expiresAt, bannedBy, name] = result->getRow<uint32_t, std::string, time_t, time_t, uint32_t, std::string>(columns);
+
+		BanEntry& entry = table.bans[id];
+		entry.info.reason = reason;
+		entry.info.bannedBy = name;
+		entry.info.expiresAt = expiresAt;
+		entry.bannedAt = bannedAt;
+		entry.bannedBy = bannedBy;
+
+		if (expiresAt != 0) {
+			table.expiry.emplace(expiresAt, id);
+		}
+	} while (result->next());
+	return table;
+}
+
+gtl::flat_hash_set<uint32_t> readNamelocks(const DBResult_ptr& result)
+{
+	gtl::flat_hash_set<uint32_t> players;
 	if (!result) {
+		return players;
+	}
+
+	const size_t playerColumn = result->getColumnIndex("player_id");
+	do {
+		players.insert(result->getNumber<uint32_t>(playerColumn));
+	} while (result->next());
+	return players;
+}
+
+bool findBan(const BanTable& table, uint32_t id, BanInfo& banInfo)
+{
+	std::shared_lock<std::shared_mutex> lockClass(banLock);
+
+	auto it = table.bans.find(id);
+	if (it == table.bans.end()) {
 		return false;
 	}
 
-	int64_t expiresAt = result->getNumber<int64_t>("expires_at");
+	// expired bans are moved to history by the next refresh
+	const time_t expiresAt = it->second.info.expiresAt;
 	if (expiresAt != 0 && time(nullptr) > expiresAt) {
-		// Move the ban to history if it has expired
-		g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt, result->getNumber<uint32_t>("banned_by")));
-		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
 		return false;
 	}
 
-	banInfo.expiresAt = expiresAt;
-	banInfo.reason = result->getString("reason");
-	banInfo.bannedBy = result->getString("name");
+	banInfo = it->second.info;
 	return true;
 }
 
+// Removes the bans of a table which expired by now, returning them
+std::vector<std::pair<uint32_t, BanEntry>> popExpiredBans(BanTable& table, time_t now)
+{
+	std::vector<std::pair<uint32_t, BanEntry>> expired;
+	while (!table.expiry.empty() && table.expiry.top().first < now) {
+		const auto [expiresAt, id] = table.expiry.top();
+		table.expiry.pop();
+
+		// the ban may have been lifted or renewed since it was queued
+		auto it = table.bans.find(id);
+		if (it == table.bans.end() || it->second.info.expiresAt != expiresAt) {
+			continue;
+		}
+
+		expired.emplace_back(id, std::move(it->second));
+		table.bans.erase(it);
+	}
+	return expired;
+}
+
+}
+
+bool IOBan::isAccountBanned(uint32_t accountId, BanInfo& banInfo)
+{
+	return findBan(accountBans, accountId, banInfo);
+}
+
 bool IOBan::isIpBanned(uint32_t clientIP, BanInfo& banInfo)
 {
 	if (clientIP == 0) {
 		return false;
 	}
+	return findBan(ipBans, clientIP, banInfo);
+}
 
-	Database& db = Database::getInstance();
+bool IOBan::isPlayerNamelocked(uint32_t playerId)
+{
+	std::shared_lock<std::shared_mutex> lockClass(banLock);
+	return namelocks.contains(playerId);
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = {:d}", clientIP));
-	if (!result) {
-		return false;
-	}
+bool IOBan::load()
+{
+	Database& db = Database::getInstance();
 
-	int64_t expiresAt = result->getNumber<int64_t>("expires_at");
-	if (expiresAt != 0 && time(nullptr) > expiresAt) {
-		g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = {:d}", clientIP));
-		return false;
-	}
+	BanTable accounts = readBanTable(db.storeQuery(ACCOUNT_BANS_QUERY));
+	BanTable ips = readBanTable(db.storeQuery(IP_BANS_QUERY));
+	gtl::flat_hash_set<uint32_t> players = readNamelocks(db.storeQuery(NAMELOCKS_QUERY));
 
-	banInfo.expiresAt = expiresAt;
-	banInfo.reason = result->getString("reason");
-	banInfo.bannedBy = result->getString("name");
+	std::unique_lock<std::shared_mutex> lockClass(banLock);
+	accountBans = std::move(accounts);
+	ipBans = std::move(ips);
+	namelocks = std::move(players);
+	++banGeneration;
 	return true;
 }
 
-bool IOBan::isPlayerNamelocked(uint32_t playerId)
+void IOBan::refresh()
 {
-	return Database::getInstance().storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get() != nullptr;
+	Database& db = Database::getInstance();
+	const time_t now = time(nullptr);
+
+	std::vector<std::pair<uint32_t, BanEntry>> expiredAccounts;
+	std::vector<std::pair<uint32_t, BanEntry>> expiredIps;
+	{
+		std::unique_lock<std::shared_mutex> lockClass(banLock);
+		expiredAccounts = popExpiredBans(accountBans, now);
+		expiredIps = popExpiredBans(ipBans, now);
+	}
+
+	for (const auto& [accountId, entry] : expiredAccounts) {
+		g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(entry.info.reason), entry.bannedAt, entry.info.expiresAt, entry.bannedBy));
+		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+	}
+
+	for (const auto& [ip, entry] : expiredIps) {
+		g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = {:d}", ip));
+	}
+
+	// queued after the deletes above, so the reloaded tables no longer hold them
+	const uint64_t generation = banGeneration;
+	g_databaseTasks.addTask(ACCOUNT_BANS_QUERY, [generation](const DBResult_ptr& result, bool) {
+		if (generation != banGeneration) {
+			return;
+		}
+
+		BanTable accounts = readBanTable(result);
+		std::unique_lock<std::shared_mutex> lockClass(banLock);
+		accountBans = std::move(accounts);
+	}, true);
+
+	g_databaseTasks.addTask(IP_BANS_QUERY, [generation](const DBResult_ptr& result, bool) {
+		if (generation != banGeneration) {
+			return;
+		}
+
+		BanTable ips = readBanTable(result);
+		std::unique_lock<std::shared_mutex> lockClass(banLock);
+		ipBans = std::move(ips);
+	}, true);
+
+	g_databaseTasks.addTask(NAMELOCKS_QUERY, [generation](const DBResult_ptr& result, bool) {
+		if (generation != banGeneration) {
+			return;
+		}
+
+		gtl::flat_hash_set<uint32_t> players = readNamelocks(result);
+		std::unique_lock<std::shared_mutex> lockClass(banLock);
+		namelocks = std::move(players);
+	}, true);
+
+	g_scheduler.addEvent(createSchedulerTask(REFRESH_INTERVAL, &IOBan::refresh));
 }
@@ -10,33 +10,70 @@ struct BanInfo {
 	time_t expiresAt;
 };
 
-struct ConnectBlock {
-	constexpr ConnectBlock(uint64_t lastAttempt, uint64_t blockTime, uint32_t count) :
-		lastAttempt(lastAttempt), blockTime(blockTime), count(count) {}
-
-	uint64_t lastAttempt;
-	uint64_t blockTime;
-	uint32_t count;
-};
-
-using IpConnectMap = std::map<uint32_t, ConnectBlock>;
-
+/**
+  * Per address connection rate limiter. Entries live in a fixed size table
+  * split into independently locked shards, so acceptors on different shards
+  * never wait on each other and a flood of distinct addresses can not grow
+  * memory; when a probe window is full the stalest entry is replaced.
+  */
 class Ban
 {
 	public:
-		bool acceptConnection(uint32_t clientIP);
+		bool acceptConnection(const boost::asio::ip::address& address);
+
+		/**
+		  * Clears the entries which no longer affect acceptConnection and
+		  * schedules the next sweep.
+		  */
+		void sweep();
 
 	private:
-		IpConnectMap ipConnectMap;
-		std::recursive_mutex lock;
+		static constexpr size_t SHARD_BITS = 4;
+		static constexpr size_t SHARD_COUNT = 1 << SHARD_BITS;
+		static constexpr size_t SHARD_CAPACITY = 1024; // power of two
+		static constexpr size_t PROBE_LENGTH = 8;
+
+		struct ConnectBlock {
+			uint64_t key = 0; // 0 marks a free entry
+			uint64_t lastAttempt = 0;
+			uint64_t blockTime = 0;
+			uint32_t count = 0;
+
+			bool isExpired(uint64_t currentTime) const;
+		};
+
+		struct alignas(64) Shard {
+			std::mutex lock;
+			std::array<ConnectBlock, SHARD_CAPACITY> blocks;
+		};
+
+		bool acceptConnection(uint64_t key);
+
+		std::array<Shard, SHARD_COUNT> shards;
 };
 
+/**
+  * Account bans, IP bans and namelocks are served from memory. The tables are
+  * loaded at startup, reloaded through RELOAD_TYPE_BANS whenever scripts
+  * change them, and refreshed periodically for changes made elsewhere.
+  */
 class IOBan
 {
 	public:
+		static constexpr uint32_t REFRESH_INTERVAL = 60 * 1000;
+
 		static bool isAccountBanned(uint32_t accountId, BanInfo& banInfo);
 		static bool isIpBanned(uint32_t clientIP, BanInfo& banInfo);
 		static bool isPlayerNamelocked(uint32_t playerId);
+
+		static bool load();
+
+		/**
+		  * Moves the bans which expired since the last refresh to history, reloads
+		  * the tables in the background and schedules the next refresh. A load()
+		  * that runs before the background reload completes wins over it.
+		  */
+		static void refresh();
 };
 
 #endif
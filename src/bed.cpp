@@ -110,8 +110,8 @@ bool BedItem::canUse(PlayerPtr player) const
 		return true;
 	}
 
-	PlayerPtr sleeper(nullptr);
-	if (!IOLoginData::loadPlayerById(sleeper, sleeperGUID)) {
+	const auto sleeper = IOLoginData::getOfflinePlayer(sleeperGUID);
+	if (!sleeper) {
 		return false;
 	}
 
@@ -187,10 +187,9 @@ void BedItem::wakeUp(const PlayerPtr& player)
 
 	if (sleeperGUID != 0) {
 		if (!player) {
-			PlayerPtr regenPlayer(nullptr);
-			if (IOLoginData::loadPlayerById(regenPlayer, sleeperGUID)) {
+			if (const auto regenPlayer = IOLoginData::getOfflinePlayer(sleeperGUID)) {
 				regeneratePlayer(regenPlayer);
-				IOLoginData::savePlayer(regenPlayer);
+				IOLoginData::savePlayerLater(regenPlayer);
 			}
 		} else {
 			regeneratePlayer(player);
@@ -4,6 +4,7 @@
 #include "otpch.h"
 
 #include "combat.h"
+#include "profiler.h"
 #include "game.h"
 #include "weapons.h"
 #include "configmanager.h"
@@ -19,54 +20,46 @@ extern Events* g_events;
 
 // we use a thread-local tile buffer for reuse across calls to avoid repeated allocations
 thread_local std::vector<TilePtr> area_tile_buffer;
+thread_local std::vector<Position> area_position_buffer;
+thread_local std::vector<bool> area_sight_buffer;
 
 static std::vector<TilePtr> getList(const MatrixArea& area, const Position& targetPos, const Direction dir) 
 {
 	const Position casterPos = getNextPosition(dir, targetPos);
+	const uint8_t z = targetPos.z;
 
-	const uint32_t rows = area.getRows();
-	const uint32_t cols = area.getCols();
-	const auto& center = area.getCenter();
-
-	const int32_t startX = targetPos.x - static_cast<int32_t>(center.first);
-	const int32_t startY = targetPos.y - static_cast<int32_t>(center.second);
-	const uint32_t z = targetPos.z;
-
+	// the offsets are compiled when the area is set up, a cast only has to translate them
+	const auto& offsets = area.getOffsets();
 	area_tile_buffer.clear();
-	area_tile_buffer.reserve(rows * cols);
+	area_tile_buffer.reserve(offsets.size());
+	area_position_buffer.clear();
 
-	Position pos(0, 0, z);
-
-	for (uint32_t row = 0; row < rows; ++row) 
+	for (const auto& [offsetX, offsetY] : offsets)
 	{
-		pos.y = startY + static_cast<int32_t>(row);
-
-		for (uint32_t col = 0; col < cols; ++col) 
-		{
-			[[unlikely]]
-			if (not area(row, col))  
-			{
-				continue;
-			}
-
-			pos.x = startX + static_cast<int32_t>(col);
+		area_position_buffer.emplace_back(static_cast<uint16_t>(targetPos.x + offsetX), static_cast<uint16_t>(targetPos.y + offsetY), z);
+	}
 
-			[[unlikely]]
-			if (not g_game.isSightClear(casterPos, pos, true))
-			{
-				continue;
-			}
+	// resolve the line of sight of the whole area in one pass
+	g_game.map.isSightClear(casterPos, area_position_buffer, area_sight_buffer, true);
 
-			auto tile = g_game.map.getTile(pos);
-			[[unlikely]]
-			if (not tile)
-			{
-				tile = std::make_shared<Tile>(pos.x, pos.y, z);
-				g_game.map.setTile(pos, tile);
-			}
+	for (size_t i = 0, size = area_position_buffer.size(); i < size; ++i)
+	{
+		[[unlikely]]
+		if (not area_sight_buffer[i])
+		{
+			continue;
+		}
 
-			area_tile_buffer.push_back(tile);
+		const Position& areaPos = area_position_buffer[i];
+		auto tile = g_game.map.getTile(areaPos);
+		[[unlikely]]
+		if (not tile)
+		{
+			tile = std::make_shared<Tile>(areaPos.x, areaPos.y, z);
+			g_game.map.setTile(areaPos, tile);
 		}
+
+		area_tile_buffer.push_back(tile);
 	}
 
 	return area_tile_buffer;
@@ -650,7 +643,7 @@ CallBack* Combat::getCallback(CallBackParam_t key) const
 	return nullptr;
 }
 
-void Combat::combatTileEffects(const SpectatorVec& spectators,const CreaturePtr& caster, TilePtr tile, const CombatParams& params)
+void Combat::combatTileEffects(const SpectatorVec& spectators,const CreaturePtr& caster, TilePtr tile, const CombatParams& params, std::vector<Position>* impactPositions)
 {
 	if (params.itemId != 0) {
 		uint16_t itemId = params.itemId;
@@ -730,7 +723,11 @@ void Combat::combatTileEffects(const SpectatorVec& spectators,const CreaturePtr&
 	}
 
 	if (params.impactEffect != CONST_ME_NONE) {
-		Game::addMagicEffect(spectators, tile->getPosition(), params.impactEffect);
+		if (impactPositions) {
+			impactPositions->push_back(tile->getPosition());
+		} else {
+			Game::addMagicEffect(spectators, tile->getPosition(), params.impactEffect);
+		}
 	}
 }
 
@@ -776,6 +773,7 @@ void Combat::addDistanceEffect(const CreaturePtr& caster, const Position& fromPo
 
 void Combat::doCombat(const CreaturePtr& caster, const CreaturePtr& target) const
 {
+	ProfileScope profile(Subsystem::Combat);
 	const auto& p = params;
 
 	if (p.combatType == COMBAT_NONE and
@@ -855,6 +853,7 @@ void Combat::doCombat(const CreaturePtr& caster, const CreaturePtr& target) cons
 
 void Combat::doCombat(const CreaturePtr& caster, const Position& position) const
 {
+	ProfileScope profile(Subsystem::Combat);
 	const auto& p = params;
 
 	if (p.combatType != COMBAT_NONE) 
@@ -887,6 +886,11 @@ void Combat::doCombat(const CreaturePtr& caster, const Position& position) const
 		g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
 		postCombatEffects(caster, position, p);
 
+		std::vector<CreaturePtr> affectedCreatures;
+		// the impact effects of the whole area go out as one message per spectator
+		std::vector<Position> impactPositions;
+		impactPositions.reserve(tiles.size());
+
 		for (const auto& tile : tiles) 
 		{
 			if (canDoCombat(caster, tile, p.aggressive) != RETURNVALUE_NOERROR) 
@@ -894,7 +898,7 @@ void Combat::doCombat(const CreaturePtr& caster, const Position& position) const
 				continue;
 			}
 
-			combatTileEffects(spectators, caster, tile, p);
+			combatTileEffects(spectators, caster, tile, p, &impactPositions);
 
 			if (const auto& creatures = tile->getCreatures()) 
 			{
@@ -916,53 +920,62 @@ void Combat::doCombat(const CreaturePtr& caster, const Position& position) const
 						}
 					}
 
-					bool creatureCanCombat = not p.aggressive or (caster != creature and Combat::canDoCombat(caster, creature) == RETURNVALUE_NOERROR);
+					affectedCreatures.push_back(creature);
 
-					if (creatureCanCombat) 
+					if (p.targetCasterOrTopMost) 
 					{
-						for (const auto& condition : p.conditionList) 
-						{
-							if (caster == creature || !creature->isImmune(condition->getType())) 
-							{
-								auto conditionCopy = condition->clone();
-								if (conditionCopy) 
-								{
-									if (caster) 
-									{
-										conditionCopy->setParam(CONDITION_PARAM_OWNER, caster->getID());
-									}
-									creature->addCombatCondition(std::move(conditionCopy));
-								}
-							}
-						}
+						break;
 					}
+				}
+			}
+		}
 
-					if (p.dispelType & CONDITION_PARALYZE) 
-					{
-						creature->removeCondition(CONDITION_PARALYZE);
-					}
-					else if (p.dispelType != 0) 
-					{
-						creature->removeCombatCondition(p.dispelType);
-					}
+		// the effects are shown before any condition or callback reaches a creature, as in doAreaCombat
+		Game::addMagicEffects(spectators, impactPositions, p.impactEffect);
 
-					if (p.targetCallback) 
-					{
-						p.targetCallback->onTargetCombat(caster, creature);
-					}
+		for (const auto& creature : affectedCreatures) 
+		{
+			bool creatureCanCombat = not p.aggressive or (caster != creature and Combat::canDoCombat(caster, creature) == RETURNVALUE_NOERROR);
 
-					if (p.targetCasterOrTopMost) 
+			if (creatureCanCombat) 
+			{
+				for (const auto& condition : p.conditionList) 
+				{
+					if (caster == creature || !creature->isImmune(condition->getType())) 
 					{
-						break;
+						auto conditionCopy = condition->clone();
+						if (conditionCopy) 
+						{
+							if (caster) 
+							{
+								conditionCopy->setParam(CONDITION_PARAM_OWNER, caster->getID());
+							}
+							creature->addCombatCondition(std::move(conditionCopy));
+						}
 					}
 				}
 			}
+
+			if (p.dispelType & CONDITION_PARALYZE) 
+			{
+				creature->removeCondition(CONDITION_PARALYZE);
+			}
+			else if (p.dispelType != 0) 
+			{
+				creature->removeCombatCondition(p.dispelType);
+			}
+
+			if (p.targetCallback) 
+			{
+				p.targetCallback->onTargetCombat(caster, creature);
+			}
 		}
 	}
 }
 
 void Combat::doTargetCombat(const CreaturePtr& caster, const CreaturePtr& target, CombatDamage& damage, const CombatParams& params, bool sendDistanceEffect)
-{	
+{
+	ProfileScope profile(Subsystem::Combat);
 	// To-do : I need to properly handle augment based damage which requires entire reworking of this method.
 	// The thing that needs to happen is for augment based damage should not interact again with other aumgent
 	// based damage. Instead of using origin for this, would possibly be better as fields on the combat or combat params.
@@ -1427,6 +1440,7 @@ void Combat::doTargetCombat(const CreaturePtr& caster, const CreaturePtr& target
 
 void Combat::doAreaCombat(const CreaturePtr& caster, const Position& position, const AreaCombat* area, const CombatDamage& damage, const CombatParams& params)
 {
+	ProfileScope profile(Subsystem::Combat);
 	const auto& p = params;
 	const auto& tiles = caster ? getCombatArea(caster->getPosition(), position, area) :	getCombatArea(position, position, area);
 
@@ -1454,6 +1468,8 @@ void Combat::doAreaCombat(const CreaturePtr& caster, const Position& position, c
 	postCombatEffects(caster, position, p);
 	std::vector<CreaturePtr> toDamageCreatures;
 	toDamageCreatures.reserve(100);
+	std::vector<Position> impactPositions;
+	impactPositions.reserve(tiles.size());
 
 	for (const auto& tile : tiles) 
 	{
@@ -1462,7 +1478,7 @@ void Combat::doAreaCombat(const CreaturePtr& caster, const Position& position, c
 			continue;
 		}
 
-		combatTileEffects(spectators, caster, tile, p);
+		combatTileEffects(spectators, caster, tile, p, &impactPositions);
 
 		if (const auto& creaturesOnTile = tile->getCreatures()) 
 		{
@@ -1499,6 +1515,9 @@ void Combat::doAreaCombat(const CreaturePtr& caster, const Position& position, c
 		}
 	}
 
+	// one message per spectator for the whole area, before the damage of the targets
+	Game::addMagicEffects(spectators, impactPositions, p.impactEffect);
+
 	for (const auto& target : toDamageCreatures) 
 	{
 		CombatDamage local_damage = damage;
@@ -150,7 +150,7 @@ class Combat
 		}
 
 	private:
-		static void combatTileEffects(const SpectatorVec& spectators,const CreaturePtr& caster, TilePtr tile, const CombatParams& params);
+		static void combatTileEffects(const SpectatorVec& spectators,const CreaturePtr& caster, TilePtr tile, const CombatParams& params, std::vector<Position>* impactPositions = nullptr);
 		CombatDamage getCombatDamage(const CreaturePtr& creature, const CreaturePtr& target) const;
 
 		//configurable
@@ -181,7 +181,8 @@ bool ConfigManager::load()
 	//parse config
 	if (!loaded) { //info that must be loaded one time (unless we reset the modules involved)
 		boolean[BIND_ONLY_GLOBAL_ADDRESS] = getGlobalBoolean(L, "bindOnlyGlobalAddress", false);
-		boolean[OPTIMIZE_DATABASE] = getGlobalBoolean(L, "startupDatabaseOptimization", true);
+		// startupDatabaseOptimization is the name older configs use
+		boolean[OPTIMIZE_DATABASE] = getGlobalBoolean(L, "databaseOptimization", getGlobalBoolean(L, "startupDatabaseOptimization", true));
 
 		if (string[IP] == "") {
 			string[IP] = getGlobalString(L, "ip", "127.0.0.1");
@@ -258,6 +259,8 @@ bool ConfigManager::load()
 	boolean[HEALTH_REGEN_NOTIFICATION] = getGlobalBoolean(L, "healthRegenNotification", false);
 	boolean[MANA_REGEN_NOTIFICATION] = getGlobalBoolean(L, "manaRegenNotification", false);
     boolean[AUTO_OPEN_CONTAINERS] = getGlobalBoolean(L, "autoOpenContainers", true);
+	boolean[PACKET_COMPRESSION] = getGlobalBoolean(L, "packetCompression", false);
+	boolean[STATUS_PERFORMANCE_INFO] = getGlobalBoolean(L, "statusPerformanceInfo", false);
 
 	// Account manager
 	boolean[ENABLE_ACCOUNT_MANAGER] = getGlobalBoolean(L, "useIngameAccountManager", true);
@@ -275,6 +278,7 @@ bool ConfigManager::load()
 	string[LOCATION] = getGlobalString(L, "location", "");
 	string[MOTD] = getGlobalString(L, "motd", "");
 	string[WORLD_TYPE] = getGlobalString(L, "worldType", "pvp");
+	string[PACKET_CAPTURE_DIRECTORY] = getGlobalString(L, "packetCaptureDirectory", "");
 
 	integer[MAX_PLAYERS] = getGlobalNumber(L, "maxPlayers");
 	integer[PZ_LOCKED] = getGlobalNumber(L, "pzLocked", 60000);
@@ -303,6 +307,8 @@ bool ConfigManager::load()
 	integer[CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES] = getGlobalNumber(L, "checkExpiredMarketOffersEachMinutes", 60);
 	integer[MAX_MARKET_OFFERS_AT_A_TIME_PER_PLAYER] = getGlobalNumber(L, "maxMarketOffersAtATimePerPlayer", 100);
 	integer[MAX_PACKETS_PER_SECOND] = getGlobalNumber(L, "maxPacketsPerSecond", 25);
+	integer[PACKET_COMPRESSION_THRESHOLD] = getGlobalNumber(L, "packetCompressionThreshold", 128);
+	integer[PACKET_COMPRESSION_LEVEL] = getGlobalNumber(L, "packetCompressionLevel", 6);
 	integer[SERVER_SAVE_NOTIFY_DURATION] = getGlobalNumber(L, "serverSaveNotifyDuration", 5);
 	integer[YELL_MINIMUM_LEVEL] = getGlobalNumber(L, "yellMinimumLevel", 2);
 	integer[MINIMUM_LEVEL_TO_SEND_PRIVATE] = getGlobalNumber(L, "minimumLevelToSendPrivate", 1);
@@ -318,6 +324,10 @@ bool ConfigManager::load()
 	integer[PLAYER_SPEED_PER_LEVEL] = getGlobalNumber(L, "playerSpeedPerLevel", 2);
 	integer[PLAYER_MAX_SPEED] = getGlobalNumber(L, "playerMaxSpeed", 1500);
 	integer[PLAYER_MIN_SPEED] = getGlobalNumber(L, "playerMinSpeed", 120);
+	integer[RANDOM_SEED] = getGlobalNumber(L, "randomSeed", 0);
+	integer[OFFLINE_PLAYER_CACHE_SIZE] = getGlobalNumber(L, "offlinePlayerCacheSize", 500);
+	integer[DATABASE_OPTIMIZATION_INTERVAL] = getGlobalNumber(L, "databaseOptimizationInterval", 24);
+	integer[DATABASE_OPTIMIZATION_DELAY] = getGlobalNumber(L, "databaseOptimizationDelay", 30);
 
 	floats[REWARD_BASE_RATE] = getGlobalFloat(L, "rewardBaseRate", 1.0f);
 	floats[REWARD_RATE_DAMAGE_DONE] = getGlobalFloat(L, "rewardRateDamageDone", 1.0f);
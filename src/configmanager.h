@@ -64,6 +64,8 @@ class ConfigManager
 			HEALTH_REGEN_NOTIFICATION,
 			MANA_REGEN_NOTIFICATION,
 			AUTO_OPEN_CONTAINERS,
+			PACKET_COMPRESSION,
+			STATUS_PERFORMANCE_INFO,
 
 			LAST_BOOLEAN_CONFIG /* this must be the last one */
 		};
@@ -89,6 +91,7 @@ class ConfigManager
 			CONFIG_FILE,
 			ACCOUNT_MANAGER_AUTH,
 			ASSETS_DAT_PATH,
+			PACKET_CAPTURE_DIRECTORY,
 
 			LAST_STRING_CONFIG /* this must be the last one */
 		};
@@ -144,6 +147,12 @@ class ConfigManager
 			PLAYER_SPEED_PER_LEVEL,
 			PLAYER_MAX_SPEED,
 			PLAYER_MIN_SPEED,
+			RANDOM_SEED,
+			PACKET_COMPRESSION_THRESHOLD,
+			PACKET_COMPRESSION_LEVEL,
+			OFFLINE_PLAYER_CACHE_SIZE,
+			DATABASE_OPTIMIZATION_INTERVAL,
+			DATABASE_OPTIMIZATION_DELAY,
 
 			LAST_INTEGER_CONFIG /* this must be the last one */
 		};
@@ -11,6 +11,8 @@
 #include "events.h"
 #include "party.h"
 
+#include <bit>
+
 double Creature::speedA = 857.36;
 double Creature::speedB = 261.29;
 double Creature::speedC = -4795.01;
@@ -329,16 +331,40 @@ void Creature::stopEventWalk()
 }
 
 void Creature::updateMapCache()
+{
+	updateMapCacheArea(-maxWalkCacheWidth, -maxWalkCacheHeight, maxWalkCacheWidth, maxWalkCacheHeight);
+}
+
+void Creature::updateMapCacheArea(const int32_t minDX, const int32_t minDY, const int32_t maxDX, const int32_t maxDY)
 {
 	const Position& myPos = getPosition();
-	Position pos(0, 0, myPos.z);
+	const int32_t width = maxDX - minDX + 1;
+	const int32_t height = maxDY - minDY + 1;
 
-	for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y) {
-		for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x) {
-			pos.x = myPos.getX() + x;
-			pos.y = myPos.getY() + y;
-			TilePtr tile = g_game.map.getTile(pos);
-			updateTileCache(tile, pos);
+	uint32_t walkRows[mapWalkHeight];
+	uint32_t checkRows[mapWalkHeight];
+	g_game.map.getWalkLayers(myPos.getX() + minDX, myPos.getY() + minDY, myPos.z, width, height, walkRows, checkRows);
+
+	const uint32_t shift = maxWalkCacheWidth + minDX;
+	const uint32_t areaMask = (width == 32 ? 0xFFFFFFFF : ((1U << width) - 1)) << shift;
+
+	Position pos(0, 0, myPos.z);
+	for (int32_t row = 0; row < height; ++row) {
+		uint32_t& cacheRow = localMapCache[maxWalkCacheHeight + minDY + row];
+		cacheRow = (cacheRow & ~areaMask) | ((walkRows[row] & ~checkRows[row]) << shift);
+
+		// tiles with creatures or dynamic state still need the full check
+		uint32_t check = walkRows[row] & checkRows[row];
+		while (check != 0) {
+			const int32_t bit = std::countr_zero(check);
+			check &= check - 1;
+
+			pos.x = myPos.getX() + minDX + bit;
+			pos.y = myPos.getY() + minDY + row;
+			const auto& tile = g_game.map.getTile(pos);
+			if (tile && tile->queryAdd(getCreature(), FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) == RETURNVALUE_NOERROR) {
+				cacheRow |= 1U << (shift + bit);
+			}
 		}
 	}
 }
@@ -346,7 +372,13 @@ void Creature::updateMapCache()
 void Creature::updateTileCache(TilePtr tile, int32_t dx, int32_t dy)
 {
 	if (std::abs(dx) <= maxWalkCacheWidth && std::abs(dy) <= maxWalkCacheHeight) {
-		localMapCache[maxWalkCacheHeight + dy][maxWalkCacheWidth + dx] = tile && tile->queryAdd(getCreature(), FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) == RETURNVALUE_NOERROR;
+		const uint32_t bit = 1U << (maxWalkCacheWidth + dx);
+		uint32_t& cacheRow = localMapCache[maxWalkCacheHeight + dy];
+		if (tile && tile->queryAdd(getCreature(), FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) == RETURNVALUE_NOERROR) {
+			cacheRow |= bit;
+		} else {
+			cacheRow &= ~bit;
+		}
 	}
 }
 
@@ -379,7 +411,7 @@ int32_t Creature::getWalkCache(const Position& pos) const
 	if (std::abs(dx) <= maxWalkCacheWidth) {
 		int32_t dy = Position::getOffsetY(pos, myPos);
 		if (std::abs(dy) <= maxWalkCacheHeight) {
-			if (localMapCache[maxWalkCacheHeight + dy][maxWalkCacheWidth + dx]) {
+			if ((localMapCache[maxWalkCacheHeight + dy] >> (maxWalkCacheWidth + dx)) & 1) {
 				return 1;
 			} else {
 				return 0;
@@ -533,78 +565,34 @@ void Creature::onCreatureMove(const CreaturePtr& creature,
 			if (teleport || oldPos.z != newPos.z) {
 				updateMapCache();
 			} else {
-				const Position& myPos = getPosition();
+				// the row refreshed by a vertical step is already correct for the new position
+				int32_t starty = 0;
+				int32_t endy = mapWalkHeight - 1;
 
 				if (oldPos.y > newPos.y) { //north
 					//shift y south
-					for (int32_t y = mapWalkHeight - 1; --y >= 0;) {
-						memcpy(localMapCache[y + 1], localMapCache[y], sizeof(localMapCache[y]));
-					}
-
-					//update 0
-					for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x) {
-						auto cacheTile = g_game.map.getTile(myPos.getX() + x, myPos.getY() - maxWalkCacheHeight, myPos.z);
-						updateTileCache(cacheTile, x, -maxWalkCacheHeight);
-					}
+					std::memmove(localMapCache + 1, localMapCache, sizeof(localMapCache[0]) * (mapWalkHeight - 1));
+					updateMapCacheArea(-maxWalkCacheWidth, -maxWalkCacheHeight, maxWalkCacheWidth, -maxWalkCacheHeight);
+					starty = 1;
 				} else if (oldPos.y < newPos.y) { // south
 					//shift y north
-					for (int32_t y = 0; y <= mapWalkHeight - 2; ++y) {
-						memcpy(localMapCache[y], localMapCache[y + 1], sizeof(localMapCache[y]));
-					}
-
-					//update mapWalkHeight - 1
-					for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x) {
-						auto cacheTile = g_game.map.getTile(myPos.getX() + x, myPos.getY() + maxWalkCacheHeight, myPos.z);
-						updateTileCache(cacheTile, x, maxWalkCacheHeight);
-					}
+					std::memmove(localMapCache, localMapCache + 1, sizeof(localMapCache[0]) * (mapWalkHeight - 1));
+					updateMapCacheArea(-maxWalkCacheWidth, maxWalkCacheHeight, maxWalkCacheWidth, maxWalkCacheHeight);
+					endy -= 1;
 				}
 
 				if (oldPos.x < newPos.x) { // east
-					//shift y west
-					int32_t starty = 0;
-					int32_t endy = mapWalkHeight - 1;
-					int32_t dy = Position::getDistanceY(oldPos, newPos);
-
-					if (dy < 0) {
-						endy += dy;
-					} else if (dy > 0) {
-						starty = dy;
-					}
-
+					//shift x west
 					for (int32_t y = starty; y <= endy; ++y) {
-						for (int32_t x = 0; x <= mapWalkWidth - 2; ++x) {
-							localMapCache[y][x] = localMapCache[y][x + 1];
-						}
-					}
-
-					//update mapWalkWidth - 1
-					for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y) {
-						auto cacheTile = g_game.map.getTile(myPos.x + maxWalkCacheWidth, myPos.y + y, myPos.z);
-						updateTileCache(cacheTile, maxWalkCacheWidth, y);
+						localMapCache[y] >>= 1;
 					}
+					updateMapCacheArea(maxWalkCacheWidth, -maxWalkCacheHeight, maxWalkCacheWidth, maxWalkCacheHeight);
 				} else if (oldPos.x > newPos.x) { // west
-					//shift y east
-					int32_t starty = 0;
-					int32_t endy = mapWalkHeight - 1;
-					int32_t dy = Position::getDistanceY(oldPos, newPos);
-
-					if (dy < 0) {
-						endy += dy;
-					} else if (dy > 0) {
-						starty = dy;
-					}
-
+					//shift x east
 					for (int32_t y = starty; y <= endy; ++y) {
-						for (int32_t x = mapWalkWidth - 1; --x >= 0;) {
-							localMapCache[y][x + 1] = localMapCache[y][x];
-						}
-					}
-
-					//update 0
-					for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y) {
-						auto cacheTile = g_game.map.getTile(myPos.x - maxWalkCacheWidth, myPos.y + y, myPos.z);
-						updateTileCache(cacheTile, -maxWalkCacheWidth, y);
+						localMapCache[y] = (localMapCache[y] << 1) & mapWalkRowMask;
 					}
+					updateMapCacheArea(-maxWalkCacheWidth, -maxWalkCacheHeight, -maxWalkCacheWidth, maxWalkCacheHeight);
 				}
 
 				updateTileCache(oldTile, oldPos);
@@ -653,6 +653,8 @@ class Creature : virtual public Thing, public SharedObject
 		static constexpr int32_t mapWalkHeight = Map::maxViewportY * 2 + 1;
 		static constexpr int32_t maxWalkCacheWidth = (mapWalkWidth - 1) / 2;
 		static constexpr int32_t maxWalkCacheHeight = (mapWalkHeight - 1) / 2;
+		static constexpr uint32_t mapWalkRowMask = (1U << mapWalkWidth) - 1;
+		static_assert(mapWalkWidth <= 32, "localMapCache rows must fit in 32 bits");
 
 		Position position;
 
@@ -680,6 +682,7 @@ class Creature : virtual public Thing, public SharedObject
 		uint32_t lastHitCreatureId = 0;
 		uint32_t blockCount = 0;
 		uint32_t blockTicks = 0;
+		uint32_t sectorIndex = 0; // index in the creature list of its map floor, see MapSector
 		uint32_t lastStepCost = 1;
 		uint32_t baseSpeed = 220;
 		int32_t varSpeed = 0;
@@ -697,7 +700,8 @@ class Creature : virtual public Thing, public SharedObject
 		Direction direction = DIRECTION_SOUTH;
 		Skulls_t skull = SKULL_NONE;
 
-		bool localMapCache[mapWalkHeight][mapWalkWidth] = {{ false }};
+		// one row per y offset, bit (maxWalkCacheWidth + dx) is set for walkable tiles
+		uint32_t localMapCache[mapWalkHeight] = {};
 		bool isInternalRemoved = false;
 		bool isMapLoaded = false;
 		bool isUpdatingPath = false;
@@ -720,6 +724,7 @@ class Creature : virtual public Thing, public SharedObject
 		CreatureEventList getCreatureEvents(CreatureEventType_t type) const;
 
 		void updateMapCache();
+		void updateMapCacheArea(int32_t minDX, int32_t minDY, int32_t maxDX, int32_t maxDY);
 		void updateTileCache(TilePtr tile, int32_t dx, int32_t dy);
 		void updateTileCache(TilePtr tile, const Position& pos);
 		void onCreatureDisappear(const CreatureConstPtr& creature, bool isLogout);
@@ -746,6 +751,7 @@ class Creature : virtual public Thing, public SharedObject
 
 		friend class Game;
 		friend class Map;
+		friend class MapSector;
 		friend class LuaScriptInterface;
 };
 
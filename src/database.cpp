@@ -79,6 +79,11 @@ bool Database::commit()
 
 bool Database::executeQuery(const std::string& query)
 {
+	// never connected, the offline simulator runs without a database
+	if (!handle) {
+		return false;
+	}
+
 	bool success = true;
 
 	// executes the query
@@ -106,6 +111,10 @@ bool Database::executeQuery(const std::string& query)
 
 DBResult_ptr Database::storeQuery(const std::string& query)
 {
+	if (!handle) {
+		return nullptr;
+	}
+
 	databaseLock.lock();
 
 	while (mysql_real_query(handle, query.c_str(), query.length()) != 0) {
@@ -156,7 +165,7 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const
 
 	if (length != 0) {
 		char* output = new char[maxLength];
-		auto escaped_length = mysql_real_escape_string(handle, output, s, length);
+		auto escaped_length = handle ? mysql_real_escape_string(handle, output, s, length) : mysql_escape_string(output, s, length);
 		escaped.append(output, escaped_length);
 		delete[] output;
 	}
@@ -165,19 +174,56 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const
 	return escaped;
 }
 
+namespace {
+
+DBResult::ColumnKind getColumnKindOf(const MYSQL_FIELD& field)
+{
+	switch (field.type) {
+		case MYSQL_TYPE_LONGLONG:
+			return (field.flags & UNSIGNED_FLAG) ? DBResult::ColumnKind::UnsignedBigInt : DBResult::ColumnKind::Integer;
+
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_YEAR:
+			return DBResult::ColumnKind::Integer;
+
+		case MYSQL_TYPE_DECIMAL:
+		case MYSQL_TYPE_NEWDECIMAL:
+		case MYSQL_TYPE_FLOAT:
+		case MYSQL_TYPE_DOUBLE:
+			return DBResult::ColumnKind::Decimal;
+
+		default:
+			return DBResult::ColumnKind::Text;
+	}
+}
+
+}
+
 DBResult::DBResult(MYSQL_RES* res)
 {
 	handle = res;
 
-	size_t i = 0;
+	columnCount = mysql_num_fields(handle);
+	columnNames.reserve(columnCount);
+	columnKinds.reserve(columnCount);
+	columnIndexes.reserve(columnCount);
 
 	MYSQL_FIELD* field = mysql_fetch_field(handle);
 	while (field) {
-		listNames[field->name] = i++;
+		const std::string_view name(field->name, field->name_length);
+		columnIndexes[name] = columnNames.size();
+		columnNames.push_back(name);
+		columnKinds.push_back(getColumnKindOf(*field));
 		field = mysql_fetch_field(handle);
 	}
 
 	row = mysql_fetch_row(handle);
+	if (row) {
+		lengths = mysql_fetch_lengths(handle);
+	}
 }
 
 DBResult::~DBResult()
@@ -185,21 +231,24 @@ DBResult::~DBResult()
 	mysql_free_result(handle);
 }
 
+size_t DBResult::getColumnIndex(std::string_view column) const
+{
+	auto it = columnIndexes.find(column);
+	if (it == columnIndexes.end()) {
+		return INVALID_COLUMN;
+	}
+	return it->second;
+}
+
 std::string_view DBResult::getString(std::string_view column) const
 {
-	auto it = listNames.find(column);
-	if (it == listNames.end()) {
+	const size_t index = getColumnIndex(column);
+	if (index == INVALID_COLUMN) {
 		std::cout << "[Error - DBResult::getString] Column '" << column << "' does not exist in result set."
 			<< std::endl;
 		return {};
 	}
-
-	if (row[it->second] == nullptr) {
-		return {};
-	}
-
-	auto size = mysql_fetch_lengths(handle)[it->second];
-	return { row[it->second], size };
+	return getString(index);
 }
 
 bool DBResult::hasNext() const
@@ -210,7 +259,12 @@ bool DBResult::hasNext() const
 bool DBResult::next()
 {
 	row = mysql_fetch_row(handle);
-	return row != nullptr;
+	if (!row) {
+		return false;
+	}
+
+	lengths = mysql_fetch_lengths(handle);
+	return true;
 }
 
 DBInsert::DBInsert(std::string query) : query(std::move(query))
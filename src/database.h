@@ -6,6 +6,8 @@
 
 #include "pugicast.h"
 
+#include <charconv>
+#include <gtl/phmap.hpp>
 #include <mysql/mysql.h>
 
 class DBResult;
@@ -85,7 +87,7 @@ class Database
 		 * @return id on success, 0 if last query did not result on any rows with auto_increment keys
 		 */
 		uint64_t getLastInsertId() const {
-			return static_cast<uint64_t>(mysql_insert_id(handle));
+			return handle ? static_cast<uint64_t>(mysql_insert_id(handle)) : 0;
 		}
 
 		/**
@@ -123,6 +125,15 @@ class Database
 class DBResult
 {
 	public:
+		static constexpr size_t INVALID_COLUMN = std::numeric_limits<size_t>::max();
+
+		enum class ColumnKind : uint8_t {
+			Integer,
+			UnsignedBigInt, // may exceed int64_t
+			Decimal,
+			Text,
+		};
+
 		explicit DBResult(MYSQL_RES* res);
 		~DBResult();
 
@@ -130,31 +141,136 @@ class DBResult
 		DBResult(const DBResult&) = delete;
 		DBResult& operator=(const DBResult&) = delete;
 
+		/**
+		 * Resolves a column name to its index in the result set.
+		 *
+		 * Loops over many rows should resolve their columns once, before the
+		 * loop, and read the cells by index.
+		 *
+		 * @return column index, INVALID_COLUMN if the result set has no such column
+		 */
+		size_t getColumnIndex(std::string_view column) const;
+
+		size_t getColumnCount() const { return columnCount; }
+		uint64_t getRowCount() const { return static_cast<uint64_t>(mysql_num_rows(handle)); }
+
+		std::string_view getColumnName(size_t column) const { return columnNames[column]; }
+
+		/**
+		 * How the server typed the column, so callers without a static row
+		 * type (e.g. scripts) can convert cells without guessing.
+		 */
+		ColumnKind getColumnKind(size_t column) const { return columnKinds[column]; }
+
+		bool isNull(size_t column) const { return column >= columnCount || row[column] == nullptr; }
+
+		template<typename... Names>
+		std::array<size_t, sizeof...(Names)> getColumnIndexes(Names... columns) const
+		{
+			return { getColumnIndex(columns)... };
+		}
+
+		template<typename T>
+		T getNumber(size_t column) const
+		{
+			if (column >= columnCount || row[column] == nullptr) {
+				return {};
+			}
+			return parseNumber<T>(row[column], lengths[column]);
+		}
+
 		template<typename T>
 		T getNumber(std::string_view column) const
 		{
-			auto it = listNames.find(column);
-			if (it == listNames.end()) {
+			const size_t index = getColumnIndex(column);
+			if (index == INVALID_COLUMN) {
 				std::cout << "[Error - DBResult::getNumber] Column '" << column << "' doesn't exist in the result set" << std::endl;
+				return {};
 			}
+			return getNumber<T>(index);
+		}
 
-			if (row[it->second] == nullptr) {
+		/**
+		 * Reads a string or blob cell. The view points into the row buffer and
+		 * stays valid until next() is called.
+		 */
+		std::string_view getString(size_t column) const
+		{
+			if (column >= columnCount || row[column] == nullptr) {
 				return {};
 			}
-
-			return pugi::cast<T>(row[it->second]);
+			return { row[column], lengths[column] };
 		}
 
 		std::string_view getString(std::string_view column) const;
 
+		/**
+		 * Reads the cells of the current row as a typed tuple, e.g.
+		 *
+		 *	const auto columns = result->getColumnIndexes("id", "name");
+		 *	do {
+		 *		const auto [id, name] = result->getRow<uint32_t, std::string_view>(columns);
+		 *	} while (result->next());
+		 */
+		template<typename... Ts>
+		std::tuple<Ts...> getRow(const std::array<size_t, sizeof...(Ts)>& columns) const
+		{
+			return getRowCells<Ts...>(columns, std::index_sequence_for<Ts...>{});
+		}
+
 		bool hasNext() const;
 		bool next();
 
 	private:
+		template<typename T>
+		static T parseNumber(const char* first, size_t length)
+		{
+			if constexpr (std::is_enum_v<T>) {
+				return static_cast<T>(parseNumber<std::underlying_type_t<T>>(first, length));
+			} else if constexpr (std::is_floating_point_v<T>) {
+				T value{};
+				std::from_chars(first, first + length, value);
+				return value;
+			} else {
+				// parsed at full width and narrowed, as strtol/strtoul did, so
+				// a negative value read into an unsigned type wraps around
+				std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t> value{};
+				if (std::is_unsigned_v<T> && length != 0 && *first == '-') {
+					int64_t signedValue{};
+					std::from_chars(first, first + length, signedValue);
+					return static_cast<T>(signedValue);
+				}
+				std::from_chars(first, first + length, value);
+				return static_cast<T>(value);
+			}
+		}
+
+		template<typename T>
+		T getCell(size_t column) const
+		{
+			if constexpr (std::is_same_v<T, std::string_view>) {
+				return getString(column);
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				return std::string(getString(column));
+			} else {
+				return getNumber<T>(column);
+			}
+		}
+
+		template<typename... Ts, size_t... I>
+		std::tuple<Ts...> getRowCells(const std::array<size_t, sizeof...(Ts)>& columns, std::index_sequence<I...>) const
+		{
+			return { getCell<Ts>(columns[I])... };
+		}
+
 		MYSQL_RES* handle;
 		MYSQL_ROW row;
+		unsigned long* lengths = nullptr;
+		size_t columnCount = 0;
 
-		std::map<std::string_view, size_t> listNames;
+		std::vector<std::string_view> columnNames;
+		std::vector<ColumnKind> columnKinds;
+		gtl::flat_hash_map<std::string_view, size_t> columnIndexes;
 
 	friend class Database;
 };
@@ -5,34 +5,255 @@
 
 #include "configmanager.h"
 #include "databasemanager.h"
+#include "databasetasks.h"
 #include "luascript.h"
+#include "scheduler.h"
+#include "tasks.h"
+
+#include <deque>
 
 #include <fmt/format.h>
 
 extern ConfigManager g_config;
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+// backfills share the dispatcher with the game, so they run one short batch at a time
+constexpr uint32_t BACKFILL_BATCH_DELAY = 1000;
+constexpr uint32_t BACKFILL_REPORT_BATCHES = 10;
+
+// the first optimization after a start waits until the login rush is over
+constexpr int64_t OPTIMIZATION_START_DELAY = 10 * 60 * 1000;
 
-bool DatabaseManager::optimizeTables()
+struct Backfill
 {
-	Database& db = Database::getInstance();
+	std::string name;
+	std::string file;
+	lua_State* L = nullptr;
+	uint64_t rows = 0;
+	uint32_t batches = 0;
+};
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `TABLE_NAME` FROM `information_schema`.`TABLES` WHERE `TABLE_SCHEMA` = {:s} AND `DATA_FREE` > 0", db.escapeString(g_config.getString(ConfigManager::MYSQL_DB))));
-	if (not result)
+std::deque<Backfill> pendingBackfills;
+
+// OPTIMIZE TABLE can run for minutes, it gets a connection and a thread of its own so the
+// database tasks queue (async saves, the flush on server save) never waits behind it
+std::thread optimizationThread;
+
+lua_State* newMigrationState()
+{
+	lua_State* L = luaL_newstate();
+	if (not L)
 	{
-		return false;
+		return nullptr;
 	}
 
-	do
+	luaL_openlibs(L);
+
+	//db table
+	luaL_register(L, "db", LuaScriptInterface::luaDatabaseTable);
+
+	//result table
+	luaL_register(L, "result", LuaScriptInterface::luaResultTable);
+	return L;
+}
+
+void finishBackfill(bool completed)
+{
+	Backfill& backfill = pendingBackfills.front();
+	if (completed)
 	{
-		const auto tableName = result->getString("TABLE_NAME");
-		std::cout << "> Optimizing table " << tableName << "..." << std::flush;
+		DatabaseManager::registerDatabaseConfig("backfill_" + backfill.name, 1);
+		std::cout << "> Database backfill " << backfill.name << " completed, " << backfill.rows << " rows in " << backfill.batches << " batches." << std::endl;
+	}
 
-		if (db.executeQuery(fmt::format("OPTIMIZE TABLE `{:s}`", tableName)))
-			std::cout << " [success]" << std::endl;
+	if (backfill.L)
+	{
+		lua_close(backfill.L);
+	}
+	pendingBackfills.pop_front();
+}
+
+void runBackfillBatch()
+{
+	if (pendingBackfills.empty())
+	{
+		return;
+	}
+
+	Backfill& backfill = pendingBackfills.front();
+	if (not backfill.L)
+	{
+		backfill.L = newMigrationState();
+		if (not backfill.L || luaL_dofile(backfill.L, backfill.file.c_str()) != 0)
+		{
+			std::cout << "[Error - DatabaseManager::startBackfills - " << backfill.name << "] " << (backfill.L ? lua_tostring(backfill.L, -1) : "out of memory") << std::endl;
+			finishBackfill(false);
+			g_scheduler.addEvent(createSchedulerTask(BACKFILL_BATCH_DELAY, runBackfillBatch));
+			return;
+		}
+		std::cout << "> Running database backfill " << backfill.name << " in the background..." << std::endl;
+	}
+
+	if (LuaScriptInterface::reserveScriptEnv())
+	{
+		lua_State* L = backfill.L;
+		lua_getglobal(L, "onBackfillDatabase");
+		if (lua_pcall(L, 0, 1, 0) != 0)
+		{
+			LuaScriptInterface::resetScriptEnv();
+			std::cout << "[Error - DatabaseManager::startBackfills - " << backfill.name << "] " << lua_tostring(L, -1) << std::endl;
+			finishBackfill(false);
+			g_scheduler.addEvent(createSchedulerTask(BACKFILL_BATCH_DELAY, runBackfillBatch));
+			return;
+		}
+
+		// the batch returns how many rows it handled, nothing left to do once that is 0
+		const uint64_t rows = LuaScriptInterface::getNumber<uint64_t>(L, -1);
+		lua_pop(L, 1);
+		LuaScriptInterface::resetScriptEnv();
+
+		if (rows == 0)
+		{
+			finishBackfill(true);
+		}
 		else
-			std::cout << " [failed]" << std::endl;
+		{
+			backfill.rows += rows;
+			if (++backfill.batches % BACKFILL_REPORT_BATCHES == 0)
+			{
+				std::cout << "> Database backfill " << backfill.name << ": " << backfill.rows << " rows so far." << std::endl;
+			}
+		}
+	}
 
-	} while (result->next());
-	return true;
+	g_scheduler.addEvent(createSchedulerTask(BACKFILL_BATCH_DELAY, runBackfillBatch));
+}
+
+void optimizeNextTable(std::vector<std::string> tables)
+{
+	if (tables.empty())
+	{
+		DatabaseManager::registerDatabaseConfig("db_optimized_at", static_cast<int32_t>(time(nullptr)));
+		DatabaseManager::scheduleOptimization();
+		return;
+	}
+
+	std::string tableName = std::move(tables.back());
+	tables.pop_back();
+
+	// the previous table posted its result before the thread ended
+	if (optimizationThread.joinable())
+	{
+		optimizationThread.join();
+	}
+
+	optimizationThread = std::thread([tables = std::move(tables), tableName = std::move(tableName)]() mutable {
+		bool success = false;
+		{
+			Database db;
+			success = db.connect() && db.executeQuery(fmt::format("OPTIMIZE TABLE `{:s}`", tableName));
+		}
+
+		g_dispatcher.addTask(createTask([tables = std::move(tables), tableName = std::move(tableName), success]() {
+			std::cout << "> Optimized table " << tableName << (success ? " [success]" : " [failed]") << std::endl;
+
+			const uint32_t delay = std::max<int32_t>(0, g_config.getNumber(ConfigManager::DATABASE_OPTIMIZATION_DELAY)) * 1000;
+			g_scheduler.addEvent(createSchedulerTask(delay, [tables]() { optimizeNextTable(tables); }));
+		}));
+	});
+}
+
+}
+
+void DatabaseManager::startBackfills()
+{
+	const std::filesystem::path folder = "data/migrations/backfill";
+	std::error_code ec;
+	if (not std::filesystem::is_directory(folder, ec))
+	{
+		return;
+	}
+
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(folder, ec))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".lua")
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	for (const auto& file : files)
+	{
+		std::string name = file.stem().string();
+		int32_t done = 0;
+		if (getDatabaseConfig("backfill_" + name, done) && done != 0)
+		{
+			continue;
+		}
+
+		Backfill& backfill = pendingBackfills.emplace_back();
+		backfill.name = std::move(name);
+		backfill.file = file.generic_string();
+	}
+
+	if (pendingBackfills.empty())
+	{
+		return;
+	}
+
+	std::cout << "> " << pendingBackfills.size() << " database backfills pending, they run in the background." << std::endl;
+	g_scheduler.addEvent(createSchedulerTask(BACKFILL_BATCH_DELAY, runBackfillBatch));
+}
+
+void DatabaseManager::scheduleOptimization()
+{
+	if (not g_config.getBoolean(ConfigManager::OPTIMIZE_DATABASE))
+	{
+		return;
+	}
+
+	int32_t lastRun = 0;
+	getDatabaseConfig("db_optimized_at", lastRun);
+
+	const int64_t interval = std::max<int32_t>(1, g_config.getNumber(ConfigManager::DATABASE_OPTIMIZATION_INTERVAL)) * int64_t{60 * 60};
+	const int64_t wait = std::max<int64_t>(0, lastRun + interval - time(nullptr)) * 1000;
+	const int64_t delay = std::clamp<int64_t>(wait, OPTIMIZATION_START_DELAY, std::numeric_limits<uint32_t>::max());
+	g_scheduler.addEvent(createSchedulerTask(static_cast<uint32_t>(delay), &DatabaseManager::optimizeTables));
+}
+
+void DatabaseManager::optimizeTables()
+{
+	Database& db = Database::getInstance();
+	const std::string query = fmt::format("SELECT `TABLE_NAME` FROM `information_schema`.`TABLES` WHERE `TABLE_SCHEMA` = {:s} AND `DATA_FREE` > 0", db.escapeString(g_config.getString(ConfigManager::MYSQL_DB)));
+	g_databaseTasks.addTask(query, [](const DBResult_ptr& result, bool) {
+		std::vector<std::string> tables;
+		if (result)
+		{
+			do
+			{
+				tables.emplace_back(result->getString("TABLE_NAME"));
+			} while (result->next());
+		}
+
+		if (not tables.empty())
+		{
+			std::cout << "> Optimizing " << tables.size() << " database tables in the background..." << std::endl;
+		}
+		optimizeNextTable(std::move(tables));
+	}, true);
+}
+
+void DatabaseManager::stopOptimization()
+{
+	// waits for the table being optimized, the connection has no way to cancel it
+	if (optimizationThread.joinable())
+	{
+		optimizationThread.join();
+	}
 }
 
 bool DatabaseManager::tableExists(const std::string& tableName)
@@ -69,20 +290,12 @@ int32_t DatabaseManager::getDatabaseVersion()
 
 void DatabaseManager::updateDatabase()
 {
-	lua_State* L = luaL_newstate();
+	lua_State* L = newMigrationState();
 	if (not L)
 	{
 		return;
 	}
 
-	luaL_openlibs(L);
-
-	//db table
-	luaL_register(L, "db", LuaScriptInterface::luaDatabaseTable);
-
-	//result table
-	luaL_register(L, "result", LuaScriptInterface::luaResultTable);
-
 	int32_t version = getDatabaseVersion();
 	do
 	{
@@ -13,8 +13,15 @@ class DatabaseManager
 		static int32_t getDatabaseVersion();
 		static bool isDatabaseSetup();
 
-		static bool optimizeTables();
+		// schema changes in data/migrations/{version}.lua, they block the startup
 		static void updateDatabase();
+		// data backfills in data/migrations/backfill/*.lua, run in batches once the world is open
+		static void startBackfills();
+
+		// background maintenance, one table at a time with databaseOptimizationDelay between them
+		static void scheduleOptimization();
+		static void optimizeTables();
+		static void stopOptimization();
 
 		static bool getDatabaseConfig(const std::string& config, int32_t& value);
 		static void registerDatabaseConfig(const std::string& config, int32_t value);
@@ -6,11 +6,13 @@
 #include "pugicast.h"
 
 #include "actions.h"
+#include "ban.h"
 #include "bed.h"
 #include "configmanager.h"
 #include "console.h"
 #include "creature.h"
 #include "creatureevent.h"
+#include "databasemanager.h"
 #include "databasetasks.h"
 #include "events.h"
 #include "game.h"
@@ -20,6 +22,8 @@
 #include "items.h"
 #include "monster.h"
 #include "movement.h"
+#include "outputmessage.h"
+#include "profiler.h"
 #include "scheduler.h"
 #include "server.h"
 #include "spells.h"
@@ -99,6 +103,16 @@ void Game::start(ServiceManager* manager)
 	g_scheduler.addEvent(createSchedulerTask(50, [this]() { coro_timer_cycle(); }));
 	g_scheduler.addEvent(createSchedulerTask(100, [this]() { item_decay_cycle(); }));
 	g_scheduler.addEvent(createSchedulerTask(120, [this]() { equipment_decay_cycle(); }));
+
+	// updates queued by the tasks of a batch are written at its end, and again
+	// right before an autosend so the ones queued earlier in the same batch
+	// don't wait for the next autosend; monster awareness queries are shared
+	// for one batch only
+	g_dispatcher.setBatchEnd([this]() {
+		flushClientUpdates();
+		map.clearSectorSpectatorCache();
+	});
+	OutputMessagePool::getInstance().setBeforeAutosend([this]() { flushClientUpdates(); });
 }
 
 GameState_t Game::getGameState() const
@@ -208,6 +222,10 @@ void Game::saveGameState()
 
 	Map::save();
 
+	IOMarket::getInstance().flush();
+	IOLoginData::flushOfflinePlayers();
+	IOLoginData::reportOfflinePlayers();
+	reportClientUpdates();
 	g_databaseTasks.flush();
 
 	if (gameState == GAME_STATE_MAINTAIN) {
@@ -1364,7 +1382,7 @@ ReturnValue Game::internalMoveItem(CylinderPtr fromCylinder,
 	{
 		const auto& item_type = Item::items[item->getID()];
 		const uint32_t duration = item->getDuration();
-		const uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		const uint32_t call_time = OTSYS_TIME();
 		const uint32_t expiration = duration + call_time;
 		auto expirable_data = Expirable(item, expiration, call_time);
 		if (moveItem->getDecaying() != DECAYING_TRUE) 
@@ -1483,7 +1501,7 @@ ReturnValue Game::internalAddItem(CylinderPtr toCylinder, ItemPtr item, int32_t
 
 		const auto& item_type = Item::items[item->getID()];
 		const uint32_t duration = item->getDuration();
-		const uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		const uint32_t call_time = OTSYS_TIME();
 		const uint32_t expiration = duration + call_time;
 		auto expirable_data = Expirable(item, expiration, call_time);
 
@@ -1855,7 +1873,7 @@ ItemPtr Game::transformItem(const ItemPtr& item, const uint16_t newId, const int
 			newItem->setDecaying(DECAYING_TRUE);
             const auto& item_type = Item::items[newItem->getID()];
 			const uint32_t duration = newItem->getDuration();
-			const uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			const uint32_t call_time = OTSYS_TIME();
 			const uint32_t expiration = duration + call_time;
 			auto expirable_data = Expirable(newItem, expiration, call_time);
 
@@ -4931,6 +4949,7 @@ bool Game::internalCreatureSay(const CreaturePtr& creature, const SpeakClasses t
 // Todo : Investigate the actual necessity of creature->getHealth() > 0 checks in these methods
 void Game::checkCreatureWalk(const uint32_t creatureId) noexcept
 {
+	ProfileScope profile(Subsystem::CreatureWalk);
 	const auto& creature = getCreatureByID(creatureId);
 	if (creature and creature->getHealth() > 0) 
 	{
@@ -4940,6 +4959,7 @@ void Game::checkCreatureWalk(const uint32_t creatureId) noexcept
 
 void Game::updateCreatureWalk(const uint32_t creatureId) noexcept
 {
+	ProfileScope profile(Subsystem::CreatureWalk);
 	const auto& creature = getCreatureByID(creatureId);
 	if (creature and creature->getHealth() > 0) 
 	{
@@ -4949,6 +4969,7 @@ void Game::updateCreatureWalk(const uint32_t creatureId) noexcept
 
 void Game::checkCreatureAttack(const uint32_t creatureId) noexcept
 {
+	ProfileScope profile(Subsystem::Combat);
 	const auto& creature = getCreatureByID(creatureId);
 	if (creature and creature->getHealth() > 0) 
 	{
@@ -4995,14 +5016,27 @@ void Game::creature_think_cycle() noexcept
 {
     auto& checkCreatureList = slots_[current_slot_];
     current_slot_ = (current_slot_ + 1) % 20;
-auto valid_creatures = checkCreatureList 
-        | std::views::filter([](const auto& creature) { return creature->creatureCheck; })
-        | std::views::filter([](const auto& creature) { return creature->getHealth() > 0; });
+    const auto isChecked = [](const auto& creature) { return creature->creatureCheck and creature->getHealth() > 0; };
 
-    for (auto& creature : valid_creatures)
+    // monsters only queue their retarget, yell and defense decisions here,
+    // monsterAI takes them for the whole slot before anyone attacks
+    for (const auto& creature : checkCreatureList | std::views::filter(isChecked))
     {
+        ProfileScope profile(Subsystem::CreatureThink);
         creature->onThink(1000);
-        creature->onAttacking(1000);
+    }
+    {
+        ProfileScope profile(Subsystem::CreatureThink);
+        monsterAI.think(1000);
+    }
+
+    for (const auto& creature : checkCreatureList | std::views::filter(isChecked))
+    {
+        {
+            ProfileScope profile(Subsystem::Combat);
+            creature->onAttacking(1000);
+        }
+        ProfileScope profile(Subsystem::Conditions);
         creature->executeConditions(1000);
     }
 
@@ -5065,6 +5099,36 @@ void Game::internalCreatureChangeVisible(const CreaturePtr& creature, bool visib
 	}
 }
 
+void Game::flushClientUpdates()
+{
+	if (clientUpdates.empty()) {
+		return;
+	}
+
+	// swapped out first, so a player can be queued again while the batch is flushed
+	std::vector<PlayerPtr> players;
+	players.swap(clientUpdates);
+	for (const auto& player : players) {
+		player->flushClientUpdates();
+	}
+}
+
+void Game::reportClientUpdates() const
+{
+	ClientUpdateCounters totals;
+	for (const auto& player : players | std::views::values) {
+		const auto& counters = player->getClientUpdateCounters();
+		totals.queued += counters.queued;
+		totals.sent += counters.sent;
+		totals.unchanged += counters.unchanged;
+	}
+
+	if (totals.queued != 0) {
+		std::cout << fmt::format(">> Client updates of online players: {:d} queued, {:d} sent, {:d} unchanged ({:.1f}% not sent)", totals.queued, totals.sent,
+		                         totals.unchanged, (totals.queued - totals.sent) * 100.0 / totals.queued) << std::endl;
+	}
+}
+
 void Game::changeLight(const CreatureConstPtr& creature)
 {
 	//send to clients
@@ -5359,6 +5423,7 @@ void Game::combatGetTypeInfo(const CombatType_t combatType, const CreaturePtr& t
 
 bool Game::combatChangeHealth(const CreaturePtr& attacker, const CreaturePtr& target, CombatDamage& damage, bool showMessages)
 {
+	ProfileScope profile(Subsystem::Combat);
 	if (damage.primary.value == 0 && damage.secondary.value == 0) {
 		return true;
 	}
@@ -5671,6 +5736,7 @@ bool Game::combatChangeHealth(const CreaturePtr& attacker, const CreaturePtr& ta
 
 bool Game::combatChangeMana(const CreaturePtr& attacker, const CreaturePtr& target, CombatDamage& damage, bool showMessages)
 {
+	ProfileScope profile(Subsystem::Combat);
 	const auto targetPlayer = target->getPlayer();
 	if (!targetPlayer) {
 		return true;
@@ -5845,6 +5911,19 @@ void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, c
 	}
 }
 
+void Game::addMagicEffects(const SpectatorVec& spectators, const std::vector<Position>& positions, const uint8_t effect)
+{
+	if (positions.empty() || effect == CONST_ME_NONE) {
+		return;
+	}
+
+	for (const auto spectator : spectators) {
+		if (const auto tmpPlayer = spectator->getPlayer()) {
+			tmpPlayer->sendMagicEffects(positions, effect);
+		}
+	}
+}
+
 void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, const uint8_t effect)
 {
 	SpectatorVec spectators, toPosSpectators;
@@ -5946,7 +6025,7 @@ void Game::startDecay(const ItemPtr& item)
 		item->setDecaying(DECAYING_TRUE);
 		const auto& item_type = Item::items[item->getID()];
 		const uint32_t duration = item->getDuration();
-		const uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		const uint32_t call_time = OTSYS_TIME();
 		const uint32_t expiration = duration + call_time;
 		auto expirable_data = Expirable(item, expiration, call_time);
 
@@ -6004,16 +6083,20 @@ CoroTask Game::equipment_decay_cycle() noexcept
 {
     while (true) 
     {
-        uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        while (not equipped_expirables.empty() and equipped_expirables.top().getExpiration() <= call_time)
+        uint32_t call_time = OTSYS_TIME();
         {
-            Expirable expired_data = equipped_expirables.top();
-            equipped_expirables.pop();
-
-            if (auto it = decaying_eq.find(expired_data); it != decaying_eq.end()) 
+            // the scope has to end before co_await suspends
+            ProfileScope profile(Subsystem::Decay);
+            while (not equipped_expirables.empty() and equipped_expirables.top().getExpiration() <= call_time)
             {
-                decaying_eq.erase(it);
-                internalDecayItem(expired_data.getItem());
+                Expirable expired_data = equipped_expirables.top();
+                equipped_expirables.pop();
+
+                if (auto it = decaying_eq.find(expired_data); it != decaying_eq.end()) 
+                {
+                    decaying_eq.erase(it);
+                    internalDecayItem(expired_data.getItem());
+                }
             }
         }
 
@@ -6031,17 +6114,20 @@ CoroTask Game::item_decay_cycle() noexcept
 {
     while (true) 
 	{
-        uint32_t call_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-       while (not map_expirables.empty() and map_expirables.top().getExpiration() <= call_time)
-		{
-			auto item = map_expirables.top().getItem();
-			map_expirables.pop();
-    
-			if (item and not item->isRemoved() and item->getDecaying() == DECAYING_TRUE)
-			{
-				internalDecayItem(item);
-			}
-		}
+        uint32_t call_time = OTSYS_TIME();
+        {
+            ProfileScope profile(Subsystem::Decay);
+            while (not map_expirables.empty() and map_expirables.top().getExpiration() <= call_time)
+            {
+                auto item = map_expirables.top().getItem();
+                map_expirables.pop();
+
+                if (item and not item->isRemoved() and item->getDecaying() == DECAYING_TRUE)
+                {
+                    internalDecayItem(item);
+                }
+            }
+        }
 
         uint32_t next_time = MapDecayMaxInterval;
         if (not map_expirables.empty()) 
@@ -6116,6 +6202,7 @@ void Game::shutdown()
 
 	g_scheduler.shutdown();
 	g_databaseTasks.shutdown();
+	DatabaseManager::stopOptimization();
 	g_dispatcher.shutdown();
 	g_utility_boss.shutdown();
 	map.spawns.clear();
@@ -6143,6 +6230,7 @@ void Game::coro_timer_cycle()
 
 void Game::decay_clean_cycle()
 {
+	ProfileScope profile(Subsystem::Decay);
 	for (auto& expirable : equipped_decay_precache) 
 	{
 		addEquippedItemDecay(std::move(expirable));
@@ -6691,7 +6779,7 @@ void Game::playerCreateMarketOffer(const uint32_t playerId, uint8_t type, const
 		player->bankBalance -= debitBank;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.getID(), amount, price, anonymous);
+	IOMarket::createOffer(player->getGUID(), player->getName(), static_cast<MarketAction_t>(type), it.getID(), amount, price, anonymous);
 
 	player->sendMarketEnter();
 	const MarketOfferList& buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.getID());
@@ -6804,8 +6892,10 @@ void Game::playerAcceptMarketOffer(const uint32_t playerId, const uint32_t times
 		}
 
 		auto buyerPlayer = getPlayerByGUID(offer.playerId);
-		if (!buyerPlayer) {
-			if (!IOLoginData::loadPlayerById(buyerPlayer, offer.playerId)) {
+		const bool buyerOffline = !buyerPlayer;
+		if (buyerOffline) {
+			buyerPlayer = IOLoginData::getOfflinePlayer(offer.playerId);
+			if (!buyerPlayer) {
 				return;
 			}
 		}
@@ -6858,8 +6948,8 @@ void Game::playerAcceptMarketOffer(const uint32_t playerId, const uint32_t times
 			}
 		}
 
-		if (buyerPlayer->isOffline()) {
-			IOLoginData::savePlayer(buyerPlayer);
+		if (buyerOffline) {
+			IOLoginData::savePlayerLater(buyerPlayer);
 		} else {
 			buyerPlayer->onReceiveMail();
 		}
@@ -6945,8 +7035,10 @@ void Game::parsePlayerExtendedOpcode(const uint32_t playerId, const uint8_t opco
 	}
 }
 
-std::vector<ItemPtr> Game::getMarketItemList(const uint16_t wareId, const uint16_t sufficientCount, const PlayerConstPtr& player)
+std::vector<ItemPtr> Game::getMarketItemList(const uint16_t wareId, const uint16_t sufficientCount, const PlayerPtr& player)
 {
+	player->loadDepotItems();
+
 	uint16_t count = 0;
 	std::list<ContainerPtr> containers{ player->getInbox() };
 
@@ -7180,6 +7272,7 @@ bool Game::reload(const ReloadTypes_t reloadType)
 			g_augments->reload();
 			return true;
 	   }
+		case RELOAD_TYPE_BANS: return IOBan::load();
 		case RELOAD_TYPE_CHAT: return g_chat->load();
 		case RELOAD_TYPE_CONFIG: return g_config.reload();
 		case RELOAD_TYPE_CREATURESCRIPTS: {
@@ -10,6 +10,7 @@
 #include "combat.h"
 #include "groups.h"
 #include "map.h"
+#include "monsterai.h"
 #include "position.h"
 #include "item.h"
 #include "container.h"
@@ -116,8 +117,13 @@ struct TimerQueue
         queue.push({when, handle});
     }
 
+    // game time, so the offline simulator can fast-forward the coroutines
+    static TimePoint now() {
+        return TimePoint(std::chrono::milliseconds(OTSYS_TIME()));
+    }
+
     void tick() {
-        auto now = Clock::now();
+        auto now = TimerQueue::now();
         while (not queue.empty() and queue.top().wake <= now) 
 		{
             auto handle = queue.top().handle;
@@ -135,7 +141,7 @@ struct SleepFor
     bool await_ready() const noexcept { return ms == 0; }
     void await_suspend(std::coroutine_handle<> handle) const 
 	{
-        g_timer_queue.add(TimerQueue::Clock::now() + std::chrono::milliseconds(ms), handle);
+        g_timer_queue.add(TimerQueue::now() + std::chrono::milliseconds(ms), handle);
     }
     void await_resume() const noexcept {}
 };
@@ -565,7 +571,7 @@ class Game
 
 		void parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, const std::string& buffer);
 
-		std::vector<ItemPtr> getMarketItemList(uint16_t wareId, uint16_t sufficientCount, const PlayerConstPtr& player);
+		std::vector<ItemPtr> getMarketItemList(uint16_t wareId, uint16_t sufficientCount, const PlayerPtr& player);
 
 		void coro_timer_cycle();
 		void decay_clean_cycle();
@@ -579,6 +585,13 @@ class Game
 		void internalCreatureChangeOutfit(const CreaturePtr& creature, const Outfit_t& outfit);
 		void internalCreatureChangeVisible(const CreaturePtr& creature, bool visible);
 		void changeLight(const CreatureConstPtr& creature);
+
+		// players with stats, skills, icons, light or inventory updates waiting for the end of the dispatcher batch
+		void queueClientUpdates(const PlayerPtr& player) {
+			clientUpdates.push_back(player);
+		}
+		void flushClientUpdates();
+		void reportClientUpdates() const;
 		void updateCreatureSkull(const CreatureConstPtr& creature);
 		void updatePlayerShield(const PlayerPtr& player);
 		void updatePlayerHelpers(const PlayerConstPtr& player);
@@ -608,6 +621,7 @@ class Game
 		static void addCreatureHealth(const SpectatorVec& spectators, const CreatureConstPtr& target);
 		void addMagicEffect(const Position& pos, uint8_t effect);
 		static void addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect);
+		static void addMagicEffects(const SpectatorVec& spectators, const std::vector<Position>& positions, uint8_t effect);
 		void addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect);
 		static void addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect);
 
@@ -658,6 +672,7 @@ class Game
 
 		Groups groups;
 		Map map;
+		MonsterAI monsterAI;
 		Mounts mounts;
 		Raids raids;
 		Quests quests;
@@ -734,6 +749,7 @@ class Game
 		gtl::node_hash_map<uint32_t, PlayerPtr> players;
 		gtl::node_hash_map<std::string, PlayerPtr> mappedPlayerNames;
 		gtl::node_hash_map<uint32_t, PlayerPtr> mappedPlayerGuids;
+		std::vector<PlayerPtr> clientUpdates;
 
 		gtl::node_hash_map<uint16_t, ItemPtr> uniqueItems;
 		gtl::node_hash_map<uint32_t, gtl::flat_hash_map<uint32_t, int32_t>> accountStorageMap;
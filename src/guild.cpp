@@ -5,13 +5,40 @@
 
 #include "guild.h"
 
+#include "databasetasks.h"
 #include "game.h"
+#include "scheduler.h"
 
 extern Game g_game;
 
+namespace {
+
+// Wars are read with the guild, so one accepted since then is only in the database. Reloads
+// the wars of both guilds, if cached, when such a war is found.
+bool reloadActiveWar(const Guild_ptr& guild, uint32_t enemyGuildId)
+{
+	Database& db = Database::getInstance();
+	const uint32_t guildId = guild->getId();
+	if (!db.storeQuery(fmt::format("SELECT `id` FROM `guild_wars` WHERE `status` = {:d} AND ((`guild1` = {:d} AND `guild2` = {:d}) OR (`guild1` = {:d} AND `guild2` = {:d})) LIMIT 1",
+	                               static_cast<int>(WAR_ACTIVE), guildId, enemyGuildId, enemyGuildId, guildId))) {
+		return false;
+	}
+
+	for (const auto& cached : {guild, g_game.getGuild(enemyGuildId)}) {
+		if (cached) {
+			cached->getWars().clear();
+			IOGuild::getWarList(cached);
+		}
+	}
+	return true;
+}
+
+}
+
 void Guild::addMember(const PlayerPtr& player)
 {
 	membersOnline.push_back(player);
+	touch();
 	for (const auto member : membersOnline) {
 		g_game.updatePlayerHelpers(member);
 	}
@@ -19,7 +46,8 @@ void Guild::addMember(const PlayerPtr& player)
 
 void Guild::removeMember(const PlayerPtr& player)
 {
-	membersOnline.remove(player);
+	std::erase(membersOnline, player);
+	touch();
 	for (const auto member : membersOnline) {
 		g_game.updatePlayerHelpers(member);
 	}
@@ -115,64 +143,50 @@ bool Guild::isInAnyWar()
 	return false;
 }
 
-bool IOGuild::loadGuilds()
+Guild_ptr IOGuild::getGuild(uint32_t guildId)
 {
-	Database& db = Database::getInstance();
-	auto result = db.storeQuery("SELECT `id`, `name`, `balance` FROM `guilds`");
-	if (!result) {
-		return false;
+	if (auto guild = g_game.getGuild(guildId)) {
+		guild->touch();
+		return guild;
 	}
 
-	do {
-		uint32_t guildId = result->getNumber<uint32_t>("id");
-		auto name = result->getString("name");
-		uint64_t guildBalance = result->getNumber<uint64_t>("balance");
-
-		auto guild = std::make_shared<Guild>(guildId, name);
-		guild->setGuildBankBalance(guildBalance);
-
-		// Load Ranks
-		auto rankResult = db.storeQuery(fmt::format(
-			"SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `guild_id` = {}", guildId));
-		if (rankResult) {
-			do {
-				guild->addRank(
-					rankResult->getNumber<uint32_t>("id"),
-					rankResult->getString("name"),
-					rankResult->getNumber<uint16_t>("level")
-				);
-			} while (rankResult->next());
-		}
-
-		IOGuild::getWarList(guild);
-
+	auto guild = loadGuild(guildId);
+	if (guild) {
 		g_game.addGuild(guild);
-	} while (result->next());
-
-	return true;
+	}
+	return guild;
 }
 
 Guild_ptr IOGuild::loadGuild(uint32_t guildId)
 {
 	Database& db = Database::getInstance();
-	if (DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name`, `balance` FROM `guilds` WHERE `id` = {:d}", guildId))) {
-		auto name = result->getString("name");
-		uint64_t guildBalance = result->getNumber<uint64_t>("balance");
-
-		const auto& guild = std::make_shared<Guild>(guildId, name);
-		guild->setGuildBankBalance(guildBalance);
+	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name`, `balance`, `motd` FROM `guilds` WHERE `id` = {:d}", guildId));
+	if (!result) {
+		return nullptr;
+	}
 
-		if ((result = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `guild_id` = {:d}", guildId)))) {
-			do {
-				guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), result->getNumber<uint16_t>("level"));
-			} while (result->next());
-		}
+	const auto guild = std::make_shared<Guild>(guildId, result->getString("name"));
+	guild->setGuildBankBalance(result->getNumber<uint64_t>("balance"));
+	guild->setMotd(std::string(result->getString("motd")));
 
-		IOGuild::getWarList(guild);
+	if ((result = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `guild_id` = {:d}", guildId)))) {
+		const auto columns = result->getColumnIndexes("id", "name", "level");
+		do {
+			const auto [id, name, level] = result->getRow<uint32_t, std::string_view, uint8_t>(columns);
+			guild->addRank(id, name, level);
+		} while (result->next());
+	}
 
-		return guild;
+	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
+		const auto columns = result->getColumnIndexes("player_id", "rank_id", "nick");
+		do {
+			const auto [guid, rankId, nick] = result->getRow<uint32_t, uint32_t, std::string_view>(columns);
+			guild->setMember(guid, rankId, nick);
+		} while (result->next());
 	}
-	return nullptr;
+
+	IOGuild::getWarList(guild);
+	return guild;
 }
 
 uint32_t IOGuild::getGuildIdByName(const std::string& name)
@@ -222,4 +236,65 @@ void IOGuild::getWarList(const Guild_ptr& guild)
 		uint32_t opponentId = (guildId == guild1 ? guild2 : guild1);
 		guild->addWar(opponentId, war);
 	} while (result->next());
-}
\ No newline at end of file
+}
+
+void IOGuild::saveMember(uint32_t guildId, uint32_t guid, uint32_t rankId, const std::string& nick)
+{
+	Database& db = Database::getInstance();
+	g_databaseTasks.addTask(fmt::format(
+		"INSERT INTO `guild_membership` (`player_id`, `guild_id`, `rank_id`, `nick`) VALUES ({:d}, {:d}, {:d}, {:s}) "
+		"ON DUPLICATE KEY UPDATE `guild_id` = VALUES(`guild_id`), `rank_id` = VALUES(`rank_id`), `nick` = VALUES(`nick`)",
+		guid, guildId, rankId, db.escapeString(nick)));
+}
+
+void IOGuild::deleteMember(uint32_t guid)
+{
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `guild_membership` WHERE `player_id` = {:d}", guid));
+}
+
+void IOGuild::saveMotd(uint32_t guildId, const std::string& motd)
+{
+	Database& db = Database::getInstance();
+	g_databaseTasks.addTask(fmt::format("UPDATE `guilds` SET `motd` = {:s} WHERE `id` = {:d}", db.escapeString(motd), guildId));
+}
+
+bool IOGuild::addWarKill(const Guild_ptr& killerGuild, uint32_t targetGuildId, const std::string& killerName, const std::string& targetName)
+{
+	GuildWar* war = killerGuild->getWar(targetGuildId);
+	if (!war || war->status != WAR_ACTIVE) {
+		if (!reloadActiveWar(killerGuild, targetGuildId)) {
+			return false;
+		}
+
+		war = killerGuild->getWar(targetGuildId);
+		if (!war || war->status != WAR_ACTIVE) {
+			return false;
+		}
+	}
+
+	++war->frags;
+
+	Database& db = Database::getInstance();
+	g_databaseTasks.addTask(fmt::format(
+		"INSERT INTO `guildwar_kills` (`killer`, `target`, `killerguild`, `targetguild`, `time`, `warid`) VALUES ({:s}, {:s}, {:d}, {:d}, {:d}, {:d})",
+		db.escapeString(killerName), db.escapeString(targetName), killerGuild->getId(), targetGuildId, time(nullptr), war->id));
+	return true;
+}
+
+void IOGuild::evictIdleGuilds()
+{
+	const int64_t idleSince = OTSYS_TIME() - IDLE_TIME;
+
+	std::vector<uint32_t> idleGuilds;
+	for (const auto& [guildId, guild] : g_game.getGuilds()) {
+		if (guild->getMembersOnline().empty() && guild->getLastUsed() < idleSince) {
+			idleGuilds.push_back(guildId);
+		}
+	}
+
+	for (const uint32_t guildId : idleGuilds) {
+		g_game.removeGuild(guildId);
+	}
+
+	g_scheduler.addEvent(createSchedulerTask(EVICT_INTERVAL, &IOGuild::evictIdleGuilds));
+}
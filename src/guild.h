@@ -5,6 +5,8 @@
 #define FS_GUILD_H
 #include "creature.h"
 
+#include <gtl/phmap.hpp>
+
 class Player;
 
 enum WarStatus : uint8_t {
@@ -42,6 +44,11 @@ struct GuildRank {
 
 using GuildRank_ptr = std::shared_ptr<GuildRank>;
 
+struct GuildMember {
+	uint32_t rankId;
+	std::string nick;
+};
+
 class Guild
 {
 	public:
@@ -58,16 +65,35 @@ class Guild
 			return name;
 		}
 	
-		const std::list<PlayerPtr>& getMembersOnline() const {
+		const std::vector<PlayerPtr>& getMembersOnline() const {
 			return membersOnline;
 		}
-	
+
+		// every member, online or not, by player guid
+		const GuildMember* getMember(uint32_t guid) const {
+			auto it = members.find(guid);
+			return it != members.end() ? &it->second : nullptr;
+		}
+
+		void setMember(uint32_t guid, uint32_t rankId, std::string_view nick) {
+			members.insert_or_assign(guid, GuildMember{rankId, std::string(nick)});
+		}
+
+		void eraseMember(uint32_t guid) {
+			members.erase(guid);
+		}
+
 		uint32_t getMemberCount() const {
-			return memberCount;
+			return members.size();
 		}
-	
-		void setMemberCount(const uint32_t count) {
-			memberCount = count;
+
+		// last time the guild was looked up or had a member online, see IOGuild::evictIdleGuilds
+		int64_t getLastUsed() const {
+			return lastUsed;
+		}
+
+		void touch() {
+			lastUsed = OTSYS_TIME();
 		}
 
 		const std::vector<GuildRank_ptr>& getRanks() const {
@@ -111,12 +137,13 @@ class Guild
 		// Helper function for other methods checking war participation
 		bool isWarActive(const GuildWar* war);
 
-		std::list<PlayerPtr> membersOnline;
+		std::vector<PlayerPtr> membersOnline;
+		gtl::flat_hash_map<uint32_t, GuildMember> members;
 		std::vector<GuildRank_ptr> ranks;
 		std::string name;
 		std::string motd;
 		uint32_t id;
-		uint32_t memberCount = 0;
+		int64_t lastUsed = OTSYS_TIME();
 
 		uint64_t guildBankBalance = 0;
 		GuildWarMap m_mGuildWars;
@@ -126,11 +153,26 @@ using Guild_ptr = std::shared_ptr<Guild>;
 
 namespace IOGuild
 {
-	bool loadGuilds();
+	// guilds that had no member online and were not looked up for this long are dropped from the cache
+	static constexpr int64_t IDLE_TIME = 30 * 60 * 1000;
+	static constexpr uint32_t EVICT_INTERVAL = 5 * 60 * 1000;
+
+	/**
+	 * Returns the cached guild, loading it with its ranks, members and wars on first access.
+	 */
+	Guild_ptr getGuild(uint32_t guildId);
 	Guild_ptr loadGuild(uint32_t guildId);
 	uint32_t getGuildIdByName(const std::string& name);
 
 	void getWarList(const Guild_ptr& guild);
+
+	// write-through of changes made by the server, the cache is updated by the caller
+	void saveMember(uint32_t guildId, uint32_t guid, uint32_t rankId, const std::string& nick);
+	void deleteMember(uint32_t guid);
+	void saveMotd(uint32_t guildId, const std::string& motd);
+	bool addWarKill(const Guild_ptr& killerGuild, uint32_t targetGuildId, const std::string& killerName, const std::string& targetName);
+
+	void evictIdleGuilds();
 };
 
 #endif
@@ -198,13 +198,13 @@ bool House::transferToDepot() const
 	if (const auto player = g_game.getPlayerByGUID(owner)) {
 		transferToDepot(player);
 	} else {
-		const PlayerPtr tmpPlayer = std::make_shared<Player>(nullptr);
-		if (!IOLoginData::loadPlayerById(tmpPlayer, owner)) {
+		const auto tmpPlayer = IOLoginData::getOfflinePlayer(owner);
+		if (!tmpPlayer) {
 			return false;
 		}
 
 		transferToDepot(tmpPlayer);
-		IOLoginData::savePlayer(tmpPlayer);
+		IOLoginData::savePlayerLater(tmpPlayer);
 	}
 	return true;
 }
@@ -442,11 +442,7 @@ const Guild_ptr getGuildByName(const std::string& name)
 		return nullptr;
 	}
 
-	if (const auto guild = g_game.getGuild(guildId)) {
-		return guild;
-	}
-
-	return IOGuild::loadGuild(guildId);
+	return IOGuild::getGuild(guildId);
 }
 
 }
@@ -613,13 +609,57 @@ bool Houses::loadHousesXML(const std::string& filename)
 	return true;
 }
 
+namespace {
+
+time_t getRentPeriodDuration(const RentPeriod_t rentPeriod)
+{
+	switch (rentPeriod) {
+		case RENTPERIOD_DAILY:
+			return 24 * 60 * 60;
+		case RENTPERIOD_WEEKLY:
+			return 24 * 60 * 60 * 7;
+		case RENTPERIOD_MONTHLY:
+			return 24 * 60 * 60 * 30;
+		case RENTPERIOD_YEARLY:
+			return 24 * 60 * 60 * 365;
+		default:
+			return 0;
+	}
+}
+
+std::string getRentPeriodName(const RentPeriod_t rentPeriod)
+{
+	switch (rentPeriod) {
+		case RENTPERIOD_DAILY:
+			return "daily";
+		case RENTPERIOD_WEEKLY:
+			return "weekly";
+		case RENTPERIOD_MONTHLY:
+			return "monthly";
+		case RENTPERIOD_YEARLY:
+			return "annual";
+		default:
+			return {};
+	}
+}
+
+// owners per balance query and per debit statement
+constexpr size_t RENT_BATCH_SIZE = 1000;
+
+}
+
 void Houses::payHouses(const RentPeriod_t rentPeriod) const
 {
 	if (rentPeriod == RENTPERIOD_NEVER) {
 		return;
 	}
 
-	time_t currentTime = time(nullptr);
+	const time_t currentTime = time(nullptr);
+	const time_t paidUntil = currentTime + getRentPeriodDuration(rentPeriod);
+
+	// online owners pay from their loaded balance, offline owners are settled
+	// with a few statements on the players table
+	std::vector<House*> offlineHouses;
 	for (const auto& val : houseMap | std::views::values) {
 		House* house = val;
 		if (house->getOwner() == 0) {
@@ -631,79 +671,124 @@ void Houses::payHouses(const RentPeriod_t rentPeriod) const
 			continue;
 		}
 
-		const uint32_t ownerId = house->getOwner();
-		const auto town = g_game.map.towns.getTown(house->getTownId());
-		if (!town) {
+		if (!g_game.map.towns.getTown(house->getTownId())) {
 			continue;
 		}
 
-		PlayerPtr player = std::make_shared<Player>(nullptr);
-		if (!IOLoginData::loadPlayerById(player, ownerId)) {
-			// Player doesn't exist, reset house owner
-			house->setOwner(0);
+		const auto player = g_game.getPlayerByGUID(house->getOwner());
+		if (!player) {
+			// the balance is debited in the database, a cached copy would go stale
+			IOLoginData::releaseOfflinePlayer(house->getOwner());
+			offlineHouses.push_back(house);
 			continue;
 		}
 
 		if (player->getBankBalance() >= rent) {
 			player->setBankBalance(player->getBankBalance() - rent);
-
-			time_t paidUntil = currentTime;
-			switch (rentPeriod) {
-				case RENTPERIOD_DAILY:
-					paidUntil += 24 * 60 * 60;
-					break;
-				case RENTPERIOD_WEEKLY:
-					paidUntil += 24 * 60 * 60 * 7;
-					break;
-				case RENTPERIOD_MONTHLY:
-					paidUntil += 24 * 60 * 60 * 30;
-					break;
-				case RENTPERIOD_YEARLY:
-					paidUntil += 24 * 60 * 60 * 365;
-					break;
-				default:
-					break;
-			}
-
 			house->setPaidUntil(paidUntil);
 			house->setPayRentWarnings(0);
 		} else {
-			if (house->getPayRentWarnings() < 7) {
-				int32_t daysLeft = 7 - house->getPayRentWarnings();
+			chargeUnpaidRent(house, player, rentPeriod);
+		}
+	}
 
-				auto letter = Item::CreateItem(ITEM_LETTER_STAMPED);
-				std::string period;
+	Database& db = Database::getInstance();
+	for (size_t first = 0; first < offlineHouses.size(); first += RENT_BATCH_SIZE) {
+		const size_t last = std::min(first + RENT_BATCH_SIZE, offlineHouses.size());
 
-				switch (rentPeriod) {
-					case RENTPERIOD_DAILY:
-						period = "daily";
-						break;
+		std::string ownerIds;
+		for (size_t i = first; i < last; ++i) {
+			const House* house = offlineHouses[i];
+			if (!ownerIds.empty()) {
+				ownerIds.push_back(',');
+			}
+			ownerIds += std::to_string(house->getOwner());
+		}
 
-					case RENTPERIOD_WEEKLY:
-						period = "weekly";
-						break;
+		std::map<uint32_t, uint64_t> balances;
+		if (DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, `balance` FROM `players` WHERE `id` IN ({:s})", ownerIds))) {
+			const auto columns = result->getColumnIndexes("id", "balance");
+			do {
+				const auto [id, balance] = result->getRow<uint32_t, uint64_t>(columns);
+				balances[id] = balance;
+			} while (result->next());
+		}
 
-					case RENTPERIOD_MONTHLY:
-						period = "monthly";
-						break;
+		// an owner may hold several houses, each one is paid from what is left
+		std::map<uint32_t, uint64_t> debits;
+		for (size_t i = first; i < last; ++i) {
+			House* house = offlineHouses[i];
+			const uint32_t ownerId = house->getOwner();
+			auto balance = balances.find(ownerId);
+			if (balance == balances.end()) {
+				// Player doesn't exist, reset house owner
+				house->setOwner(0);
+				continue;
+			}
 
-					case RENTPERIOD_YEARLY:
-						period = "annual";
-						break;
+			const uint32_t rent = house->getRent();
+			if (balance->second >= rent) {
+				balance->second -= rent;
+				debits[ownerId] += rent;
+				house->setPaidUntil(paidUntil);
+				house->setPayRentWarnings(0);
+				continue;
+			}
 
-					default:
-						break;
+			// warning letters and evictions need the owner loaded, that is left to
+			// the dispatcher one house at a time
+			g_dispatcher.addTask(createTask([houseId = house->getId(), ownerId, rentPeriod]() {
+				House* house = g_game.map.houses.getHouse(houseId);
+				if (!house || house->getOwner() != ownerId) {
+					return;
 				}
 
-				letter->setText(fmt::format("Warning! \nThe {:s} rent of {:d} gold for your house \"{:s}\" is payable. Have it within {:d} days or you will lose this house.", period, house->getRent(), house->getName(), daysLeft));
-				CylinderPtr inbox = player->getInbox();
-				g_game.internalAddItem(inbox, letter, INDEX_WHEREEVER, FLAG_NOLIMIT);
-				house->setPayRentWarnings(house->getPayRentWarnings() + 1);
-			} else {
-				house->setOwner(0, true, player);
+				auto player = g_game.getPlayerByGUID(ownerId);
+				const bool offline = !player;
+				if (offline) {
+					player = IOLoginData::getOfflinePlayer(ownerId);
+					if (!player) {
+						house->setOwner(0);
+						return;
+					}
+				}
+
+				chargeUnpaidRent(house, player, rentPeriod);
+				if (offline) {
+					IOLoginData::savePlayerLater(player);
+				}
+			}));
+		}
+
+		if (debits.empty()) {
+			continue;
+		}
+
+		std::string cases;
+		std::string debitIds;
+		for (const auto& [ownerId, debit] : debits) {
+			cases += fmt::format(" WHEN {:d} THEN {:d}", ownerId, debit);
+			if (!debitIds.empty()) {
+				debitIds.push_back(',');
 			}
+			debitIds += std::to_string(ownerId);
 		}
+		db.executeQuery(fmt::format("UPDATE `players` SET `balance` = `balance` - CASE `id`{:s} END WHERE `id` IN ({:s})", cases, debitIds));
+	}
+}
 
-		IOLoginData::savePlayer(player);
+void Houses::chargeUnpaidRent(House* house, const PlayerPtr& player, const RentPeriod_t rentPeriod)
+{
+	if (house->getPayRentWarnings() >= 7) {
+		house->setOwner(0, true, player);
+		return;
 	}
+
+	const int32_t daysLeft = 7 - house->getPayRentWarnings();
+
+	auto letter = Item::CreateItem(ITEM_LETTER_STAMPED);
+	letter->setText(fmt::format("Warning! \nThe {:s} rent of {:d} gold for your house \"{:s}\" is payable. Have it within {:d} days or you will lose this house.", getRentPeriodName(rentPeriod), house->getRent(), house->getName(), daysLeft));
+	CylinderPtr inbox = player->getInbox();
+	g_game.internalAddItem(inbox, letter, INDEX_WHEREEVER, FLAG_NOLIMIT);
+	house->setPayRentWarnings(house->getPayRentWarnings() + 1);
 }
@@ -308,6 +308,9 @@ class Houses
 		}
 
 	private:
+		// Sends the owner a rent warning letter, or evicts them after the last one
+		static void chargeUnpaidRent(House* house, const PlayerPtr& player, RentPeriod_t rentPeriod);
+
 		HouseMap houseMap;
 };
 
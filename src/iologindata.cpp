@@ -7,6 +7,7 @@
 #include "configmanager.h"
 #include "game.h"
 #include "accountmanager.h"
+#include "scheduler.h"
 
 #include <fmt/format.h>
 
@@ -19,6 +20,77 @@ extern Game g_game;
 const size_t MAX_AUGMENT_DATA_SIZE = 1024 * 64; // 64 KB is the limit for BLOB
 const uint32_t MAX_AUGMENT_COUNT = 100; // Augments should not break size limit if we limit how many can go on a single player or item
 
+namespace {
+
+struct OfflinePlayer {
+	PlayerPtr player;
+	int64_t cachedAt;
+	bool dirty = false;
+};
+
+// entries older than this are loaded again, changes made to the database meanwhile are picked up
+constexpr int64_t OFFLINE_PLAYER_TTL = 5 * 60 * 1000;
+constexpr uint32_t OFFLINE_PLAYER_FLUSH_DELAY = 5000;
+
+// most recently used first
+std::list<OfflinePlayer> offlinePlayers;
+gtl::flat_hash_map<uint32_t, std::list<OfflinePlayer>::iterator> offlinePlayersByGuid;
+gtl::flat_hash_map<std::string, uint32_t> offlinePlayersByName;
+
+bool offlinePlayerFlushScheduled = false;
+uint64_t offlinePlayerHits = 0;
+uint64_t offlinePlayerMisses = 0;
+
+void eraseOfflinePlayer(std::list<OfflinePlayer>::iterator it)
+{
+	if (it->dirty) {
+		IOLoginData::savePlayer(it->player);
+	}
+
+	offlinePlayersByName.erase(asLowerCaseString(it->player->getName()));
+	offlinePlayersByGuid.erase(it->player->getGUID());
+	offlinePlayers.erase(it);
+}
+
+void cacheOfflinePlayer(const PlayerPtr& player, bool dirty)
+{
+	const size_t capacity = std::max<int32_t>(0, g_config.getNumber(ConfigManager::OFFLINE_PLAYER_CACHE_SIZE));
+	if (capacity == 0) {
+		if (dirty) {
+			IOLoginData::savePlayer(player);
+		}
+		return;
+	}
+
+	IOLoginData::releaseOfflinePlayer(player->getGUID());
+	while (offlinePlayers.size() >= capacity) {
+		eraseOfflinePlayer(std::prev(offlinePlayers.end()));
+	}
+
+	offlinePlayers.push_front({player, OTSYS_TIME(), dirty});
+	offlinePlayersByGuid[player->getGUID()] = offlinePlayers.begin();
+	offlinePlayersByName[asLowerCaseString(player->getName())] = player->getGUID();
+}
+
+PlayerPtr findOfflinePlayer(uint32_t guid)
+{
+	auto it = offlinePlayersByGuid.find(guid);
+	if (it == offlinePlayersByGuid.end()) {
+		return nullptr;
+	}
+
+	auto entry = it->second;
+	if (entry->cachedAt + OFFLINE_PLAYER_TTL < OTSYS_TIME()) {
+		eraseOfflinePlayer(entry);
+		return nullptr;
+	}
+
+	offlinePlayers.splice(offlinePlayers.begin(), offlinePlayers, entry);
+	return entry->player;
+}
+
+}
+
 
 // perfect use case for std::expected <Account, bool>
 Account IOLoginData::loadAccount(uint32_t accno)
@@ -518,12 +590,18 @@ bool IOLoginData::preloadPlayer(const PlayerPtr& player)
 
 bool IOLoginData::loadPlayerById(const PlayerPtr& player, uint32_t id)
 {
+	releaseOfflinePlayer(id);
+
 	Database& db = Database::getInstance();
 	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}", id)));
 }
 
 bool IOLoginData::loadPlayerByName(const PlayerPtr& player, const std::string& name)
 {
+	if (auto it = offlinePlayersByName.find(asLowerCaseString(name)); it != offlinePlayersByName.end()) {
+		releaseOfflinePlayer(it->second);
+	}
+
 	Database& db = Database::getInstance();
 	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}", db.escapeString(name))));
 }
@@ -684,17 +762,15 @@ bool IOLoginData::loadPlayer(const PlayerPtr& player, DBResult_ptr result)
 		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
 		player->guildNick = result->getString("nick");
 
-		auto guild = g_game.getGuild(guildId);
+		auto guild = IOGuild::getGuild(guildId);
 		if (!guild) {
-			guild = IOGuild::loadGuild(guildId);
-			if (guild) {
-				g_game.addGuild(guild);
-			} else {
-				std::cout << "[Warning - IOLoginData::loadPlayer] " << player->name << " has Guild ID " << guildId << " which doesn't exist" << std::endl;
-			}
+			std::cout << "[Warning - IOLoginData::loadPlayer] " << player->name << " has Guild ID " << guildId << " which doesn't exist" << std::endl;
 		}
 
 		if (guild) {
+			// the membership row is authoritative, it may have been changed while the guild was cached
+			guild->setMember(player->getGUID(), playerRankId, player->guildNick);
+
 			player->guild = guild;
 			GuildRank_ptr rank = guild->getRankById(playerRankId);
 			if (!rank) {
@@ -709,10 +785,6 @@ bool IOLoginData::loadPlayer(const PlayerPtr& player, DBResult_ptr result)
 			}
 
 			player->guildRank = rank;
-
-			if ((result = db.storeQuery(fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
-				guild->setMemberCount(result->getNumber<uint32_t>("members"));
-			}
 		}
 	}
 
@@ -747,111 +819,8 @@ bool IOLoginData::loadPlayer(const PlayerPtr& player, DBResult_ptr result)
 		}
 	}
 
-	//load depot items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<ItemPtr, int32_t>& pair = it->second;
-			auto item = pair.first;
-
-			int32_t pid = pair.second;
-			if (pid >= 0 && pid < 100) {
-				if (auto depotChest = player->getDepotChest(pid, true)) {
-					depotChest->internalAddThing(item);
-				}
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				if (auto container = it2->second.first->getContainer()) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	// Load reward items
-    itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `sid`, `pid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_rewarditems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID()))))
-	{
-		loadItems(itemMap, result);
-		int64_t current_time = time(nullptr);
-
-		std::set<uint32_t> excludedPids;
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it)
-		{
-			const std::pair<ItemPtr, uint32_t>& pair = it->second;
-			auto& item = pair.first;
-			uint32_t pid = pair.second;
-
-			if (excludedPids.count(pid))
-			{
-				excludedPids.insert(it->first);
-				continue;
-			}
-
-			if (auto container = item->getContainer())
-			{
-				if (item->getIntAttr(ITEM_ATTRIBUTE_DATE) < current_time)
-				{
-					excludedPids.insert(it->first);
-					continue;
-				}
-			}
-
-			if (pid == 0)
-			{
-				auto& rewardChest = player->getRewardChest();
-				rewardChest->internalAddThing(item);
-			}
-			else
-			{
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end())
-				{
-					continue;
-				}
-
-				if (auto container = it2->second.first->getContainer())
-				{
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	//load inbox items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<ItemPtr, int32_t>& pair = it->second;
-			auto item = pair.first;
-
-			if (int32_t pid = pair.second; pid >= 0 && pid < 100) {
-				player->getInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				if (auto container = it2->second.first->getContainer()) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
+	// depot chests, inbox and reward chest are only read when first needed, see loadDepotItems
+	player->depotItemsPending = true;
 
 	//load store inbox items
 	itemMap.clear();
@@ -1180,6 +1149,9 @@ bool IOLoginData::saveAugments(const PlayerConstPtr& player, DBInsert& query_ins
 
 bool IOLoginData::addRewardItems(uint32_t playerID, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream)
 {
+	// saving a cached copy later would replace the reward items written here
+	releaseOfflinePlayer(playerID);
+
 	using ContainerBlock = std::pair<ContainerPtr, int32_t>;
 	std::vector<ContainerBlock> containers;
 	containers.reserve(32);
@@ -1301,6 +1273,116 @@ bool IOLoginData::addRewardItems(uint32_t playerID, const ItemBlockList& itemLis
 	return query_insert.execute();
 }
 
+void IOLoginData::loadDepotItems(const PlayerPtr& player)
+{
+	Database& db = Database::getInstance();
+	DBResult_ptr result;
+	ItemMap itemMap;
+
+	//load depot items
+	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
+		loadItems(itemMap, result);
+
+		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+			const std::pair<ItemPtr, int32_t>& pair = it->second;
+			auto item = pair.first;
+
+			int32_t pid = pair.second;
+			if (pid >= 0 && pid < 100) {
+				if (auto depotChest = player->getDepotChest(pid, true)) {
+					depotChest->internalAddThing(item);
+				}
+			} else {
+				ItemMap::const_iterator it2 = itemMap.find(pid);
+				if (it2 == itemMap.end()) {
+					continue;
+				}
+
+				if (auto container = it2->second.first->getContainer()) {
+					container->internalAddThing(item);
+				}
+			}
+		}
+	}
+
+	// Load reward items
+    itemMap.clear();
+
+	if ((result = db.storeQuery(fmt::format("SELECT `sid`, `pid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_rewarditems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID()))))
+	{
+		loadItems(itemMap, result);
+		int64_t current_time = time(nullptr);
+
+		std::set<uint32_t> excludedPids;
+
+		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it)
+		{
+			const std::pair<ItemPtr, uint32_t>& pair = it->second;
+			auto& item = pair.first;
+			uint32_t pid = pair.second;
+
+			if (excludedPids.count(pid))
+			{
+				excludedPids.insert(it->first);
+				continue;
+			}
+
+			if (auto container = item->getContainer())
+			{
+				if (item->getIntAttr(ITEM_ATTRIBUTE_DATE) < current_time)
+				{
+					excludedPids.insert(it->first);
+					continue;
+				}
+			}
+
+			if (pid == 0)
+			{
+				auto& rewardChest = player->getRewardChest();
+				rewardChest->internalAddThing(item);
+			}
+			else
+			{
+				ItemMap::const_iterator it2 = itemMap.find(pid);
+				if (it2 == itemMap.end())
+				{
+					continue;
+				}
+
+				if (auto container = it2->second.first->getContainer())
+				{
+					container->internalAddThing(item);
+				}
+			}
+		}
+	}
+
+	//load inbox items
+	itemMap.clear();
+
+	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
+		loadItems(itemMap, result);
+
+		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+			const std::pair<ItemPtr, int32_t>& pair = it->second;
+			auto item = pair.first;
+
+			if (int32_t pid = pair.second; pid >= 0 && pid < 100) {
+				player->getInbox()->internalAddThing(item);
+			} else {
+				ItemMap::const_iterator it2 = itemMap.find(pid);
+
+				if (it2 == itemMap.end()) {
+					continue;
+				}
+
+				if (auto container = it2->second.first->getContainer()) {
+					container->internalAddThing(item);
+				}
+			}
+		}
+	}
+}
 
 bool IOLoginData::savePlayer(const PlayerPtr& player)
 {
@@ -1456,55 +1538,57 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 		return false;
 	}
 
-	//save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	// depot items that were never loaded are still stored as they were
+	if (!player->depotItemsPending) {
+		//save depot items
+		if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+			return false;
+		}
 
-	DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
-	itemList.clear();
+		DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+		itemList.clear();
 
-	for (const auto& it : player->depotChests) {
-		for (auto item : it.second->getItemList()) {
-			itemList.emplace_back(it.first, item);
+		for (const auto& it : player->depotChests) {
+			for (auto item : it.second->getItemList()) {
+				itemList.emplace_back(it.first, item);
+			}
 		}
-	}
 
-	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-		return false;
-	}
-
-	// save reward items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_rewarditems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+		if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
+			return false;
+		}
 
-	DBInsert rewardQuery("INSERT INTO `player_rewarditems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
-	itemList.clear();
+		// save reward items
+		if (!db.executeQuery(fmt::format("DELETE FROM `player_rewarditems` WHERE `player_id` = {:d}", player->getGUID()))) {
+			return false;
+		}
 
-	for (auto item : player->getRewardChest()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
+		DBInsert rewardQuery("INSERT INTO `player_rewarditems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+		itemList.clear();
 
-	if (!saveItems(player, itemList, rewardQuery, propWriteStream)) {
-		return false;
-	}
+		for (auto item : player->getRewardChest()->getItemList()) {
+			itemList.emplace_back(0, item);
+		}
 
+		if (!saveItems(player, itemList, rewardQuery, propWriteStream)) {
+			return false;
+		}
 
-	//save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+		//save inbox items
+		if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+			return false;
+		}
 
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
-	itemList.clear();
+		DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+		itemList.clear();
 
-	for (auto item : player->getInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
+		for (auto item : player->getInbox()->getItemList()) {
+			itemList.emplace_back(0, item);
+		}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
+		if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
+			return false;
+		}
 	}
 
 	//save store inbox items
@@ -1634,26 +1718,22 @@ void IOLoginData::loadItems(ItemMap& itemMap, const DBResult_ptr& result)
 {
 	Database& db = Database::getInstance();
 
+	const auto columns = result->getColumnIndexes("sid", "pid", "itemtype", "count", "attributes", "augments", "skills", "stats");
+
 	do {
-		uint32_t sid = result->getNumber<uint32_t>("sid");
-		uint32_t pid = result->getNumber<uint32_t>("pid");
-		uint16_t type = result->getNumber<uint16_t>("itemtype");
-		uint16_t count = result->getNumber<uint16_t>("count");
+		const auto [sid, pid, type, count, attr, augmentData, skill_data, stat_data] =
+			result->getRow<uint32_t, uint32_t, uint16_t, uint16_t, std::string_view, std::string_view, std::string_view, std::string_view>(columns);
 
 		// Load the attributes field
-		auto attr = result->getString("attributes");
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
-		auto augmentData = result->getString("augments");
 		PropStream augmentStream;
 		augmentStream.init(augmentData.data(), augmentData.size());
 
-		auto skill_data = result->getString("skills");
 		PropStream skill_stream;
 		skill_stream.init(skill_data.data(), skill_data.size());
 
-		auto stat_data = result->getString("stats");
 		PropStream stat_stream;
 		stat_stream.init(stat_data.data(), stat_data.size());
 
@@ -1686,9 +1766,20 @@ void IOLoginData::loadItems(ItemMap& itemMap, const DBResult_ptr& result)
 
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
 {
+	releaseOfflinePlayer(guid);
 	Database::getInstance().executeQuery(fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
 }
 
+uint32_t IOLoginData::getDepotItemCount(uint32_t guid)
+{
+	// every stored row is one item of the depot chests or the inbox, nested ones included
+	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT (SELECT COUNT(*) FROM `player_depotitems` WHERE `player_id` = {:d}) + (SELECT COUNT(*) FROM `player_inboxitems` WHERE `player_id` = {:d}) AS `count`", guid, guid));
+	if (!result) {
+		return 0;
+	}
+	return result->getNumber<uint32_t>("count");
+}
+
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid)
 {
 	Database& db = Database::getInstance();
@@ -1746,4 +1837,100 @@ bool IOLoginData::accountExists(const std::string& accountName)
 	return result != nullptr;
 }
 
+PlayerPtr IOLoginData::getOfflinePlayer(uint32_t guid)
+{
+	if (auto player = findOfflinePlayer(guid)) {
+		++offlinePlayerHits;
+		return player;
+	}
+
+	++offlinePlayerMisses;
+	const auto player = std::make_shared<Player>(nullptr);
+	if (!loadPlayerById(player, guid)) {
+		return nullptr;
+	}
+
+	cacheOfflinePlayer(player, false);
+	return player;
+}
+
+PlayerPtr IOLoginData::getOfflinePlayerByName(const std::string& name)
+{
+	if (auto it = offlinePlayersByName.find(asLowerCaseString(name)); it != offlinePlayersByName.end()) {
+		if (auto player = findOfflinePlayer(it->second)) {
+			++offlinePlayerHits;
+			return player;
+		}
+	}
+
+	++offlinePlayerMisses;
+	const auto player = std::make_shared<Player>(nullptr);
+	if (!loadPlayerByName(player, name)) {
+		return nullptr;
+	}
 
+	cacheOfflinePlayer(player, false);
+	return player;
+}
+
+void IOLoginData::savePlayerLater(const PlayerPtr& player)
+{
+	auto it = offlinePlayersByGuid.find(player->getGUID());
+	if (it == offlinePlayersByGuid.end() || it->second->player != player) {
+		// not (or no longer) cached, nothing would write it later
+		savePlayer(player);
+		return;
+	}
+
+	it->second->dirty = true;
+	if (!offlinePlayerFlushScheduled) {
+		offlinePlayerFlushScheduled = true;
+		g_scheduler.addEvent(createSchedulerTask(OFFLINE_PLAYER_FLUSH_DELAY, &IOLoginData::flushOfflinePlayers));
+	}
+}
+
+void IOLoginData::hibernatePlayer(const PlayerPtr& player)
+{
+	if (g_game.getPlayerByGUID(player->getGUID())) {
+		// logged in again before the logout was processed
+		return;
+	}
+
+	// offline players have no creature id, see Player::isOffline
+	player->id = 0;
+	cacheOfflinePlayer(player, false);
+}
+
+void IOLoginData::releaseOfflinePlayer(uint32_t guid)
+{
+	if (auto it = offlinePlayersByGuid.find(guid); it != offlinePlayersByGuid.end()) {
+		eraseOfflinePlayer(it->second);
+	}
+}
+
+void IOLoginData::flushOfflinePlayers()
+{
+	offlinePlayerFlushScheduled = false;
+
+	const int64_t expiredBefore = OTSYS_TIME() - OFFLINE_PLAYER_TTL;
+	for (auto it = offlinePlayers.begin(); it != offlinePlayers.end();) {
+		if (it->cachedAt < expiredBefore) {
+			eraseOfflinePlayer(it++);
+			continue;
+		}
+
+		if (it->dirty) {
+			savePlayer(it->player);
+			it->dirty = false;
+		}
+		++it;
+	}
+}
+
+void IOLoginData::reportOfflinePlayers()
+{
+	if (const uint64_t lookups = offlinePlayerHits + offlinePlayerMisses; lookups != 0) {
+		std::cout << fmt::format(">> Offline players: {:d} cached, {:d} hits, {:d} misses ({:.1f}% hit rate)", offlinePlayers.size(), offlinePlayerHits,
+		                         offlinePlayerMisses, offlinePlayerHits * 100.0 / lookups) << std::endl;
+	}
+}
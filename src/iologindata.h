@@ -30,6 +30,8 @@ class IOLoginData
 		static bool loadPlayerByName(const PlayerPtr& player, const std::string& name);
 		static bool loadPlayer(const PlayerPtr& player, DBResult_ptr result);
 		static bool savePlayer(const PlayerPtr& player);
+		static void loadDepotItems(const PlayerPtr& player);
+		static uint32_t getDepotItemCount(uint32_t guid);
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 		static std::string getNameByGuid(uint32_t guid);
@@ -48,6 +50,22 @@ class IOLoginData
 
 		static bool accountExists(const std::string& accountName);
 
+		/**
+		 * Offline players are kept in a bounded LRU after logout or after
+		 * being loaded for offline work (mail, market, house transfers), so
+		 * repeated lookups don't go to the database. Callers that change an
+		 * offline player report it with savePlayerLater; changes are written
+		 * shortly after, when the entry is evicted or on server save.
+		 */
+		static PlayerPtr getOfflinePlayer(uint32_t guid);
+		static PlayerPtr getOfflinePlayerByName(const std::string& name);
+		static void savePlayerLater(const PlayerPtr& player);
+		static void hibernatePlayer(const PlayerPtr& player);
+		// writes pending changes and drops the entry, before the player is loaded or written elsewhere
+		static void releaseOfflinePlayer(uint32_t guid);
+		static void flushOfflinePlayers();
+		static void reportOfflinePlayers();
+
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<ItemPtr, uint32_t>>;
 
@@ -89,6 +89,7 @@ std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::fi
 
 		map->width = root_header.width;
 		map->height = root_header.height;
+		map->sectors.reserve(root_header.width, root_header.height);
 
 		map_size = pack_map_size(root_header.width, root_header.height);
 
@@ -21,9 +21,10 @@ void IOMapSerialize::loadHouseItems(Map* map)
 		return;
 	}
 
-	do {
+	const size_t dataColumn = result->getColumnIndex("data");
 
-		auto attr = result->getString("data");
+	do {
+		auto attr = result->getString(dataColumn);
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
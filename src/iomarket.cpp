@@ -16,31 +16,67 @@
 extern ConfigManager g_config;
 extern Game g_game;
 
+namespace {
+
+// changes are written to the database this long after the first one
+constexpr uint32_t MARKET_FLUSH_DELAY = 5000;
+
+// rows per batched statement, well below the usual max_allowed_packet
+constexpr size_t MARKET_FLUSH_BATCH = 500;
+
+}
+
+bool IOMarket::loadOffers()
+{
+	IOMarket& market = getInstance();
+
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `o`.`id`, `o`.`player_id`, `o`.`sale`, `o`.`itemtype`, `o`.`amount`, `o`.`price`, `o`.`created`, `o`.`anonymous`, `p`.`name` AS `player_name` FROM `market_offers` AS `o` LEFT JOIN `players` AS `p` ON `p`.`id` = `o`.`player_id`");
+	if (!result) {
+		return true;
+	}
+
+	do {
+		Offer offer;
+		offer.id = result->getNumber<uint32_t>("id");
+		offer.playerId = result->getNumber<uint32_t>("player_id");
+		offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
+		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = result->getNumber<uint16_t>("amount");
+		offer.price = result->getNumber<uint32_t>("price");
+		offer.created = result->getNumber<uint32_t>("created");
+		offer.anonymous = result->getNumber<uint16_t>("anonymous") != 0;
+		offer.playerName = result->getString("player_name");
+
+		market.nextOfferId = std::max(market.nextOfferId, offer.id + 1);
+		market.addOffer(std::move(offer));
+	} while (result->next());
+	return true;
+}
+
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId)
 {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}", Titan::to_underlying(action), itemId));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.books.find(bookKey(itemId, action));
+	if (it == market.books.end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
+	for (const auto& [price, id] : it->second) {
+		const Offer& entry = market.offers.at(id);
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
+		offer.amount = entry.amount;
+		offer.price = entry.price;
+		offer.timestamp = entry.created + marketOfferDuration;
+		offer.counter = entry.id & 0xFFFF;
 		offer.itemId = itemId;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
-		} else {
-			offer.playerName = "Anonymous";
-		}
-		offerList.push_back(offer);
-	} while (result->next());
+		offer.playerName = entry.anonymous ? "Anonymous" : entry.playerName;
+		offerList.push_back(std::move(offer));
+	}
 	return offerList;
 }
 
@@ -48,22 +84,28 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, Titan::to_underlying(action)));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (const uint32_t id : it->second) {
+		const Offer& entry = market.offers.at(id);
+		if (entry.type != action) {
+			continue;
+		}
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offerList.push_back(offer);
-	} while (result->next());
+		offer.amount = entry.amount;
+		offer.price = entry.price;
+		offer.timestamp = entry.created + marketOfferDuration;
+		offer.counter = entry.id & 0xFFFF;
+		offer.itemId = entry.itemId;
+		offerList.push_back(std::move(offer));
+	}
 	return offerList;
 }
 
@@ -95,80 +137,82 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 	return offerList;
 }
 
-void IOMarket::processExpiredOffers(const DBResult_ptr& result, bool)
+void IOMarket::returnExpiredOffer(const Offer& offer)
 {
-	if (!result) {
-		return;
-	}
-
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
-			continue;
+	const uint32_t playerId = offer.playerId;
+	const uint16_t amount = offer.amount;
+	if (offer.type == MARKETACTION_SELL) {
+		const ItemType& itemType = Item::items[offer.itemId];
+		if (itemType.getID() == 0) {
+			return;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
-			if (itemType.getID() == 0) {
-				continue;
-			}
-
-			auto player = g_game.getPlayerByGUID(playerId);
+		auto player = g_game.getPlayerByGUID(playerId);
+		const bool offline = !player;
+		if (offline) {
+			player = IOLoginData::getOfflinePlayer(playerId);
 			if (!player) {
-				player = std::make_shared<Player>(nullptr);
-				if (!IOLoginData::loadPlayerById(player, playerId)) {
-					continue;
-				}
+				return;
 			}
+		}
 
-			if (itemType.stackable) {
-				uint16_t tmpAmount = amount;
-				while (tmpAmount > 0) {
-					uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
-					auto item = Item::CreateItem(itemType.getID(), stackCount);
-					if (CylinderPtr inbox = player->getInbox(); g_game.internalAddItem(inbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						break;
-					}
-
-					tmpAmount -= stackCount;
+		if (itemType.stackable) {
+			uint16_t tmpAmount = amount;
+			while (tmpAmount > 0) {
+				uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
+				auto item = Item::CreateItem(itemType.getID(), stackCount);
+				if (CylinderPtr inbox = player->getInbox(); g_game.internalAddItem(inbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					break;
 				}
+
+				tmpAmount -= stackCount;
+			}
+		} else {
+			int32_t subType;
+			if (itemType.charges != 0) {
+				subType = itemType.charges;
 			} else {
-				int32_t subType;
-				if (itemType.charges != 0) {
-					subType = itemType.charges;
-				} else {
-					subType = -1;
-				}
+				subType = -1;
+			}
 
-				for (uint16_t i = 0; i < amount; ++i) {
-					auto item = Item::CreateItem(itemType.getID(), subType);
-					if (CylinderPtr inbox = player->getInbox(); g_game.internalAddItem(inbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						break;
-					}
+			for (uint16_t i = 0; i < amount; ++i) {
+				auto item = Item::CreateItem(itemType.getID(), subType);
+				if (CylinderPtr inbox = player->getInbox(); g_game.internalAddItem(inbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					break;
 				}
 			}
+		}
 
-			if (player->isOffline()) {
-				IOLoginData::savePlayer(player);
-			}
-		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+		if (offline) {
+			IOLoginData::savePlayerLater(player);
+		}
+	} else {
+		uint64_t totalPrice = static_cast<uint64_t>(offer.price) * amount;
 
-			if (const auto player = g_game.getPlayerByGUID(playerId)) {
-				player->setBankBalance(player->getBankBalance() + totalPrice);
-			} else {
-				IOLoginData::increaseBankBalance(playerId, totalPrice);
-			}
+		if (const auto player = g_game.getPlayerByGUID(playerId)) {
+			player->setBankBalance(player->getBankBalance() + totalPrice);
+		} else {
+			IOLoginData::increaseBankBalance(playerId, totalPrice);
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers()
 {
 	const time_t lastExpireDate = time(nullptr) - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(fmt::format("SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}", lastExpireDate), IOMarket::processExpiredOffers, true);
+	std::vector<Offer> expired;
+	for (const auto& [id, offer] : getInstance().offers) {
+		if (offer.created <= lastExpireDate) {
+			expired.push_back(offer);
+		}
+	}
+
+	for (const Offer& offer : expired) {
+		if (moveOfferToHistory(offer.id, OFFERSTATE_EXPIRED)) {
+			returnExpiredOffer(offer);
+		}
+	}
 
 	int32_t checkExpiredMarketOffersEachMinutes = g_config.getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -180,59 +224,85 @@ void IOMarket::checkExpiredOffers()
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 {
 	MarketOfferEx offer;
 
-	const int32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1", created, counter));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.counters.find(counterKey(created, counter));
+	if (it == market.counters.end()) {
 		offer.id = 0;
 		offer.playerId = 0;
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint32_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
-	} else {
-		offer.playerName = "Anonymous";
-	}
+	const Offer& entry = market.offers.at(it->second);
+	offer.id = entry.id;
+	offer.type = entry.type;
+	offer.amount = entry.amount;
+	offer.counter = entry.id & 0xFFFF;
+	offer.timestamp = entry.created;
+	offer.price = entry.price;
+	offer.itemId = entry.itemId;
+	offer.playerId = entry.playerId;
+	offer.playerName = entry.anonymous ? "Anonymous" : entry.playerName;
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous)
+void IOMarket::createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous)
 {
-	Database::getInstance().executeQuery(fmt::format("INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, Titan::to_underlying(action), itemId, amount, price, time(nullptr), anonymous));
+	IOMarket& market = getInstance();
+
+	// ids are handed out here so the offer can be browsed before it reaches the database
+	Offer offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.type = action;
+	offer.itemId = static_cast<uint16_t>(itemId);
+	offer.amount = amount;
+	offer.price = price;
+	offer.created = static_cast<uint32_t>(time(nullptr));
+	offer.anonymous = anonymous;
+	offer.playerName = playerName;
+
+	const uint32_t offerId = offer.id;
+	market.addOffer(std::move(offer));
+	market.markDirty(offerId);
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	it->second.amount -= std::min(amount, it->second.amount);
+	market.markDirty(offerId);
 }
 
 void IOMarket::deleteOffer(uint32_t offerId)
 {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	getInstance().removeOffer(offerId);
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state)
 {
+	if (state == OFFERSTATE_ACCEPTED) {
+		getInstance().addStatistics(action, itemId, price);
+	}
+
 	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, Titan::to_underlying(action), itemId, amount, price, timestamp, time(nullptr), Titan::to_underlying(state)));
 }
 
@@ -240,19 +310,133 @@ bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 {
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}", offerId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
+	const Offer& offer = it->second;
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price, offer.created + marketOfferDuration, state);
+	market.removeOffer(offerId);
+	return true;
+}
+
+void IOMarket::addOffer(Offer&& offer)
+{
+	const uint32_t offerId = offer.id;
+	books[bookKey(offer.itemId, offer.type)].emplace(offer.price, offerId);
+	playerOffers[offer.playerId].insert(offerId);
+	counters[counterKey(offer.created, offerId & 0xFFFF)] = offerId;
+	offers.emplace(offerId, std::move(offer));
+}
+
+void IOMarket::removeOffer(uint32_t offerId)
+{
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return;
 	}
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint32_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
-	return true;
+	const Offer& offer = it->second;
+	if (auto book = books.find(bookKey(offer.itemId, offer.type)); book != books.end()) {
+		book->second.erase({offer.price, offerId});
+		if (book->second.empty()) {
+			books.erase(book);
+		}
+	}
+
+	if (auto own = playerOffers.find(offer.playerId); own != playerOffers.end()) {
+		own->second.erase(offerId);
+		if (own->second.empty()) {
+			playerOffers.erase(own);
+		}
+	}
+
+	if (auto counter = counters.find(counterKey(offer.created, offerId & 0xFFFF)); counter != counters.end() && counter->second == offerId) {
+		counters.erase(counter);
+	}
+
+	offers.erase(it);
+
+	dirtyOffers.erase(offerId);
+	deletedOffers.push_back(offerId);
+	scheduleFlush();
+}
+
+void IOMarket::markDirty(uint32_t offerId)
+{
+	dirtyOffers.insert(offerId);
+	scheduleFlush();
+}
+
+void IOMarket::scheduleFlush()
+{
+	if (!flushScheduled) {
+		flushScheduled = true;
+		g_scheduler.addEvent(createSchedulerTask(MARKET_FLUSH_DELAY, []() { IOMarket::getInstance().flush(); }));
+	}
+}
+
+void IOMarket::flush()
+{
+	flushScheduled = false;
+
+	// live offers are upserted with their current amount, whatever happened to them since the last flush
+	std::string values;
+	size_t rows = 0;
+	auto flushValues = [&values, &rows]() {
+		if (rows == 0) {
+			return;
+		}
+
+		g_databaseTasks.addTask("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES " + values + " ON DUPLICATE KEY UPDATE `amount` = VALUES(`amount`)");
+		values.clear();
+		rows = 0;
+	};
+
+	for (const uint32_t offerId : dirtyOffers) {
+		auto it = offers.find(offerId);
+		if (it == offers.end()) {
+			continue;
+		}
+
+		const Offer& offer = it->second;
+		if (rows != 0) {
+			values.push_back(',');
+		}
+		values += fmt::format("({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", offer.id, offer.playerId, Titan::to_underlying(offer.type), offer.itemId, offer.amount, offer.price, offer.created, offer.anonymous);
+		if (++rows == MARKET_FLUSH_BATCH) {
+			flushValues();
+		}
+	}
+	flushValues();
+	dirtyOffers.clear();
+
+	for (size_t first = 0; first < deletedOffers.size(); first += MARKET_FLUSH_BATCH) {
+		const size_t last = std::min(first + MARKET_FLUSH_BATCH, deletedOffers.size());
+
+		std::string ids;
+		for (size_t i = first; i < last; ++i) {
+			if (i != first) {
+				ids.push_back(',');
+			}
+			ids += std::to_string(deletedOffers[i]);
+		}
+		g_databaseTasks.addTask("DELETE FROM `market_offers` WHERE `id` IN (" + ids + ")");
+	}
+	deletedOffers.clear();
+}
+
+void IOMarket::addStatistics(MarketAction_t action, uint16_t itemId, uint32_t price)
+{
+	MarketStatistics& statistics = action == MARKETACTION_BUY ? purchaseStatistics[itemId] : saleStatistics[itemId];
+	if (statistics.numTransactions == 0 || price < statistics.lowestPrice) {
+		statistics.lowestPrice = price;
+	}
+	statistics.highestPrice = std::max(statistics.highestPrice, price);
+	statistics.totalPrice += price;
+	++statistics.numTransactions;
 }
 
 void IOMarket::updateStatistics()
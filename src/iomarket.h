@@ -7,6 +7,14 @@
 #include "enums.h"
 #include "database.h"
 
+#include <gtl/phmap.hpp>
+#include <set>
+
+/**
+  * The active order book is held in memory, loaded once at startup. Browsing
+  * never touches the database; mutations are applied in memory and written
+  * behind in batches (see IOMarket::flush).
+  */
 class IOMarket
 {
 	public:
@@ -15,23 +23,30 @@ class IOMarket
 			return instance;
 		}
 
+		static bool loadOffers();
+
 		static MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId);
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(const DBResult_ptr& result, bool);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
 		static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-		static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
+		static void createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
 		static void acceptOffer(uint32_t offerId, uint16_t amount);
 		static void deleteOffer(uint32_t offerId);
 
 		static void appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state);
 		static bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state);
 
+		/**
+		  * Queues the pending order book changes to the database thread.
+		  * Runs on a timer after the first change and from Game::saveGameState.
+		  */
+		void flush();
+
 		void updateStatistics();
 
 		MarketStatistics* getPurchaseStatistics(uint16_t itemId);
@@ -40,6 +55,48 @@ class IOMarket
 	private:
 		IOMarket() = default;
 
+		struct Offer {
+			uint32_t id;
+			uint32_t playerId;
+			uint32_t price;
+			uint32_t created;
+			uint16_t itemId;
+			uint16_t amount;
+			MarketAction_t type;
+			bool anonymous;
+			std::string playerName;
+		};
+
+		// offers of one item and side, ordered by price
+		using OfferBook = std::set<std::pair<uint32_t, uint32_t>>;
+
+		static constexpr uint32_t bookKey(uint16_t itemId, MarketAction_t action) {
+			return (static_cast<uint32_t>(itemId) << 1) | action;
+		}
+
+		static constexpr uint64_t counterKey(uint32_t created, uint16_t counter) {
+			return (static_cast<uint64_t>(created) << 16) | counter;
+		}
+
+		static void returnExpiredOffer(const Offer& offer);
+
+		void addOffer(Offer&& offer);
+		void removeOffer(uint32_t offerId);
+		void markDirty(uint32_t offerId);
+		void scheduleFlush();
+		void addStatistics(MarketAction_t action, uint16_t itemId, uint32_t price);
+
+		gtl::node_hash_map<uint32_t, Offer> offers;
+		gtl::flat_hash_map<uint32_t, OfferBook> books;
+		gtl::flat_hash_map<uint32_t, gtl::flat_hash_set<uint32_t>> playerOffers;
+		gtl::flat_hash_map<uint64_t, uint32_t> counters;
+		uint32_t nextOfferId = 1;
+
+		// write-behind state, offers to insert or update and offers to delete
+		gtl::flat_hash_set<uint32_t> dirtyOffers;
+		std::vector<uint32_t> deletedOffers;
+		bool flushScheduled = false;
+
 		std::map<uint16_t, MarketStatistics> purchaseStatistics;
 		std::map<uint16_t, MarketStatistics> saleStatistics;
 };
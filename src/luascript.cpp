@@ -20,6 +20,7 @@
 #include "databasemanager.h"
 #include "bed.h"
 #include "monster.h"
+#include "profiler.h"
 #include "scheduler.h"
 #include "databasetasks.h"
 #include "events.h"
@@ -280,6 +281,7 @@ bool LuaScriptInterface::reInitState()
 /// Same as lua_pcall, but adds stack trace to error strings in called function.
 int LuaScriptInterface::protectedCall(lua_State* L, int nargs, int nresults)
 {
+	ProfileScope profile(Subsystem::Scripts);
 	int error_index = lua_gettop(L) - nargs;
 	lua_pushcfunction(L, luaErrorHandler);
 	lua_insert(L, error_index);
@@ -1017,6 +1019,71 @@ void LuaScriptInterface::pushLoot(lua_State* L, const std::vector<LootBlock>& lo
 	}
 }
 
+void LuaScriptInterface::pushResultRows(lua_State* L, const DBResult_ptr& result, uint32_t limit)
+{
+	if (!result) {
+		lua_newtable(L);
+		return;
+	}
+
+	const int columns = static_cast<int>(result->getColumnCount());
+	uint64_t rows = result->getRowCount();
+	if (limit != 0) {
+		rows = std::min<uint64_t>(rows, limit);
+	}
+
+	// the column names are pushed once and reused as the keys of every row
+	luaL_checkstack(L, columns + 3, "too many result columns");
+	const int names = lua_gettop(L) + 1;
+	for (int column = 0; column < columns; ++column) {
+		pushString(L, result->getColumnName(column));
+	}
+
+	lua_createtable(L, static_cast<int>(rows), 0);
+
+	int index = 0;
+	do {
+		lua_createtable(L, 0, columns);
+		for (int column = 0; column < columns; ++column) {
+			// NULL cells are left out, they read as nil
+			if (result->isNull(column)) {
+				continue;
+			}
+
+			lua_pushvalue(L, names + column);
+			switch (result->getColumnKind(column)) {
+				case DBResult::ColumnKind::Integer:
+					lua_pushinteger(L, result->getNumber<int64_t>(column));
+					break;
+
+				case DBResult::ColumnKind::UnsignedBigInt: {
+					// values past int64_t keep all their digits as a string
+					const auto value = result->getNumber<uint64_t>(column);
+					if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+						pushString(L, result->getString(column));
+					} else {
+						lua_pushinteger(L, static_cast<int64_t>(value));
+					}
+					break;
+				}
+
+				case DBResult::ColumnKind::Decimal:
+					lua_pushnumber(L, result->getNumber<double>(column));
+					break;
+
+				default:
+					pushString(L, result->getString(column));
+					break;
+			}
+			lua_rawset(L, -3);
+		}
+		lua_rawseti(L, -2, ++index);
+	} while (static_cast<uint64_t>(index) < rows && result->next());
+
+	lua_insert(L, names);
+	lua_pop(L, columns);
+}
+
 #define registerEnum(value) { std::string enumName = #value; registerGlobalVariable(enumName.substr(enumName.find_last_of(':') + 1), value); }
 #define registerEnumIn(tableName, value) { std::string enumName = #value; registerVariable(tableName, enumName.substr(enumName.find_last_of(':') + 1), value); }
 
@@ -1941,6 +2008,7 @@ void LuaScriptInterface::registerFunctions()
 	registerEnum(RELOAD_TYPE_ALL)
 	registerEnum(RELOAD_TYPE_ACTIONS)
 	registerEnum(RELOAD_TYPE_AUGMENTS)
+	registerEnum(RELOAD_TYPE_BANS)
 	registerEnum(RELOAD_TYPE_CHAT)
 	registerEnum(RELOAD_TYPE_CONFIG)
 	registerEnum(RELOAD_TYPE_CREATURESCRIPTS)
@@ -1976,6 +2044,14 @@ void LuaScriptInterface::registerFunctions()
 	registerEnum(MONSTERS_EVENT_MOVE)
 	registerEnum(MONSTERS_EVENT_SAY)
 
+	// Use with monsterType:friendFactions, monsterType:opponentFactions
+	registerEnum(FACTION_NONE)
+	registerEnum(FACTION_PLAYER)
+	registerEnum(FACTION_PLAYER_SUMMON)
+	registerEnum(FACTION_WILD)
+	registerEnum(FACTION_MONSTER_SUMMON)
+	registerEnum(FACTION_NPC)
+
 	registerEnum(DECAYING_FALSE)
 	registerEnum(DECAYING_TRUE)
 	registerEnum(DECAYING_PENDING)
@@ -2227,9 +2303,12 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Game", "startRaid", luaGameStartRaid);
 
 	registerMethod("Game", "getClientVersion", luaGameGetClientVersion);
+	registerMethod("Game", "getPacketCompressionStats", luaGameGetPacketCompressionStats);
 
 	registerMethod("Game", "reload", luaGameReload);
 
+	registerMethod("Game", "releaseOfflinePlayer", luaGameReleaseOfflinePlayer);
+
 	registerMethod("Game", "getAccountStorageValue", luaGameGetAccountStorageValue);
 	registerMethod("Game", "setAccountStorageValue", luaGameSetAccountStorageValue);
 	registerMethod("Game", "saveAccountStorageValues", luaGameSaveAccountStorageValues);
@@ -2850,6 +2929,7 @@ void LuaScriptInterface::registerFunctions()
 
 	registerMethod("Player", "getIdleTime", luaPlayerGetIdleTime);
 	registerMethod("Player", "resetIdleTime", luaPlayerResetIdleTime);
+	registerMethod("Player", "getClientUpdates", luaPlayerGetClientUpdates);
 
 	registerMethod("Player", "sendCreatureSquare", luaPlayerSendCreatureSquare);
 	registerMethod("Player", "getEquipment", luaPlayerGetEquipment);
@@ -2927,6 +3007,8 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Guild", "getMotd", luaGuildGetMotd);
 	registerMethod("Guild", "setMotd", luaGuildSetMotd);
 
+	registerMethod("Guild", "addWarKill", luaGuildAddWarKill);
+
 	// Group
 	registerClass("Group", "", luaGroupCreate);
 	registerMetaMethod("Group", "__eq", luaUserdataCompare);
@@ -3222,6 +3304,8 @@ void LuaScriptInterface::registerFunctions()
 
 	registerMethod("MonsterType", "staticAttackChance", luaMonsterTypeStaticAttackChance);
 	registerMethod("MonsterType", "targetDistance", luaMonsterTypeTargetDistance);
+	registerMethod("MonsterType", "friendFactions", luaMonsterTypeFriendFactions);
+	registerMethod("MonsterType", "opponentFactions", luaMonsterTypeOpponentFactions);
 	registerMethod("MonsterType", "yellChance", luaMonsterTypeYellChance);
 	registerMethod("MonsterType", "yellSpeedTicks", luaMonsterTypeYellSpeedTicks);
 	registerMethod("MonsterType", "changeTargetChance", luaMonsterTypeChangeTargetChance);
@@ -4310,6 +4394,8 @@ const luaL_Reg LuaScriptInterface::luaDatabaseTable[] = {
 	{"asyncQuery", LuaScriptInterface::luaDatabaseAsyncExecute},
 	{"storeQuery", LuaScriptInterface::luaDatabaseStoreQuery},
 	{"asyncStoreQuery", LuaScriptInterface::luaDatabaseAsyncStoreQuery},
+	{"storeQueryRows", LuaScriptInterface::luaDatabaseStoreQueryRows},
+	{"asyncStoreQueryRows", LuaScriptInterface::luaDatabaseAsyncStoreQueryRows},
 	{"escapeString", LuaScriptInterface::luaDatabaseEscapeString},
 	{"escapeBlob", LuaScriptInterface::luaDatabaseEscapeBlob},
 	{"lastInsertId", LuaScriptInterface::luaDatabaseLastInsertId},
@@ -4397,6 +4483,72 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 	return 0;
 }
 
+int LuaScriptInterface::luaDatabaseStoreQueryRows(lua_State* L)
+{
+	// db.storeQueryRows(query[, limit])
+	DBResult_ptr result = Database::getInstance().storeQuery(getString(L, 1));
+	pushResultRows(L, result, getNumber<uint32_t>(L, 2, 0));
+	return 1;
+}
+
+int LuaScriptInterface::luaDatabaseAsyncStoreQueryRows(lua_State* L)
+{
+	// db.asyncStoreQueryRows(query[, limit])
+	// yields the calling coroutine and resumes it with the rows once the
+	// query has run on the database thread
+#if LUA_VERSION_NUM >= 503
+	const bool yieldable = lua_isyieldable(L) != 0;
+#else
+	const bool yieldable = true;
+#endif
+	if (lua_pushthread(L) != 0 || !yieldable) {
+		reportErrorFunc(L, "db.asyncStoreQueryRows must be called from a coroutine");
+		lua_pop(L, 1);
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	const uint32_t limit = getNumber<uint32_t>(L, 2, 0);
+	auto scriptId = getScriptEnv()->getScriptId();
+	auto callback = [ref, limit, scriptId](const DBResult_ptr& result, bool) {
+		lua_State* luaState = g_luaEnvironment.getLuaState();
+		if (!luaState) {
+			return;
+		}
+
+		lua_rawgeti(luaState, LUA_REGISTRYINDEX, ref);
+		lua_State* thread = lua_tothread(luaState, -1);
+		lua_pop(luaState, 1);
+
+		if (!LuaScriptInterface::reserveScriptEnv()) {
+			luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
+			return;
+		}
+
+		auto env = getScriptEnv();
+		env->setScriptId(scriptId, &g_luaEnvironment);
+
+		pushResultRows(thread, result, limit);
+#if LUA_VERSION_NUM >= 504
+		int results;
+		const int status = lua_resume(thread, luaState, 1, &results);
+#elif LUA_VERSION_NUM >= 502
+		const int status = lua_resume(thread, luaState, 1);
+#else
+		const int status = lua_resume(thread, 1);
+#endif
+		if (status != 0 && status != LUA_YIELD) {
+			LuaScriptInterface::reportError(nullptr, LuaScriptInterface::getString(thread, -1), thread, true);
+		}
+
+		resetScriptEnv();
+		luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
+	};
+	g_databaseTasks.addTask(getString(L, 1), callback, true);
+	return lua_yield(L, 0);
+}
+
 int LuaScriptInterface::luaDatabaseEscapeString(lua_State* L)
 {
 	pushString(L, Database::getInstance().escapeString(getString(L, -1)));
@@ -5178,6 +5330,18 @@ int LuaScriptInterface::luaGameGetClientVersion(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetPacketCompressionStats(lua_State* L)
+{
+	// Game.getPacketCompressionStats()
+	const PacketCompressionStats stats = Protocol::getCompressionStats();
+	lua_createtable(L, 0, 4);
+	setField(L, "packets", stats.packets);
+	setField(L, "bytesIn", stats.bytesIn);
+	setField(L, "bytesOut", stats.bytesOut);
+	setField(L, "microseconds", stats.microseconds);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameReload(lua_State* L)
 {
 	// Game.reload(reloadType)
@@ -5193,6 +5357,14 @@ int LuaScriptInterface::luaGameReload(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameReleaseOfflinePlayer(lua_State* L)
+{
+	// Game.releaseOfflinePlayer(guid)
+	// writes and drops the cached offline player, call it before changing its rows directly
+	IOLoginData::releaseOfflinePlayer(getNumber<uint32_t>(L, 1));
+	return 0;
+}
+
 int LuaScriptInterface::luaGameGetAccountStorageValue(lua_State* L)
 {
 	// Game.getAccountStorageValue(accountId, key)
@@ -13590,6 +13762,23 @@ int LuaScriptInterface::luaPlayerGetIdleTime(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaPlayerGetClientUpdates(lua_State* L)
+{
+	// player:getClientUpdates()
+	const auto player = getSharedPtr<const Player>(L, 1);
+	if (!player) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const auto& counters = player->getClientUpdateCounters();
+	lua_createtable(L, 0, 3);
+	setField(L, "queued", counters.queued);
+	setField(L, "sent", counters.sent);
+	setField(L, "unchanged", counters.unchanged);
+	return 1;
+}
+
 int LuaScriptInterface::luaPlayerResetIdleTime(lua_State* L)
 {
 	// player:resetIdleTime()
@@ -14269,7 +14458,7 @@ int LuaScriptInterface::luaGuildCreate(lua_State* L)
 	// Guild(id)
 	const uint32_t id = getNumber<uint32_t>(L, 2);
 
-	if (const auto guild = g_game.getGuild(id)) {
+	if (const auto guild = IOGuild::getGuild(id)) {
 		pushSharedPtr(L, guild);
 		setMetatable(L, -1, "Guild");
 	} else {
@@ -14395,6 +14584,7 @@ int LuaScriptInterface::luaGuildSetMotd(lua_State* L)
 	const std::string& motd = getString(L, 2);
 	if (const auto guild = getUserdata<Guild>(L, 1)) {
 		guild->setMotd(motd);
+		IOGuild::saveMotd(guild->getId(), motd);
 		pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -14402,6 +14592,20 @@ int LuaScriptInterface::luaGuildSetMotd(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGuildAddWarKill(lua_State* L)
+{
+	// guild:addWarKill(enemyGuildId, killerName, targetName)
+	const auto guild = getSharedPtr<Guild>(L, 1);
+	if (!guild) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const uint32_t enemyGuildId = getNumber<uint32_t>(L, 2);
+	pushBoolean(L, IOGuild::addWarKill(guild, enemyGuildId, getString(L, 3), getString(L, 4)));
+	return 1;
+}
+
 // Group
 int LuaScriptInterface::luaGroupCreate(lua_State* L)
 {
@@ -17593,6 +17797,46 @@ int LuaScriptInterface::luaMonsterTypeTargetDistance(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaMonsterTypeFriendFactions(lua_State* L)
+{
+	// get: monsterType:friendFactions() set: monsterType:friendFactions("wild;monstersummon")
+	MonsterType* monsterType = getUserdata<MonsterType>(L, 1);
+	if (monsterType) {
+		if (lua_gettop(L) == 1) {
+			lua_pushinteger(L, monsterType->info.friendFactions);
+		} else if (const auto mask = parseFactionMask(getString(L, 2))) {
+			monsterType->info.friendFactions = *mask;
+			pushBoolean(L, true);
+		} else {
+			std::cout << "[Warning - MonsterType:friendFactions] Unknown friend factions " << getString(L, 2) << " for monster: " << monsterType->name << std::endl;
+			lua_pushnil(L);
+		}
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaMonsterTypeOpponentFactions(lua_State* L)
+{
+	// get: monsterType:opponentFactions() set: monsterType:opponentFactions("player;playersummon")
+	MonsterType* monsterType = getUserdata<MonsterType>(L, 1);
+	if (monsterType) {
+		if (lua_gettop(L) == 1) {
+			lua_pushinteger(L, monsterType->info.opponentFactions);
+		} else if (const auto mask = parseFactionMask(getString(L, 2))) {
+			monsterType->info.opponentFactions = *mask;
+			pushBoolean(L, true);
+		} else {
+			std::cout << "[Warning - MonsterType:opponentFactions] Unknown opponent factions " << getString(L, 2) << " for monster: " << monsterType->name << std::endl;
+			lua_pushnil(L);
+		}
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
 int LuaScriptInterface::luaMonsterTypeYellChance(lua_State* L)
 {
 	// get: monsterType:yellChance() set: monsterType:yellChance(chance)
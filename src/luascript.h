@@ -430,6 +430,7 @@ class LuaScriptInterface
 		static void pushOutfit(lua_State* L, const Outfit* outfit);
 		static void pushMount(lua_State* L, const Mount* mount);
 		static void pushLoot(lua_State* L, const std::vector<LootBlock>& lootList);
+		static void pushResultRows(lua_State* L, const DBResult_ptr& result, uint32_t limit);
 
 		static void pushDamageModifier(lua_State *L, const std::shared_ptr<DamageModifier> &modifier);
 
@@ -463,7 +464,7 @@ class LuaScriptInterface
 		static const luaL_Reg luaBitReg[7];
 #endif
 		static const luaL_Reg luaConfigManagerTable[4];
-		static const luaL_Reg luaDatabaseTable[9];
+		static const luaL_Reg luaDatabaseTable[11];
 		static const luaL_Reg luaResultTable[6];
 
 		static int protectedCall(lua_State* L, int nargs, int nresults);
@@ -557,6 +558,8 @@ class LuaScriptInterface
 		static int luaDatabaseAsyncExecute(lua_State* L);
 		static int luaDatabaseStoreQuery(lua_State* L);
 		static int luaDatabaseAsyncStoreQuery(lua_State* L);
+		static int luaDatabaseStoreQueryRows(lua_State* L);
+		static int luaDatabaseAsyncStoreQueryRows(lua_State* L);
 		static int luaDatabaseEscapeString(lua_State* L);
 		static int luaDatabaseEscapeBlob(lua_State* L);
 		static int luaDatabaseLastInsertId(lua_State* L);
@@ -634,9 +637,12 @@ class LuaScriptInterface
 		static int luaGameStartRaid(lua_State* L);
 
 		static int luaGameGetClientVersion(lua_State* L);
+		static int luaGameGetPacketCompressionStats(lua_State* L);
 
 		static int luaGameReload(lua_State* L);
 
+		static int luaGameReleaseOfflinePlayer(lua_State* L);
+
 		static int luaGameGetAccountStorageValue(lua_State* L);
 		static int luaGameSetAccountStorageValue(lua_State* L);
 		static int luaGameSaveAccountStorageValues(lua_State* L);
@@ -1239,6 +1245,7 @@ class LuaScriptInterface
 
 		static int luaPlayerGetIdleTime(lua_State* L);
 		static int luaPlayerResetIdleTime(lua_State* L);
+		static int luaPlayerGetClientUpdates(lua_State* L);
 
 		static int luaPlayerSendCreatureSquare(lua_State* L);
 		static int luaPlayerGetEquipment(lua_State* L);
@@ -1313,6 +1320,8 @@ class LuaScriptInterface
 		static int luaGuildGetMotd(lua_State* L);
 		static int luaGuildSetMotd(lua_State* L);
 
+		static int luaGuildAddWarKill(lua_State* L);
+
 		// Group
 		static int luaGroupCreate(lua_State* L);
 
@@ -1592,6 +1601,8 @@ class LuaScriptInterface
 
 		static int luaMonsterTypeStaticAttackChance(lua_State* L);
 		static int luaMonsterTypeTargetDistance(lua_State* L);
+		static int luaMonsterTypeFriendFactions(lua_State* L);
+		static int luaMonsterTypeOpponentFactions(lua_State* L);
 		static int luaMonsterTypeYellChance(lua_State* L);
 		static int luaMonsterTypeYellSpeedTicks(lua_State* L);
 		static int luaMonsterTypeChangeTargetChance(lua_State* L);
@@ -93,8 +93,8 @@ bool Mailbox::sendItem(const ItemPtr& item) const
 			return true;
 		}
 	} else {
-		PlayerPtr tmpPlayer = std::make_shared<Player>(nullptr);
-		if (!IOLoginData::loadPlayerByName(tmpPlayer, receiver)) {
+		const auto tmpPlayer = IOLoginData::getOfflinePlayerByName(receiver);
+		if (!tmpPlayer) {
 			return false;
 		}
 		CylinderPtr newParent = CylinderPtr(item->getParent());
@@ -102,7 +102,7 @@ bool Mailbox::sendItem(const ItemPtr& item) const
 		if (g_game.internalMoveItem(newParent, inbox, INDEX_WHEREEVER,
 		                            item, item->getItemCount(), std::nullopt, FLAG_NOLIMIT) == RETURNVALUE_NOERROR) {
 			g_game.transformItem(item, item->getID() + 1);
-			IOLoginData::savePlayer(tmpPlayer);
+			IOLoginData::savePlayerLater(tmpPlayer);
 			return true;
 		}
 	}
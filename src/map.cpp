@@ -9,6 +9,7 @@
 #include "creature.h"
 #include "game.h"
 #include "monster.h"
+#include "profiler.h"
 
 extern Game g_game;
 
@@ -69,12 +70,12 @@ TilePtr Map::getTile(const uint16_t x, const uint16_t y, const uint8_t z)
 		return nullptr;
 	}
 
-	auto leaf = QTreeNode::getLeafStatic< QTreeLeafNode*, QTreeNode*>(&root, x, y);
-	if (!leaf) {
+	const auto sector = sectors.getSector(x, y);
+	if (!sector) {
 		return nullptr;
 	}
 
-	auto floor = leaf->getFloor(z);
+	const auto floor = sector->getFloor(z);
 	if (!floor) {
 		return nullptr;
 	}
@@ -88,32 +89,7 @@ void Map::setTile(const uint16_t x, const uint16_t y, const uint8_t z, TilePtr&
 		return;
 	}
 
-	QTreeLeafNode::newLeaf = false;
-	const auto& leaf = root.createLeaf(x, y, 15);
-
-	if (QTreeLeafNode::newLeaf) {
-		//update north
-		if (const auto& northLeaf = root.getLeaf(x, y - FLOOR_SIZE)) {
-			northLeaf->leafS = leaf;
-		}
-
-		//update west leaf
-		if (const auto& westLeaf = root.getLeaf(x - FLOOR_SIZE, y)) {
-			westLeaf->leafE = leaf;
-		}
-
-		//update south
-		if (const auto& southLeaf = root.getLeaf(x, y + FLOOR_SIZE)) {
-			leaf->leafS = southLeaf;
-		}
-
-		//update east
-		if (const auto& eastLeaf = root.getLeaf(x + FLOOR_SIZE, y)) {
-			leaf->leafE = eastLeaf;
-		}
-	}
-
-	const auto& floor = leaf->createFloor(z);
+	const auto& floor = sectors.createSector(x, y)->createFloor(z);
 	const uint32_t offsetX = x & FLOOR_MASK;
 	const uint32_t offsetY = y & FLOOR_MASK;
 
@@ -132,6 +108,124 @@ void Map::setTile(const uint16_t x, const uint16_t y, const uint8_t z, TilePtr&
 	} else {
 		tile = newTile;
 	}
+
+	refreshTileLayers(floor->tiles[offsetX][offsetY].get());
+}
+
+const Floor* Map::getFloor(const uint16_t x, const uint16_t y, const uint8_t z) const
+{
+	if (z >= MAP_MAX_LAYERS) {
+		return nullptr;
+	}
+
+	const auto sector = sectors.getSector(x, y);
+	if (!sector) {
+		return nullptr;
+	}
+	return sector->getFloor(z);
+}
+
+namespace {
+
+// Moves one floor row (8 tiles) into a rectangle row whose first tile lies
+// `shift` tiles west of the floor.
+uint32_t blitFloorRow(const uint8_t bits, const int32_t shift, const uint32_t widthMask)
+{
+	const uint32_t row = shift >= 0 ? (static_cast<uint32_t>(bits) << shift) : (static_cast<uint32_t>(bits) >> -shift);
+	return row & widthMask;
+}
+
+}
+
+void Map::refreshTileLayers(const Tile* tile)
+{
+	const Position& pos = tile->getPosition();
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	const auto sector = sectors.getSector(pos.x, pos.y);
+	if (!sector) {
+		return;
+	}
+
+	const auto& floor = sector->getFloor(pos.z);
+	// tiles still being loaded are refreshed once they are placed by setTile
+	if (!floor || floor->tiles[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK].get() != tile) {
+		return;
+	}
+
+	const uint64_t bit = Floor::bit(pos.x, pos.y);
+	const uint32_t flags = tile->getFlags();
+
+	const bool walkBlock = !tile->getGround() || hasBitSet(TILESTATE_BLOCKSOLID, flags);
+	const bool pathBlock = walkBlock || hasBitSet(TILESTATE_FLOORCHANGE, flags) || hasBitSet(TILESTATE_TELEPORT, flags);
+	const bool dynamicState = tile->getHouse() || hasBitSet(TILESTATE_PROTECTIONZONE | TILESTATE_NOPVPZONE | TILESTATE_PVPZONE | TILESTATE_NOLOGOUT |
+	                                                        TILESTATE_MAGICFIELD | TILESTATE_NOFIELDBLOCKPATH | TILESTATE_IMMOVABLENOFIELDBLOCKPATH, flags);
+
+	floor->walkBlock = walkBlock ? (floor->walkBlock | bit) : (floor->walkBlock & ~bit);
+	floor->pathBlock = pathBlock ? (floor->pathBlock | bit) : (floor->pathBlock & ~bit);
+	floor->dynamicState = dynamicState ? (floor->dynamicState | bit) : (floor->dynamicState & ~bit);
+	floor->projectileBlock = tile->hasProperty(CONST_PROP_BLOCKPROJECTILE) ? (floor->projectileBlock | bit) : (floor->projectileBlock & ~bit);
+	floor->groundLayer = tile->getGround() ? (floor->groundLayer | bit) : (floor->groundLayer & ~bit);
+}
+
+void Map::getWalkLayers(const int32_t x, const int32_t y, const uint8_t z, const int32_t width, const int32_t height,
+                        uint32_t* walkRows, uint32_t* checkRows) const
+{
+	assert(width > 0 && width <= 32);
+
+	std::fill_n(walkRows, height, 0);
+	std::fill_n(checkRows, height, 0);
+
+	if (z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	const int32_t minX = std::max<int32_t>(x, 0);
+	const int32_t minY = std::max<int32_t>(y, 0);
+	const int32_t maxX = std::min<int32_t>(x + width - 1, 0xFFFF);
+	const int32_t maxY = std::min<int32_t>(y + height - 1, 0xFFFF);
+	if (minX > maxX || minY > maxY) {
+		return;
+	}
+
+	const uint32_t widthMask = width == 32 ? 0xFFFFFFFF : ((1U << width) - 1);
+
+	for (int32_t sy = minY & ~FLOOR_MASK; sy <= maxY; sy += FLOOR_SIZE) {
+		for (int32_t sx = minX & ~FLOOR_MASK; sx <= maxX; sx += FLOOR_SIZE) {
+			const auto sector = sectors.getSector(sx, sy);
+			if (!sector) {
+				continue;
+			}
+
+			// each floor row is one byte, blit it into the rows of the rectangle
+			const int32_t shift = sx - x;
+			const int32_t firstRow = std::max<int32_t>(sy, minY);
+			const int32_t lastRow = std::min<int32_t>(sy + FLOOR_MASK, maxY);
+
+			const auto& floor = sector->getFloor(z);
+			if (!floor) {
+				continue;
+			}
+
+			for (int32_t ty = firstRow; ty <= lastRow; ++ty) {
+				walkRows[ty - y] |= blitFloorRow(~Floor::row(floor->pathBlock, ty), shift, widthMask);
+				checkRows[ty - y] |= blitFloorRow(Floor::row(floor->dynamicState, ty), shift, widthMask);
+			}
+
+			// creature occupancy is overlaid from the floor creature lists
+			for (const auto& list : floor->creatures) {
+				for (const auto& creature : list) {
+					const Position& cpos = creature->getPosition();
+					if (cpos.y < firstRow || cpos.y > lastRow || cpos.x < minX || cpos.x > maxX) {
+						continue;
+					}
+					checkRows[cpos.y - y] |= 1U << (cpos.x - x);
+				}
+			}
+		}
+	}
 }
 
 void Map::removeTile(const uint16_t x, const uint16_t y, const uint8_t z) const
@@ -140,12 +234,12 @@ void Map::removeTile(const uint16_t x, const uint16_t y, const uint8_t z) const
 		return;
 	}
 
-	const auto& leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
-	if (!leaf) {
+	const auto sector = sectors.getSector(x, y);
+	if (!sector) {
 		return;
 	}
 
-	const auto& floor = leaf->getFloor(z);
+	const auto& floor = sector->getFloor(z);
 	if (!floor) {
 		return;
 	}
@@ -174,6 +268,43 @@ void Map::removeTile(const uint16_t x, const uint16_t y, const uint8_t z) const
 	}
 }
 
+void Map::readFloorLayer(const int32_t x, const int32_t y, const uint8_t z, const int32_t width, const int32_t height,
+                         uint64_t Floor::* layer, uint32_t* rows) const
+{
+	assert(width > 0 && width <= 32);
+
+	std::fill_n(rows, height, 0);
+
+	if (z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	const int32_t minX = std::max<int32_t>(x, 0);
+	const int32_t minY = std::max<int32_t>(y, 0);
+	const int32_t maxX = std::min<int32_t>(x + width - 1, 0xFFFF);
+	const int32_t maxY = std::min<int32_t>(y + height - 1, 0xFFFF);
+	if (minX > maxX || minY > maxY) {
+		return;
+	}
+
+	const uint32_t widthMask = width == 32 ? 0xFFFFFFFF : ((1U << width) - 1);
+
+	for (int32_t sy = minY & ~FLOOR_MASK; sy <= maxY; sy += FLOOR_SIZE) {
+		for (int32_t sx = minX & ~FLOOR_MASK; sx <= maxX; sx += FLOOR_SIZE) {
+			const auto& floor = getFloor(sx, sy, z);
+			if (!floor) {
+				continue;
+			}
+
+			const int32_t firstRow = std::max<int32_t>(sy, minY);
+			const int32_t lastRow = std::min<int32_t>(sy + FLOOR_MASK, maxY);
+			for (int32_t ty = firstRow; ty <= lastRow; ++ty) {
+				rows[ty - y] |= blitFloorRow(Floor::row(floor->*layer, ty), sx - x, widthMask);
+			}
+		}
+	}
+}
+
 bool Map::placeCreature(const Position& centerPos, CreaturePtr creature, bool extendedPos/* = false*/, bool forceLogin/* = false*/)
 {
 	bool foundTile;
@@ -247,7 +378,7 @@ bool Map::placeCreature(const Position& centerPos, CreaturePtr creature, bool ex
 	toCylinder->internalAddThing(creature);
 
 	const Position& dest = toCylinder->getPosition();
-	getQTNode(dest.x, dest.y)->addCreature(creature);
+	sectors.getSector(dest.x, dest.y)->addCreature(creature, dest.z);
 	return true;
 }
 
@@ -282,13 +413,13 @@ void Map::moveCreature(CreaturePtr& creature, const TilePtr& newTile, bool force
 	//remove the creature
 	oldTile->removeThing(creature, 0);
 
-	const auto& leaf = getQTNode(oldPos.x, oldPos.y);
-	const auto& new_leaf = getQTNode(newPos.x, newPos.y);
+	const auto sector = sectors.getSector(oldPos.x, oldPos.y);
+	const auto newSector = sectors.getSector(newPos.x, newPos.y);
 
-	// Switch the node ownership
-	if (leaf != new_leaf) {
-		leaf->removeCreature(creature);
-		new_leaf->addCreature(creature);
+	// Switch the sector ownership
+	if (sector != newSector || oldPos.z != newPos.z) {
+		sector->removeCreature(creature, oldPos.z);
+		newSector->addCreature(creature, newPos.z);
 	}
 
 	//add the creature
@@ -330,64 +461,78 @@ void Map::moveCreature(CreaturePtr& creature, const TilePtr& newTile, bool force
 	newTile->postAddNotification(creature, oldTile, 0);
 }
 
+namespace {
+
+void getSpectatorFloors(const Position& centerPos, bool multifloor, int32_t& minRangeZ, int32_t& maxRangeZ)
+{
+    if (!multifloor) {
+        minRangeZ = centerPos.z;
+        maxRangeZ = centerPos.z;
+    } else if (centerPos.z > 7) {
+        //underground (8->15)
+        minRangeZ = std::max<int32_t>(centerPos.getZ() - 2, 0);
+        maxRangeZ = std::min<int32_t>(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
+    } else if (centerPos.z == 6) {
+        minRangeZ = 0;
+        maxRangeZ = 8;
+    } else if (centerPos.z == 7) {
+        minRangeZ = 0;
+        maxRangeZ = 9;
+    } else {
+        minRangeZ = 0;
+        maxRangeZ = 7;
+    }
+}
+
+}
+
 void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, const int32_t minRangeX, const int32_t maxRangeX, const int32_t minRangeY, const int32_t maxRangeY, const int32_t minRangeZ, const int32_t maxRangeZ, const bool onlyPlayers) const
 {
-    const auto min_y = centerPos.y + minRangeY;
-    const auto min_x = centerPos.x + minRangeX;
-    const auto max_y = centerPos.y + maxRangeY;
-    const auto max_x = centerPos.x + maxRangeX;
+    const int32_t lastList = onlyPlayers ? FLOOR_PLAYERS : FLOOR_CREATURE_LISTS - 1;
 
+    // the margins the whole z range adds to every floor, as the single floor scan always did
     const int32_t minoffset = centerPos.getZ() - maxRangeZ;
-    const uint16_t x1 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_x + minoffset)));
-    const uint16_t y1 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_y + minoffset)));
-
     const int32_t maxoffset = centerPos.getZ() - minRangeZ;
-    const uint16_t x2 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_x + maxoffset)));
-    const uint16_t y2 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_y + maxoffset)));
-
-    const std::array<int32_t, 4> cache_values{
-        min_y + minoffset,
-        max_y + maxoffset,
-        min_x + minoffset,
-        max_x + maxoffset
-    };
-
-    const int32_t startx1 = x1 - (x1 % FLOOR_SIZE);
-    const int32_t starty1 = y1 - (y1 % FLOOR_SIZE);
-    const int32_t endx2 = x2 - (x2 % FLOOR_SIZE);
-    const int32_t endy2 = y2 - (y2 % FLOOR_SIZE);
-
-    const auto& startLeaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, starty1);
-    auto leafS = startLeaf;
-
-    for (int_fast32_t ny = starty1; ny <= endy2; ny += FLOOR_SIZE) {
-        const QTreeLeafNode* leafE = leafS;
-        for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
-            if (leafE) {
-                const auto& node_list = (onlyPlayers ? leafE->player_list : leafE->creature_list);
-                std::ranges::for_each(node_list, [&](const CreaturePtr& creature) {
-                    const Position& cpos = creature->getPosition();
-                    if (minRangeZ > cpos.z || maxRangeZ < cpos.z) {
-                        return;
-                    }
 
-                    const int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
-                    if ((cache_values[0] + offsetZ) > cpos.y || (cache_values[1] + offsetZ) < cpos.y || (cache_values[2] + offsetZ) > cpos.x || (cache_values[3] + offsetZ) < cpos.x) {
-                        return;
-                    }
-
-                    spectators.emplace_back(creature);
-                });
-                leafE = leafE->leafE;
-            } else {
-                leafE = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, nx + FLOOR_SIZE, ny);
-            }
+    for (int32_t z = minRangeZ; z <= maxRangeZ; ++z) {
+        // the visible area shifts by one tile per floor of distance to the center
+        const int32_t offsetZ = centerPos.getZ() - z;
+        const int32_t min_x = centerPos.x + minRangeX + minoffset + offsetZ;
+        const int32_t max_x = centerPos.x + maxRangeX + maxoffset + offsetZ;
+        const int32_t min_y = centerPos.y + minRangeY + minoffset + offsetZ;
+        const int32_t max_y = centerPos.y + maxRangeY + maxoffset + offsetZ;
+
+        const int32_t x1 = std::max<int32_t>(0, min_x);
+        const int32_t y1 = std::max<int32_t>(0, min_y);
+        const int32_t x2 = std::min<int32_t>(0xFFFF, max_x);
+        const int32_t y2 = std::min<int32_t>(0xFFFF, max_y);
+        if (x1 > x2 || y1 > y2) {
+            continue;
         }
 
-        if (leafS) {
-            leafS = leafS->leafS;
-        } else {
-            leafS = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, ny + FLOOR_SIZE);
+        for (int32_t ny = y1 & ~FLOOR_MASK; ny <= y2; ny += FLOOR_SIZE) {
+            for (int32_t nx = x1 & ~FLOOR_MASK; nx <= x2; nx += FLOOR_SIZE) {
+                const auto sector = sectors.getSector(nx, ny);
+                if (!sector) {
+                    continue;
+                }
+
+                const auto floor = sector->getFloor(z);
+                if (!floor) {
+                    continue;
+                }
+
+                for (int32_t list = FLOOR_PLAYERS; list <= lastList; ++list) {
+                    for (const auto& creature : floor->creatures[list]) {
+                        const Position& cpos = creature->getPosition();
+                        if (min_y > cpos.y || max_y < cpos.y || min_x > cpos.x || max_x < cpos.x) {
+                            continue;
+                        }
+
+                        spectators.emplace_back(creature);
+                    }
+                }
+            }
         }
     }
 }
@@ -457,26 +602,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, con
     if (!foundCache) {
         int32_t minRangeZ;
         int32_t maxRangeZ;
-
-        if (multifloor) {
-            if (centerPos.z > 7) {
-                //underground (8->15)
-                minRangeZ = std::max<int32_t>(centerPos.getZ() - 2, 0);
-                maxRangeZ = std::min<int32_t>(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-            } else if (centerPos.z == 6) {
-                minRangeZ = 0;
-                maxRangeZ = 8;
-            } else if (centerPos.z == 7) {
-                minRangeZ = 0;
-                maxRangeZ = 9;
-            } else {
-                minRangeZ = 0;
-                maxRangeZ = 7;
-            }
-        } else {
-            minRangeZ = centerPos.z;
-            maxRangeZ = centerPos.z;
-        }
+        getSpectatorFloors(centerPos, multifloor, minRangeZ, maxRangeZ);
 
         getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
 
@@ -486,6 +612,21 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, con
     }
 }
 
+const SpectatorVec& Map::getSectorSpectators(const Position& pos)
+{
+	const uint64_t key = (static_cast<uint64_t>(pos.x >> FLOOR_BITS) << 24) | (static_cast<uint64_t>(pos.y >> FLOOR_BITS) << 8) | pos.z;
+	auto [it, inserted] = sectorSpectatorCache.try_emplace(key);
+	if (inserted && pos.z < MAP_MAX_LAYERS) {
+		// the viewport of the sector's corner tile, widened to reach past its far edges
+		const Position corner(static_cast<uint16_t>(pos.x & ~FLOOR_MASK), static_cast<uint16_t>(pos.y & ~FLOOR_MASK), pos.z);
+		int32_t minRangeZ;
+		int32_t maxRangeZ;
+		getSpectatorFloors(corner, true, minRangeZ, maxRangeZ);
+		getSpectatorsInternal(it->second, corner, -maxViewportX, maxViewportX + FLOOR_MASK, -maxViewportY, maxViewportY + FLOOR_MASK, minRangeZ, maxRangeZ, false);
+	}
+	return it->second;
+}
+
 void Map::clearSpectatorCache()
 {
 	spectatorCache.clear();
@@ -508,20 +649,132 @@ bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, const
 
 bool Map::isTileClear(const uint16_t x, const uint16_t y, const uint8_t z, const bool blockFloor /*= false*/)
 {
-	auto tile = getTile(x, y, z);
-	if (!tile) {
+	const auto& floor = getFloor(x, y, z);
+	if (!floor) {
 		return true;
 	}
 
-	if (blockFloor && tile->getGround()) {
+	const uint64_t bit = Floor::bit(x, y);
+	if (blockFloor && (floor->groundLayer & bit) != 0) {
 		return false;
 	}
 
-	return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
+	return (floor->projectileBlock & bit) == 0;
 }
 
 namespace {
 
+static_assert(Map::maxViewportX == Map::maxViewportY, "sight rays assume a square viewport");
+
+constexpr int32_t SIGHT_RAY_RADIUS = Map::maxViewportX;
+constexpr int32_t SIGHT_RAY_WINDOW = SIGHT_RAY_RADIUS * 2 + 1;
+static_assert(SIGHT_RAY_WINDOW <= 32, "sight ray rows must fit in 32 bits");
+
+// The tiles checkSightLine tests between an origin and a target, relative to
+// the origin, both as a list and as row masks of the window around the origin.
+struct SightRay {
+	uint32_t rows[SIGHT_RAY_WINDOW] = {};
+	int8_t cells[SIGHT_RAY_RADIUS][2] = {};
+	uint8_t count = 0;
+	uint8_t minRow = SIGHT_RAY_WINDOW;
+	uint8_t maxRow = 0;
+};
+
+class SightRayTable
+{
+	public:
+		SightRayTable() {
+			for (int32_t dy = -SIGHT_RAY_RADIUS; dy <= SIGHT_RAY_RADIUS; ++dy) {
+				for (int32_t dx = -SIGHT_RAY_RADIUS; dx <= SIGHT_RAY_RADIUS; ++dx) {
+					build(rays[dy + SIGHT_RAY_RADIUS][dx + SIGHT_RAY_RADIUS], dx, dy);
+				}
+			}
+		}
+
+		const SightRay* get(const int32_t dx, const int32_t dy) const {
+			if (std::abs(dx) > SIGHT_RAY_RADIUS || std::abs(dy) > SIGHT_RAY_RADIUS) {
+				return nullptr;
+			}
+			return &rays[dy + SIGHT_RAY_RADIUS][dx + SIGHT_RAY_RADIUS];
+		}
+
+	private:
+		static void addCell(SightRay& ray, const int32_t x, const int32_t y) {
+			ray.cells[ray.count][0] = static_cast<int8_t>(x);
+			ray.cells[ray.count][1] = static_cast<int8_t>(y);
+			++ray.count;
+
+			const uint8_t row = static_cast<uint8_t>(y + SIGHT_RAY_RADIUS);
+			ray.rows[row] |= 1U << (x + SIGHT_RAY_RADIUS);
+			ray.minRow = std::min(ray.minRow, row);
+			ray.maxRow = std::max(ray.maxRow, row);
+		}
+
+		// same stepping as checkSteepLine/checkSlightLine, walked from the lower end
+		static void build(SightRay& ray, const int32_t dx, const int32_t dy) {
+			if (dx == 0 && dy == 0) {
+				return;
+			}
+
+			const bool steep = std::abs(dy) > std::abs(dx);
+			const int32_t major = steep ? dy : dx;
+			const int32_t minor = steep ? dx : dy;
+			const int32_t a0 = major > 0 ? 0 : major;
+			const int32_t b0 = major > 0 ? 0 : minor;
+			const int32_t a1 = major > 0 ? major : 0;
+			const int32_t b1 = major > 0 ? minor : 0;
+
+			// floor(b0 + k * slope + 0.1) in exact integer arithmetic (scaled by 10 * delta),
+			// so rays do not depend on float rounding at the absolute map coordinates
+			const int32_t delta = a1 - a0;
+			for (int32_t k = 1; a0 + k < a1; ++k) {
+				const int32_t numerator = 10 * b0 * delta + 10 * k * (b1 - b0) + delta;
+				const int32_t denominator = 10 * delta;
+				const int32_t b = numerator >= 0 ? numerator / denominator : -((-numerator + denominator - 1) / denominator);
+				if (steep) {
+					addCell(ray, b, a0 + k);
+				} else {
+					addCell(ray, a0 + k, b);
+				}
+			}
+		}
+
+		SightRay rays[SIGHT_RAY_WINDOW][SIGHT_RAY_WINDOW];
+};
+
+const SightRayTable& getSightRays()
+{
+	static const SightRayTable table;
+	return table;
+}
+
+// Walks a precomputed ray, reusing the floor lookup while the ray stays inside a floor.
+bool isRayClear(const SightRay& ray, const int32_t x0, const int32_t y0, const uint8_t z)
+{
+	const Floor* floor = nullptr;
+	int32_t floorX = -1;
+	int32_t floorY = -1;
+
+	for (uint8_t i = 0; i < ray.count; ++i) {
+		const int32_t x = x0 + ray.cells[i][0];
+		const int32_t y = y0 + ray.cells[i][1];
+		if (x < 0 || y < 0 || x > 0xFFFF || y > 0xFFFF) {
+			continue;
+		}
+
+		if ((x & ~FLOOR_MASK) != floorX || (y & ~FLOOR_MASK) != floorY) {
+			floorX = x & ~FLOOR_MASK;
+			floorY = y & ~FLOOR_MASK;
+			floor = g_game.map.getFloor(x, y, z);
+		}
+
+		if (floor && (floor->projectileBlock & Floor::bit(x, y)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool checkSteepLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z)
 {
 	const float dx = x1 - x0;
@@ -564,6 +817,10 @@ bool Map::checkSightLine(const uint16_t x0, const uint16_t y0, const uint16_t x1
 		return true;
 	}
 
+	if (const auto& ray = getSightRays().get(x1 - x0, y1 - y0)) {
+		return isRayClear(*ray, x0, y0, z);
+	}
+
 	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
 		if (y1 > y0) {
 			return checkSteepLine(y0, x0, y1, x1, z);
@@ -652,6 +909,52 @@ bool Map::isSightClear(const Position& fromPos, const Position& toPos, const boo
 	return checkSightLine(fromPos.x, fromPos.y, toPos.x, toPos.y, fromPos.z);
 }
 
+void Map::isSightClear(const Position& fromPos, const std::vector<Position>& targets, std::vector<bool>& results, const bool sameFloor /*= false*/)
+{
+	results.assign(targets.size(), false);
+
+	uint32_t blockRows[SIGHT_RAY_WINDOW];
+	bool windowLoaded = false;
+
+	const SightRayTable& rays = getSightRays();
+	for (size_t i = 0, size = targets.size(); i < size; ++i) {
+		const Position& toPos = targets[i];
+		const int32_t dx = toPos.getX() - fromPos.getX();
+		const int32_t dy = toPos.getY() - fromPos.getY();
+
+		const SightRay* ray = toPos.z == fromPos.z ? rays.get(dx, dy) : nullptr;
+		if (!ray || (std::abs(dx) < 2 && std::abs(dy) < 2)) {
+			results[i] = isSightClear(fromPos, toPos, sameFloor);
+			continue;
+		}
+
+		if (!windowLoaded) {
+			readFloorLayer(fromPos.getX() - SIGHT_RAY_RADIUS, fromPos.getY() - SIGHT_RAY_RADIUS, fromPos.z,
+			               SIGHT_RAY_WINDOW, SIGHT_RAY_WINDOW, &Floor::projectileBlock, blockRows);
+			windowLoaded = true;
+		}
+
+		uint32_t blocked = 0;
+		for (uint8_t row = ray->minRow; row <= ray->maxRow; ++row) {
+			blocked |= blockRows[row] & ray->rows[row];
+		}
+
+		if (blocked == 0) {
+			results[i] = true;
+		} else if (sameFloor) {
+			results[i] = false;
+		} else if (fromPos.z == 0) {
+			// No obstacles above floor 0 so we can throw above the obstacle
+			results[i] = true;
+		} else {
+			const uint8_t newZ = fromPos.z - 1;
+			results[i] = isTileClear(fromPos.x, fromPos.y, newZ, true) &&
+				isTileClear(toPos.x, toPos.y, newZ, true) &&
+				checkSightLine(fromPos.x, fromPos.y, toPos.x, toPos.y, newZ);
+		}
+	}
+}
+
 TilePtr Map::canWalkTo(CreaturePtr& creature, const Position& pos)
 {
 	const int32_t& walkCache = creature->getWalkCache(pos);
@@ -662,9 +965,14 @@ TilePtr Map::canWalkTo(CreaturePtr& creature, const Position& pos)
 	}
 
 	//used for non-cached tiles
-	const auto& tile = getTile(pos.x, pos.y, pos.z);
+	const auto& floor = getFloor(pos.x, pos.y, pos.z);
+	if (!floor) {
+		return nullptr;
+	}
+
+	const auto& tile = floor->tiles[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK];
 	if (creature->getTile() != tile) {
-		if (!tile) {
+		if (!tile || (floor->pathBlock & Floor::bit(pos.x, pos.y)) != 0) {
 			return nullptr;
 		}
 
@@ -682,6 +990,7 @@ TilePtr Map::canWalkTo(CreaturePtr& creature, const Position& pos)
 
 bool Map::getPathMatching(CreaturePtr& creature, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
 {
+	ProfileScope profile(Subsystem::Pathfinding);
 	Position pos = creature->getPosition();
 	Position endPos;
 
@@ -976,84 +1285,88 @@ Floor::~Floor()
 	}
 }
 
-// QTreeNode
-QTreeNode::~QTreeNode()
+// SectorDirectory
+void SectorDirectory::reserve(const uint32_t width, const uint32_t height)
 {
-	for (const auto* ptr : child) {
-		delete ptr;
+	const uint32_t newColumns = std::max<uint32_t>(columns, (width + (1 << SUPERBLOCK_BITS) - 1) >> SUPERBLOCK_BITS);
+	const uint32_t newRows = std::max<uint32_t>(rows, (height + (1 << SUPERBLOCK_BITS) - 1) >> SUPERBLOCK_BITS);
+	if (newColumns == columns && newRows == rows) {
+		return;
 	}
-}
 
-QTreeLeafNode* QTreeNode::getLeaf(const uint32_t x, const uint32_t y)
-{
-	if (leaf) {
-		return static_cast<QTreeLeafNode*>(this);
+	std::vector<std::unique_ptr<Superblock>> resized(newColumns * newRows);
+	for (uint32_t row = 0; row < rows; ++row) {
+		for (uint32_t column = 0; column < columns; ++column) {
+			resized[row * newColumns + column] = std::move(superblocks[row * columns + column]);
+		}
 	}
 
-	const auto& node = child[((x & 0x8000) >> 15) | ((y & 0x8000) >> 14)];
-	if (!node) {
-		return nullptr;
-	}
-	return node->getLeaf(x << 1, y << 1);
+	superblocks = std::move(resized);
+	columns = newColumns;
+	rows = newRows;
 }
 
-QTreeLeafNode* QTreeNode::createLeaf(const uint32_t x, const uint32_t y, const uint32_t level)
+MapSector* SectorDirectory::createSector(const uint32_t x, const uint32_t y)
 {
-	if (!isLeaf()) {
-		const uint32_t index = ((x & 0x8000) >> 15) | ((y & 0x8000) >> 14);
-		if (!child[index]) {
-			if (level != FLOOR_BITS) {
-				child[index] = new QTreeNode();
-			} else {
-				child[index] = new QTreeLeafNode();
-				QTreeLeafNode::newLeaf = true;
-			}
-		}
-		return child[index]->createLeaf(x * 2, y * 2, level - 1);
+	// tiles outside of the map header (additional maps, scripts) grow the directory
+	reserve(x + 1, y + 1);
+
+	auto& superblock = superblocks[(y >> SUPERBLOCK_BITS) * columns + (x >> SUPERBLOCK_BITS)];
+	if (!superblock) {
+		superblock = std::make_unique<Superblock>();
 	}
-	return static_cast<QTreeLeafNode*>(this);
-}
 
-// QTreeLeafNode
-bool QTreeLeafNode::newLeaf = false;
+	auto& sector = superblock->sectors[sectorIndex(x, y)];
+	if (!sector) {
+		sector = std::make_unique<MapSector>();
+	}
+	return sector.get();
+}
 
-QTreeLeafNode::~QTreeLeafNode()
+// MapSector
+MapSector::~MapSector()
 {
-	for (const auto* ptr : array) {
+	for (const auto* ptr : floors) {
 		delete ptr;
 	}
 }
 
-Floor* QTreeLeafNode::createFloor(const uint32_t z)
+Floor* MapSector::createFloor(const uint32_t z)
 {
-	if (!array[z]) {
-		array[z] = new Floor();
+	if (!floors[z]) {
+		floors[z] = new Floor();
 	}
-	return array[z];
+	return floors[z];
 }
 
-void QTreeLeafNode::addCreature(const CreaturePtr& c)
+FloorCreatureList MapSector::getCreatureList(const CreaturePtr& c)
 {
-	creature_list.push_back(c);
-
 	if (c->getPlayer()) {
-		player_list.push_back(c);
+		return FLOOR_PLAYERS;
+	} else if (c->getMonster()) {
+		return FLOOR_MONSTERS;
 	}
+	return FLOOR_NPCS;
+}
+
+void MapSector::addCreature(const CreaturePtr& c, const uint8_t z)
+{
+	auto& list = createFloor(z)->creatures[getCreatureList(c)];
+	c->sectorIndex = static_cast<uint32_t>(list.size());
+	list.push_back(c);
 }
 
-void QTreeLeafNode::removeCreature(const CreaturePtr& c)
+void MapSector::removeCreature(const CreaturePtr& c, const uint8_t z)
 {
-	auto iter = std::ranges::find(creature_list, c);
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
+	auto& list = floors[z]->creatures[getCreatureList(c)];
+	const uint32_t index = c->sectorIndex;
+	assert(index < list.size() && list[index] == c);
 
-	if (c->getPlayer()) {
-		iter = std::ranges::find(player_list, c);
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
+	if (index != list.size() - 1) {
+		list[index] = std::move(list.back());
+		list[index]->sectorIndex = index;
 	}
+	list.pop_back();
 }
 
 uint32_t Map::clean()
@@ -107,6 +107,16 @@ static constexpr int32_t FLOOR_BITS = 3;
 static constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
 static constexpr int32_t FLOOR_MASK = (FLOOR_SIZE - 1);
 
+// Creatures standing on a floor are partitioned so spectator queries can skip
+// whole categories (e.g. player only broadcasts never look at monsters).
+enum FloorCreatureList : uint8_t {
+	FLOOR_PLAYERS,
+	FLOOR_MONSTERS,
+	FLOOR_NPCS,
+
+	FLOOR_CREATURE_LISTS
+};
+
 struct Floor {
 	constexpr Floor() = default;
 	~Floor();
@@ -116,86 +126,104 @@ struct Floor {
 	Floor& operator=(const Floor&) = delete;
 
 	TilePtr tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
+
+	// Walkability layers, one bit per tile (see Floor::bit). Tiles which do not
+	// exist are blocking, so both blocking layers start out fully set.
+	uint64_t walkBlock = ~0ULL; // no ground or a solid item
+	uint64_t pathBlock = ~0ULL; // walkBlock, floor change or teleport
+	uint64_t dynamicState = 0; // needs a full Tile::queryAdd (house, pz, fields...)
+	uint64_t projectileBlock = 0; // an item blocking projectiles
+	uint64_t groundLayer = 0; // tile has a ground
+
+	// Creatures standing on the floor, Creature::sectorIndex is their index in
+	// their list so they can be swap-removed.
+	CreatureVector creatures[FLOOR_CREATURE_LISTS];
+
+	static constexpr uint64_t bit(uint32_t x, uint32_t y) {
+		return 1ULL << (((y & FLOOR_MASK) << FLOOR_BITS) | (x & FLOOR_MASK));
+	}
+
+	static constexpr uint8_t row(uint64_t layer, uint32_t y) {
+		return static_cast<uint8_t>(layer >> ((y & FLOOR_MASK) << FLOOR_BITS));
+	}
 };
 
 class FrozenPathingConditionCall;
-class QTreeLeafNode;
 
-class QTreeNode
+// The map is split into sectors of 8x8 tiles (one Floor per layer), grouped
+// into superblocks of 32x32 sectors (256x256 tiles). The directory is a dense
+// grid of superblocks sized from the map header, so finding the sector of a
+// position takes two indexed loads and neighbouring sectors are plain index
+// arithmetic.
+static constexpr int32_t SECTOR_BITS = 5;
+static constexpr int32_t SECTOR_SIZE = (1 << SECTOR_BITS);
+static constexpr int32_t SECTOR_MASK = (SECTOR_SIZE - 1);
+static constexpr int32_t SUPERBLOCK_BITS = FLOOR_BITS + SECTOR_BITS;
+
+class MapSector
 {
 	public:
-		constexpr QTreeNode() = default;
-		virtual ~QTreeNode();
+		MapSector() = default;
+		~MapSector();
 
 		// non-copyable
-		QTreeNode(const QTreeNode&) = delete;
-		QTreeNode& operator=(const QTreeNode&) = delete;
-
-		bool isLeaf() const {
-			return leaf;
-		}
-
-		QTreeLeafNode* getLeaf(uint32_t x, uint32_t y);
-
-		template<typename Leaf, typename Node>
-		static Leaf getLeafStatic(Node node, uint32_t x, uint32_t y)
-		{
-
-			uint32_t mask = 0x8000;
+		MapSector(const MapSector&) = delete;
+		MapSector& operator=(const MapSector&) = delete;
 
-			do {
-
-				node = node->child[((x & mask) >> 15) | ((y & mask) >> 14)];
-				if (!node) {
-					return nullptr;
-				}
+		Floor* createFloor(uint32_t z);
 
-				x <<= 1;
-				y <<= 1;
-			} while (!node->leaf);
-			return static_cast<Leaf>(node);
+		Floor* getFloor(uint8_t z) const {
+			return floors[z];
 		}
 
-		QTreeLeafNode* createLeaf(uint32_t x, uint32_t y, uint32_t level);
-
-	protected:
-		bool leaf = false;
+		void addCreature(const CreaturePtr& c, uint8_t z);
+		void removeCreature(const CreaturePtr& c, uint8_t z);
 
 	private:
-		QTreeNode* child[4] = {};
+		static FloorCreatureList getCreatureList(const CreaturePtr& c);
+
+		Floor* floors[MAP_MAX_LAYERS] = {};
 
 		friend class Map;
 };
 
-class QTreeLeafNode final : public QTreeNode
+class SectorDirectory
 {
 	public:
-		QTreeLeafNode() { leaf = true; newLeaf = true; }
-		~QTreeLeafNode() override;
-
-		// non-copyable
-		QTreeLeafNode(const QTreeLeafNode&) = delete;
-		QTreeLeafNode& operator=(const QTreeLeafNode&) = delete;
-
-		Floor* createFloor(uint32_t z);
-	
-		Floor* getFloor(uint8_t z) const {
-			return array[z];
+		/**
+		  * Sizes the directory to cover a map of the given dimensions in tiles.
+		  * Existing sectors are kept; the directory never shrinks.
+		  */
+		void reserve(uint32_t width, uint32_t height);
+
+		MapSector* getSector(uint32_t x, uint32_t y) const {
+			const uint32_t column = x >> SUPERBLOCK_BITS;
+			const uint32_t row = y >> SUPERBLOCK_BITS;
+			if (column >= columns || row >= rows) {
+				return nullptr;
+			}
+
+			const auto& superblock = superblocks[row * columns + column];
+			if (!superblock) {
+				return nullptr;
+			}
+			return superblock->sectors[sectorIndex(x, y)].get();
 		}
 
-		void addCreature(const CreaturePtr& c);
-		void removeCreature(const CreaturePtr& c);
+		MapSector* createSector(uint32_t x, uint32_t y);
 
 	private:
-		static bool newLeaf;
-		QTreeLeafNode* leafS = nullptr;
-		QTreeLeafNode* leafE = nullptr;
-		Floor* array[MAP_MAX_LAYERS] = {};
-		CreatureVector creature_list;
-		CreatureVector player_list;
+		struct Superblock {
+			std::unique_ptr<MapSector> sectors[SECTOR_SIZE * SECTOR_SIZE];
+		};
 
-		friend class Map;
-		friend class QTreeNode;
+		static constexpr uint32_t sectorIndex(uint32_t x, uint32_t y) {
+			return (((y >> FLOOR_BITS) & SECTOR_MASK) << SECTOR_BITS) | ((x >> FLOOR_BITS) & SECTOR_MASK);
+		}
+
+		std::vector<std::unique_ptr<Superblock>> superblocks;
+		uint32_t columns = 0;
+		uint32_t rows = 0;
 };
 
 /**
@@ -258,6 +286,38 @@ class Map
 			removeTile(pos.x, pos.y, pos.z);
 		}
 
+		/**
+		  * Recomputes the walkability bits of a tile from its current flags.
+		  * Called whenever the tile flags change.
+		  */
+		void refreshTileLayers(const Tile* tile);
+
+		/**
+		  * Reads the walkability layers of a rectangle (at most 32 tiles wide).
+		  * Bit n of each row refers to the tile at x + n.
+		  *	\param walkRows set for tiles free of static path blockers
+		  *	\param checkRows set for tiles which need a full Tile::queryAdd, either
+		  *	because of their dynamic state or because a creature is standing on them
+		  */
+		void getWalkLayers(int32_t x, int32_t y, uint8_t z, int32_t width, int32_t height,
+		                   uint32_t* walkRows, uint32_t* checkRows) const;
+
+		/**
+		  * Get the floor (8x8 tiles) holding a position.
+		  * \returns A pointer to the floor or nullptr if no tile was ever placed there.
+		  */
+		const Floor* getFloor(uint16_t x, uint16_t y, uint8_t z) const;
+
+		/**
+		  * Size of the map in tiles, as given by the map header.
+		  */
+		uint32_t getWidth() const {
+			return width;
+		}
+		uint32_t getHeight() const {
+			return height;
+		}
+
 		/**
 		  * Place a creature on the map
 		  * \param centerPos The position to place the creature
@@ -276,6 +336,18 @@ class Map
 		void clearSpectatorCache();
 		void clearPlayersSpectatorCache();
 
+		/**
+		  * Creatures that a monster anywhere in the 8x8 sector of pos can be
+		  * aware of, the multifloor viewport around the whole sector. The result
+		  * is kept until clearSectorSpectatorCache, so monsters sharing a sector
+		  * share one query; callers filter by their own position. The reference
+		  * stays valid until clearSectorSpectatorCache.
+		  */
+		const SpectatorVec& getSectorSpectators(const Position& pos);
+		void clearSectorSpectatorCache() {
+			sectorSpectatorCache.clear();
+		}
+
 		/**
 		  * Checks if you can throw an object to that position
 		  *	\param fromPos from Source point
@@ -307,6 +379,14 @@ class Map
 		bool isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor = false);
 		static bool checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z);
 
+		/**
+		  * Checks line of sight from one position to many targets at once.
+		  * The projectile layer around fromPos is read a single time and every
+		  * target within the viewport is resolved against a precomputed ray mask.
+		  *	\param results receives one entry per target, as isSightClear would return
+		  */
+		void isSightClear(const Position& fromPos, const std::vector<Position>& targets, std::vector<bool>& results, bool sameFloor = false);
+
 		TilePtr canWalkTo(CreaturePtr& creature, const Position& pos);
 
 		bool getPathMatching(CreaturePtr& creature, std::vector<Direction>& dirList,
@@ -314,8 +394,8 @@ class Map
 
 		std::map<std::string, Position> waypoints;
 
-		QTreeLeafNode* getQTNode(uint16_t x, uint16_t y) {
-			return QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, x, y);
+		MapSector* getSector(uint16_t x, uint16_t y) const {
+			return sectors.getSector(x, y);
 		}
 
 		Spawns spawns;
@@ -326,7 +406,9 @@ class Map
 		SpectatorCache spectatorCache;
 		SpectatorCache playersSpectatorCache;
 		ChunkCache chunksSpectatorCache;
-		QTreeNode root;
+		// node based, references handed out by getSectorSpectators survive inserts of other sectors
+		gtl::node_hash_map<uint64_t, SpectatorVec> sectorSpectatorCache;
+		SectorDirectory sectors;
 
 		std::filesystem::path spawnfile;
 		std::filesystem::path housefile;
@@ -334,6 +416,10 @@ class Map
 		uint32_t width = 0;
 		uint32_t height = 0;
 
+		// Reads one layer of the floors covering a rectangle (at most 32 tiles wide)
+		void readFloorLayer(int32_t x, int32_t y, uint8_t z, int32_t width, int32_t height,
+		                    uint64_t Floor::* layer, uint32_t* rows) const;
+
 		// Actually scans the map for spectators
 		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos,
 		                           int32_t minRangeX, int32_t maxRangeX,
@@ -2,6 +2,19 @@
 
 #include "matrixarea.h"
 
+void MatrixArea::compileOffsets()
+{
+	offsets.clear();
+	auto &&[centerX, centerY] = center;
+	for (uint32_t row = 0; row < rows; ++row) {
+		for (uint32_t col = 0; col < cols; ++col) {
+			if (arr[row * cols + col]) {
+				offsets.emplace_back(static_cast<int32_t>(col) - static_cast<int32_t>(centerX), static_cast<int32_t>(row) - static_cast<int32_t>(centerY));
+			}
+		}
+	}
+}
+
 MatrixArea MatrixArea::rotate90() const
 {
 	Container newArr(arr.size());
@@ -62,5 +75,7 @@ MatrixArea createArea(const std::vector<uint32_t> &vec, const uint32_t rows)
 			++y;
 		}
 	}
+
+	area.compileOffsets();
 	return area;
 }
@@ -9,6 +9,9 @@ class MatrixArea
 	using Container = std::valarray<bool>;
 
 public:
+	// x and y of a set cell relative to the center
+	using Offset = std::pair<int32_t, int32_t>;
+
 	MatrixArea() = default;
 	MatrixArea(uint32_t rows, uint32_t cols) : arr(rows * cols), rows{rows}, cols{cols} {}
 
@@ -21,6 +24,10 @@ public:
 	uint32_t getRows() const { return rows; }
 	uint32_t getCols() const { return cols; }
 
+	// the set cells as offsets, row by row, see compileOffsets
+	const std::vector<Offset>& getOffsets() const { return offsets; }
+	void compileOffsets();
+
 	[[nodiscard]] MatrixArea rotate90() const;
 	[[nodiscard]] MatrixArea rotate180() const;
 	[[nodiscard]] MatrixArea rotate270() const;
@@ -30,10 +37,13 @@ public:
 private:
 	MatrixArea(Center center, uint32_t rows, uint32_t cols, Container&& arr) :
 	    arr{std::move(arr)}, center{std::move(center)}, rows{rows}, cols{cols}
-	{}
+	{
+		compileOffsets();
+	}
 
 	Container arr = {};
 	Center center = {};
+	std::vector<Offset> offsets;
 	uint32_t rows = 0, cols = 0;
 };
 
@@ -54,16 +54,17 @@ Monster::Monster(MonsterType* mType) :
 Monster::~Monster()
 {
 	clearTargetList();
-	clearFriendList();
 }
 
 void Monster::addList()
 {
 	g_game.addMonster(getMonster());
+	g_game.monsterAI.add(*this);
 }
 
 void Monster::removeList()
 {
+	g_game.monsterAI.remove(*this);
 	g_game.removeMonster(getMonster());
 }
 
@@ -118,7 +119,7 @@ bool Monster::canWalkOnFieldType(const CombatType_t combatType) const
 
 void Monster::onAttackedCreatureDisappear(bool)
 {
-	attackTicks = 0;
+	g_game.monsterAI.setAttackTicks(aiIndex, 0);
 }
 
 void Monster::onCreatureAppear(const CreaturePtr& creature, const bool isLogin)
@@ -296,19 +297,6 @@ void Monster::onCreatureSay(const CreaturePtr& creature, SpeakClasses type, cons
 	}
 }
 
-void Monster::addFriend(const CreaturePtr& creature)
-{
-	assert(creature != this->getCreature());
-	const auto& result = friendList.insert(creature);
-}
-
-void Monster::removeFriend(const CreaturePtr& creature)
-{
-	if (auto it = friendList.find(creature); it != friendList.end()) {
-		friendList.erase(it);
-	}
-}
-
 void Monster::addTarget(const CreaturePtr& creature, bool pushFront /* = false */)
 {
 	assert(creature != this->getCreature());
@@ -344,17 +332,6 @@ void Monster::removeTarget(const CreaturePtr& creature)
 
 void Monster::updateTargetList()
 {
-	auto friendIterator = friendList.begin();
-	while (friendIterator != friendList.end()) {
-		const auto& creature = *friendIterator;
-		if (creature->getHealth() <= 0 || !canSee(creature->getPosition())) {
-			friendIterator = friendList.erase(friendIterator);
-		}
-		else {
-			++friendIterator;
-		}
-	}
-
 	// Clean up targetList with expired or invalid targets
 	auto targetIterator = targetList.begin();
 	while (targetIterator != targetList.end()) {
@@ -367,12 +344,31 @@ void Monster::updateTargetList()
 		}
 	}
 
-	// Update with new spectators
-	SpectatorVec spectators;
-	g_game.map.getSpectators(spectators, position, true);
-	spectators.erase(this->getCreature());
-	for (const auto& spectator : spectators) {
-		onCreatureFound(spectator);
+	// creatures this monster left behind by moving never report leaving
+	for (auto it = friendOverrides.begin(); it != friendOverrides.end();) {
+		const auto creature = g_game.getCreatureByID(it->first);
+		if (!creature || creature->getHealth() <= 0 || !canSee(creature->getPosition())) {
+			friendOverrides.erase(it++);
+		} else {
+			++it;
+		}
+	}
+
+	// Update with new spectators, the query is shared by every monster of the sector
+	bool sawCreature = false;
+	for (const auto& spectator : g_game.map.getSectorSpectators(position)) {
+		if (spectator.get() == this || spectator->isRemoved() || !canSee(spectator->getPosition())) {
+			continue;
+		}
+
+		sawCreature = true;
+		if (isOpponent(spectator)) {
+			addTarget(spectator);
+		}
+	}
+
+	if (sawCreature) {
+		updateIdleStatus();
 	}
 }
 
@@ -381,9 +377,32 @@ void Monster::clearTargetList()
 	targetList.clear();
 }
 
-void Monster::clearFriendList()
+CreatureVector Monster::getFriendList() const
 {
-	friendList.clear();
+	CreatureVector friends;
+	for (const auto& spectator : g_game.map.getSectorSpectators(position)) {
+		if (spectator.get() != this && !spectator->isRemoved() && spectator->getHealth() > 0 && canSee(spectator->getPosition()) && isFriend(spectator)) {
+			friends.push_back(spectator);
+		}
+	}
+	return friends;
+}
+
+MonsterFaction_t Monster::getFaction(const CreatureConstPtr& creature)
+{
+	if (const auto& player = creature->getPlayer()) {
+		return player->hasFlag(PlayerFlag_IgnoredByMonsters) ? FACTION_NONE : FACTION_PLAYER;
+	}
+
+	if (creature->getNpc()) {
+		return FACTION_NPC;
+	}
+
+	const auto& master = creature->getMaster();
+	if (!master) {
+		return FACTION_WILD;
+	}
+	return master->getPlayer() ? FACTION_PLAYER_SUMMON : FACTION_MONSTER_SUMMON;
 }
 
 void Monster::onCreatureFound(const CreaturePtr& creature, bool pushFront/* = false*/)
@@ -401,10 +420,6 @@ void Monster::onCreatureFound(const CreaturePtr& creature, bool pushFront/* = fa
 		return;
 	}
 
-	if (isFriend(creature)) {
-		addFriend(creature);
-	}
-
 	if (isOpponent(creature)) {
 		addTarget(creature, pushFront);
 	}
@@ -424,8 +439,27 @@ void Monster::onCreatureEnter(const CreaturePtr& creature)
 	onCreatureFound(creature, true);
 }
 
+void Monster::addFriend(const CreaturePtr& creature)
+{
+	assert(creature != this->getCreature());
+	friendOverrides[creature->getID()] = true;
+	removeTarget(creature);
+}
+
+void Monster::removeFriend(const CreaturePtr& creature)
+{
+	friendOverrides[creature->getID()] = false;
+	if (isOpponent(creature) && canSee(creature->getPosition())) {
+		addTarget(creature);
+	}
+}
+
 bool Monster::isFriend(const CreatureConstPtr& creature) const
 {
+	if (auto it = friendOverrides.find(creature->getID()); it != friendOverrides.end()) {
+		return it->second;
+	}
+
 	if (isSummon() && getMaster()->getPlayer()) {
 		const auto& masterPlayer = getMaster()->getPlayer();
 		PlayerConstPtr tmpPlayer = nullptr;
@@ -443,27 +477,23 @@ bool Monster::isFriend(const CreatureConstPtr& creature) const
 		if (tmpPlayer && (tmpPlayer == getMaster() || masterPlayer->isPartner(tmpPlayer))) {
 			return true;
 		}
-	} else if (creature->getMonster() && !creature->isSummon()) {
-		return true;
+		return false;
 	}
 
-	return false;
+	return (mType->info.friendFactions & factionMask(getFaction(creature))) != 0;
 }
 
 bool Monster::isOpponent(const CreatureConstPtr& creature) const
 {
+	if (auto it = friendOverrides.find(creature->getID()); it != friendOverrides.end() && it->second) {
+		return false;
+	}
+
 	if (isSummon() && getMaster()->getPlayer()) {
-		if (creature != getMaster()) {
-			return true;
-		}
-	} else {
-		if ((creature->getPlayer() && !creature->getPlayer()->hasFlag(PlayerFlag_IgnoredByMonsters)) ||
-		        (creature->getMaster() && creature->getMaster()->getPlayer())) {
-			return true;
-		}
+		return creature != getMaster();
 	}
 
-	return false;
+	return (mType->info.opponentFactions & factionMask(getFaction(creature))) != 0;
 }
 
 void Monster::onCreatureLeave(const CreaturePtr& creature)
@@ -475,11 +505,6 @@ void Monster::onCreatureLeave(const CreaturePtr& creature)
 		isMasterInRange = false;
 	}
 
-	//update friendList
-	if (isFriend(creature)) {
-		removeFriend(creature);
-	}
-
 	//update targetList
 	if (isOpponent(creature)) {
 		removeTarget(creature);
@@ -492,6 +517,9 @@ void Monster::onCreatureLeave(const CreaturePtr& creature)
 			}
 		}
 	}
+
+	// overrides last while the creature is in sight, as the friend list did
+	friendOverrides.erase(creature->getID());
 }
 
 bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAULT*/)
@@ -639,7 +667,6 @@ void Monster::setIdle(const bool idle)
 	} else {
 		onIdleStatus();
 		clearTargetList();
-		clearFriendList();
 		Game::removeCreatureCheck(this->getCreature());
 	}
 }
@@ -745,9 +772,8 @@ void Monster::onThink(const uint32_t interval)
 				}
 			}
 
-			onThinkTarget(interval);
-			onThinkYell(interval);
-			onThinkDefense(interval);
+			// retarget, yell and defense run batched with the other monsters of this slot
+			g_game.monsterAI.addDue(getMonster());
 		}
 	}
 
@@ -784,7 +810,12 @@ void Monster::doAttacking(const uint32_t interval)
         return;
     }
     bool resetTicks = interval != 0;
-    attackTicks += interval;
+    const uint32_t attackTicks = g_game.monsterAI.getAttackTicks(aiIndex) + interval;
+    g_game.monsterAI.setAttackTicks(aiIndex, attackTicks);
+
+    // chances rolled by MonsterAI::think for this round, casts outside of it roll here
+    const auto rolls = interval != 0 ? g_game.monsterAI.takeAttackRolls(aiIndex) : std::nullopt;
+    size_t spellIndex = 0;
     updateLookDirection();
     const Position& myPos = getPosition();
     const Position& targetPos = attacked_creature->getPosition();
@@ -797,9 +828,11 @@ void Monster::doAttacking(const uint32_t interval)
         }
 
         bool inRange = false;
-		const uint32_t chance = uniform_random(1, 100);
+        const bool rolled = rolls and spellIndex < 64 ? ((*rolls >> spellIndex) & 1) != 0
+                                                      : static_cast<uint32_t>(uniform_random(1, 100)) <= spellBlock.chance;
+        ++spellIndex;
 
-        if (chance <= spellBlock.chance and canUseSpell(myPos, targetPos, spellBlock, interval, inRange, resetTicks))
+        if (rolled and canUseSpell(myPos, targetPos, spellBlock, interval, attackTicks, inRange, resetTicks))
         {
             minCombatValue = spellBlock.minCombatValue;
             maxCombatValue = spellBlock.maxCombatValue;
@@ -813,7 +846,8 @@ void Monster::doAttacking(const uint32_t interval)
     
     if (resetTicks) 
     {
-        attackTicks = 0;
+        // spells may have removed or moved us in the arrays, so look the index up again
+        g_game.monsterAI.setAttackTicks(aiIndex, 0);
     }
 }
 
@@ -833,7 +867,7 @@ bool Monster::canUseAttack(const Position& pos, const CreatureConstPtr& target)
 }
 
 bool Monster::canUseSpell(const Position& pos, const Position& targetPos,
-                          const spellBlock_t& sb, const uint32_t interval, bool& inRange, bool& resetTicks) const
+                          const spellBlock_t& sb, const uint32_t interval, const uint32_t attackTicks, bool& inRange, bool& resetTicks) const
 {
 	inRange = true;
 
@@ -860,148 +894,59 @@ bool Monster::canUseSpell(const Position& pos, const Position& targetPos,
 	return true;
 }
 
-void Monster::onThinkTarget(const uint32_t interval)
+bool Monster::isFleeing() const
 {
-	if (!isSummon()) {
-		if (mType->info.changeTargetSpeed != 0) {
-			bool canChangeTarget = true;
-
-			if (challengeFocusDuration > 0) {
-				challengeFocusDuration -= interval;
-
-				if (challengeFocusDuration <= 0) {
-					challengeFocusDuration = 0;
-				}
-			}
-
-			if (targetChangeCooldown > 0) {
-				targetChangeCooldown -= interval;
-
-				if (targetChangeCooldown <= 0) {
-					targetChangeCooldown = 0;
-					targetChangeTicks = mType->info.changeTargetSpeed;
-				} else {
-					canChangeTarget = false;
-				}
-			}
-
-			if (canChangeTarget) {
-				targetChangeTicks += interval;
-
-				if (targetChangeTicks >= mType->info.changeTargetSpeed) {
-					targetChangeTicks = 0;
-					targetChangeCooldown = mType->info.changeTargetSpeed;
-
-					if (challengeFocusDuration > 0) {
-						challengeFocusDuration = 0;
-					}
+	return !isSummon() && getHealth() <= mType->info.runAwayHealth && g_game.monsterAI.getChallengeFocus(aiIndex) <= 0;
+}
 
-					if (mType->info.changeTargetChance >= uniform_random(1, 100)) {
-						if (mType->info.targetDistance <= 1) {
-							searchTarget(TARGETSEARCH_RANDOM);
-						} else {
-							searchTarget(TARGETSEARCH_NEAREST);
-						}
-					}
-				}
-			}
-		}
+void Monster::changeTarget()
+{
+	if (mType->info.targetDistance <= 1) {
+		searchTarget(TARGETSEARCH_RANDOM);
+	} else {
+		searchTarget(TARGETSEARCH_NEAREST);
 	}
 }
 
-void Monster::onThinkDefense(const uint32_t interval)
+void Monster::yell(const voiceBlock_t& voice)
 {
-	bool resetTicks = true;
-	defenseTicks += interval;
-
-	for (const spellBlock_t& spellBlock : mType->info.defenseSpells) {
-		if (spellBlock.speed > defenseTicks) {
-			resetTicks = false;
-			continue;
-		}
+	g_game.internalCreatureSay(this->getMonster(), voice.yellText ? TALKTYPE_MONSTER_YELL : TALKTYPE_MONSTER_SAY, voice.text, false);
+}
 
-		if (defenseTicks % spellBlock.speed >= interval) {
-			//already used this spell for this round
-			continue;
-		}
+void Monster::castDefense(const spellBlock_t& spellBlock)
+{
+	minCombatValue = spellBlock.minCombatValue;
+	maxCombatValue = spellBlock.maxCombatValue;
+	spellBlock.spell->castSpell(this->getMonster(), this->getCreature());
+}
 
-		if ((spellBlock.chance >= static_cast<uint32_t>(uniform_random(1, 100)))) {
-			minCombatValue = spellBlock.minCombatValue;
-			maxCombatValue = spellBlock.maxCombatValue;
-			spellBlock.spell->castSpell(this->getMonster(), this->getCreature());
-		}
+void Monster::trySummon(const summonBlock_t& summonBlock)
+{
+	if (summons.size() >= mType->info.maxSummons) {
+		return;
 	}
 
-	if (!isSummon() && summons.size() < mType->info.maxSummons && hasFollowPath) {
-		for (const summonBlock_t& summonBlock : mType->info.summons) {
-			if (summonBlock.speed > defenseTicks) {
-				resetTicks = false;
-				continue;
-			}
-
-			if (summons.size() >= mType->info.maxSummons) {
-				continue;
-			}
-
-			if (defenseTicks % summonBlock.speed >= interval) {
-				//already used this spell for this round
-				continue;
-			}
-
-			uint32_t summonCount = 0;
-			std::string lowerSummonName = summonBlock.name;
-			toLowerCaseString(lowerSummonName);
-
-			for (const auto& summon : summons) {
-				if (summon->getRegisteredName() == lowerSummonName) {
-					++summonCount;
-				}
-			}
-
-			if (summonCount >= summonBlock.max) {
-				continue;
-			}
-
-			if (summonBlock.chance < static_cast<uint32_t>(uniform_random(1, 100))) {
-				continue;
-			}
+	uint32_t summonCount = 0;
+	std::string lowerSummonName = summonBlock.name;
+	toLowerCaseString(lowerSummonName);
 
-			if (MonsterPtr summon = Monster::createMonster(summonBlock.name)) {
-				if (g_game.placeCreature(summon, getPosition(), false, summonBlock.force, summonBlock.effect)) {
-					summon->setDropLoot(false);
-					summon->setSkillLoss(false);
-					summon->setMaster(this->getMonster());
-					if (summonBlock.masterEffect != CONST_ME_NONE) {
-						g_game.addMagicEffect(getPosition(), summonBlock.masterEffect);
-					}
-				}
-			}
+	for (const auto& summon : summons) {
+		if (summon->getRegisteredName() == lowerSummonName) {
+			++summonCount;
 		}
 	}
 
-	if (resetTicks) {
-		defenseTicks = 0;
-	}
-}
-
-void Monster::onThinkYell(const uint32_t interval)
-{
-	if (mType->info.yellSpeedTicks == 0) {
+	if (summonCount >= summonBlock.max) {
 		return;
 	}
 
-	yellTicks += interval;
-	if (yellTicks >= mType->info.yellSpeedTicks) {
-		yellTicks = 0;
-
-		if (!mType->info.voiceVector.empty() && (mType->info.yellChance >= static_cast<uint32_t>(uniform_random(1, 100)))) {
-			uint32_t index = uniform_random(0, mType->info.voiceVector.size() - 1);
-			const voiceBlock_t& vb = mType->info.voiceVector[index];
-
-			if (vb.yellText) {
-				g_game.internalCreatureSay(this->getMonster(), TALKTYPE_MONSTER_YELL, vb.text, false);
-			} else {
-				g_game.internalCreatureSay(this->getMonster(), TALKTYPE_MONSTER_SAY, vb.text, false);
+	if (MonsterPtr summon = Monster::createMonster(summonBlock.name)) {
+		if (g_game.placeCreature(summon, getPosition(), false, summonBlock.force, summonBlock.effect)) {
+			summon->setDropLoot(false);
+			summon->setSkillLoss(false);
+			summon->setMaster(this->getMonster());
+			if (summonBlock.masterEffect != CONST_ME_NONE) {
+				g_game.addMagicEffect(getPosition(), summonBlock.masterEffect);
 			}
 		}
 	}
@@ -1364,7 +1309,7 @@ void Monster::fleeFromTarget(const Position& target_position, Direction& directi
 
 	const auto& flee_list = FleeMap[target_direction];
 	const bool diagonal = (offset_x != 0) and (offset_y != 0);
-    const auto random_number = (rand() % 3);
+    const auto random_number = getRandomGenerator().bounded(3u);
 	const bool chance = ((random_number + 1 ) > 1);
 
 	// We have Primary, Secondary, Tertiary priority levels
@@ -1696,7 +1641,6 @@ void Monster::death(const CreaturePtr&)
 	summons.clear();
 
 	clearTargetList();
-	clearFriendList();
 	onIdleStatus();
 }
 
@@ -1853,9 +1797,7 @@ bool Monster::challengeCreature(const CreaturePtr& creature, bool force/* = fals
 
 	bool result = selectTarget(creature);
 	if (result) {
-		targetChangeCooldown = 8000;
-		challengeFocusDuration = targetChangeCooldown;
-		targetChangeTicks = 0;
+		g_game.monsterAI.challenge(aiIndex);
 	}
 	return result;
 }
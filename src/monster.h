@@ -6,12 +6,12 @@
 
 #include "tile.h"
 #include "monsters.h"
+#include "monsterai.h"
 
 class Creature;
 class Game;
 class Spawn;
 
-using CreatureHashSet = std::unordered_set<CreaturePtr>;
 using CreatureList = std::vector<CreatureWeakPtr>;
 
 enum TargetSearchType_t {
@@ -177,19 +177,18 @@ class Monster final : public Creature
 			return targetList;
 		}
 	
-		const CreatureHashSet& getFriendList() const {
-			return friendList;
-		}
-	
-		CreatureHashSet& getFriendList() {
-			return friendList;
-		}
+		// friends are not tracked, they are looked up around the monster when asked for
+		CreatureVector getFriendList() const;
+
+		// overrides the type factions for one creature, see monster:addFriend
+		void addFriend(const CreaturePtr& creature);
+		void removeFriend(const CreaturePtr& creature);
+
+		static MonsterFaction_t getFaction(const CreatureConstPtr& creature);
 
 		bool canTarget(const CreatureConstPtr& creature) const;
 	
-		bool isFleeing() const {
-			return !isSummon() && getHealth() <= mType->info.runAwayHealth && challengeFocusDuration <= 0;
-		}
+		bool isFleeing() const;
 
 		void fleeFromTarget(const Position& targetPos, Direction& direction) noexcept;
 
@@ -211,9 +210,11 @@ class Monster final : public Creature
 		static uint32_t monsterAutoID;
 
 	private:
-		CreatureHashSet friendList;
 		CreatureList targetList;
 
+		// creature id -> whether it is a friend regardless of its faction, only for creatures in sight
+		gtl::flat_hash_map<uint32_t, bool> friendOverrides;
+
 		std::string name;
 		std::string nameDescription;
 
@@ -222,15 +223,10 @@ class Monster final : public Creature
 
 		int64_t lastMeleeAttack = 0;
 
-		uint32_t attackTicks = 0;
-		uint32_t targetTicks = 0;
-		uint32_t targetChangeTicks = 0;
-		uint32_t defenseTicks = 0;
-		uint32_t yellTicks = 0;
+		// timers and rolls live in Game::monsterAI
+		uint32_t aiIndex = MonsterAI::NO_INDEX;
 		int32_t minCombatValue = 0;
 		int32_t maxCombatValue = 0;
-		int32_t targetChangeCooldown = 0;
-		int32_t challengeFocusDuration = 0;
 		int32_t stepDuration = 0;
 
 		Position masterPos;
@@ -247,14 +243,11 @@ class Monster final : public Creature
 
 		void updateLookDirection();
 
-		void addFriend(const CreaturePtr& creature);
-		void removeFriend(const CreaturePtr& creature);
 		void addTarget(const CreaturePtr& creature, bool pushFront = false);
 		void removeTarget(const CreaturePtr& creature);
 
 		void updateTargetList();
 		void clearTargetList();
-		void clearFriendList();
 
 		void death(const CreaturePtr& lastHitCreature) override;
 		ItemPtr getCorpse(const CreaturePtr& lastHitCreature, const CreaturePtr& mostDamageCreature) override;
@@ -271,7 +264,7 @@ class Monster final : public Creature
 
 		bool canUseAttack(const Position& pos, const CreatureConstPtr& target) const;
 		bool canUseSpell(const Position& pos, const Position& targetPos,
-		                 const spellBlock_t& sb, uint32_t interval, bool& inRange, bool& resetTicks) const;
+		                 const spellBlock_t& sb, uint32_t interval, uint32_t attackTicks, bool& inRange, bool& resetTicks) const;
 		bool getRandomStep(const Position& creaturePos, Direction& direction);
 		bool getDanceStep(const Position& creaturePos, Direction& direction,
 		                  bool keepAttack = true, bool keepDistance = true);
@@ -283,9 +276,11 @@ class Monster final : public Creature
 		static bool pushCreature(const CreaturePtr& creature);
 		static void pushCreatures(const TilePtr& tile);
 
-		void onThinkTarget(uint32_t interval);
-		void onThinkYell(uint32_t interval);
-		void onThinkDefense(uint32_t interval);
+		// decisions taken by MonsterAI::think
+		void changeTarget();
+		void yell(const voiceBlock_t& voice);
+		void castDefense(const spellBlock_t& spellBlock);
+		void trySummon(const summonBlock_t& summonBlock);
 
 		bool isFriend(const CreatureConstPtr& creature) const;
 		bool isOpponent(const CreatureConstPtr& creature) const;
@@ -315,6 +310,7 @@ class Monster final : public Creature
 		}
 
 		friend class LuaScriptInterface;
+		friend class MonsterAI;
 };
 
 #endif
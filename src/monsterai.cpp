@@ -0,0 +1,272 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "monsterai.h"
+#include "monster.h"
+#include "tools.h"
+
+namespace {
+
+// an attack roll mask has room for this many attack spells, the rest roll when they are cast
+constexpr size_t MAX_ROLLED_ATTACKS = 64;
+
+// how long a challenged monster keeps its target, see Monster::challengeCreature
+constexpr int32_t CHALLENGE_FOCUS_DURATION = 8000;
+
+}
+
+void MonsterAI::add(Monster& monster)
+{
+	if (monster.aiIndex != NO_INDEX) {
+		return;
+	}
+
+	const MonsterType* mType = monster.mType;
+	monster.aiIndex = static_cast<uint32_t>(monsters.size());
+	monsters.push_back(&monster);
+	types.push_back(mType);
+	changeTargetSpeed.push_back(mType->info.changeTargetSpeed);
+	changeTargetChance.push_back(mType->info.changeTargetChance);
+	yellSpeed.push_back(mType->info.yellSpeedTicks);
+	yellChance.push_back(mType->info.yellChance);
+	attackTicks.push_back(0);
+	defenseTicks.push_back(0);
+	yellTicks.push_back(0);
+	targetChangeTicks.push_back(0);
+	targetChangeCooldown.push_back(0);
+	challengeFocus.push_back(0);
+	attackRolls.push_back(0);
+	flags.push_back(0);
+}
+
+void MonsterAI::remove(Monster& monster)
+{
+	const uint32_t index = monster.aiIndex;
+	if (index == NO_INDEX) {
+		return;
+	}
+
+	// the last monster takes the freed index
+	monsters.back()->aiIndex = index;
+	forEachArray([index](auto& array) {
+		array[index] = std::move(array.back());
+		array.pop_back();
+	});
+	monster.aiIndex = NO_INDEX;
+}
+
+void MonsterAI::addDue(const MonsterPtr& monster)
+{
+	const uint32_t index = monster->aiIndex;
+	if (index == NO_INDEX) {
+		return;
+	}
+
+	uint8_t& flag = flags[index];
+	flag &= ~(DUE_SUMMON | DUE_CAN_SUMMON);
+	if (monster->isSummon()) {
+		flag |= DUE_SUMMON;
+	} else if (monster->summons.size() < types[index]->info.maxSummons && monster->hasFollowPath) {
+		flag |= DUE_CAN_SUMMON;
+	}
+	due.push_back(monster);
+}
+
+void MonsterAI::think(uint32_t interval)
+{
+	if (due.empty()) {
+		return;
+	}
+
+	dueIndices.clear();
+	for (const auto& monster : due) {
+		if (monster->aiIndex != NO_INDEX && !monster->isRemoved()) {
+			dueIndices.push_back(monster->aiIndex);
+		}
+	}
+
+	thinkTarget(static_cast<int32_t>(interval));
+	thinkYell(interval);
+	thinkDefense(interval);
+	rollAttacks();
+	runActions();
+	due.clear();
+}
+
+std::optional<uint64_t> MonsterAI::takeAttackRolls(uint32_t index)
+{
+	if (index == NO_INDEX || !(flags[index] & ATTACK_ROLLED)) {
+		return std::nullopt;
+	}
+
+	flags[index] &= ~ATTACK_ROLLED;
+	return attackRolls[index];
+}
+
+void MonsterAI::challenge(uint32_t index)
+{
+	if (index == NO_INDEX) {
+		return;
+	}
+
+	targetChangeCooldown[index] = CHALLENGE_FOCUS_DURATION;
+	challengeFocus[index] = CHALLENGE_FOCUS_DURATION;
+	targetChangeTicks[index] = 0;
+}
+
+void MonsterAI::thinkTarget(int32_t interval)
+{
+	for (const uint32_t i : dueIndices) {
+		if ((flags[i] & DUE_SUMMON) || changeTargetSpeed[i] == 0) {
+			continue;
+		}
+
+		if (challengeFocus[i] > 0) {
+			challengeFocus[i] = std::max<int32_t>(0, challengeFocus[i] - interval);
+		}
+
+		if (targetChangeCooldown[i] > 0) {
+			targetChangeCooldown[i] -= interval;
+			if (targetChangeCooldown[i] > 0) {
+				continue;
+			}
+
+			targetChangeCooldown[i] = 0;
+			targetChangeTicks[i] = changeTargetSpeed[i];
+		}
+
+		targetChangeTicks[i] += interval;
+		if (targetChangeTicks[i] < changeTargetSpeed[i]) {
+			continue;
+		}
+
+		targetChangeTicks[i] = 0;
+		targetChangeCooldown[i] = static_cast<int32_t>(changeTargetSpeed[i]);
+		challengeFocus[i] = 0;
+
+		if (changeTargetChance[i] >= uniform_random(1, 100)) {
+			actions.push_back({monsters[i], ACTION_CHANGE_TARGET, 0});
+		}
+	}
+}
+
+void MonsterAI::thinkYell(uint32_t interval)
+{
+	for (const uint32_t i : dueIndices) {
+		if (yellSpeed[i] == 0) {
+			continue;
+		}
+
+		yellTicks[i] += interval;
+		if (yellTicks[i] < yellSpeed[i]) {
+			continue;
+		}
+
+		yellTicks[i] = 0;
+
+		const auto& voices = types[i]->info.voiceVector;
+		if (!voices.empty() && yellChance[i] >= static_cast<uint32_t>(uniform_random(1, 100))) {
+			actions.push_back({monsters[i], ACTION_YELL, static_cast<uint32_t>(uniform_random(0, voices.size() - 1))});
+		}
+	}
+}
+
+void MonsterAI::thinkDefense(uint32_t interval)
+{
+	for (const uint32_t i : dueIndices) {
+		const auto& info = types[i]->info;
+		bool resetTicks = true;
+		const uint32_t ticks = defenseTicks[i] += interval;
+
+		for (uint32_t spell = 0; spell < info.defenseSpells.size(); ++spell) {
+			const spellBlock_t& spellBlock = info.defenseSpells[spell];
+			if (spellBlock.speed > ticks) {
+				resetTicks = false;
+				continue;
+			}
+
+			if (ticks % spellBlock.speed >= interval) {
+				//already used this spell for this round
+				continue;
+			}
+
+			if (spellBlock.chance >= static_cast<uint32_t>(uniform_random(1, 100))) {
+				actions.push_back({monsters[i], ACTION_DEFENSE, spell});
+			}
+		}
+
+		if (flags[i] & DUE_CAN_SUMMON) {
+			for (uint32_t summon = 0; summon < info.summons.size(); ++summon) {
+				const summonBlock_t& summonBlock = info.summons[summon];
+				if (summonBlock.speed > ticks) {
+					resetTicks = false;
+					continue;
+				}
+
+				if (ticks % summonBlock.speed >= interval) {
+					//already used this spell for this round
+					continue;
+				}
+
+				// the summon limits are checked when the summon is placed
+				if (summonBlock.chance >= static_cast<uint32_t>(uniform_random(1, 100))) {
+					actions.push_back({monsters[i], ACTION_SUMMON, summon});
+				}
+			}
+		}
+
+		if (resetTicks) {
+			defenseTicks[i] = 0;
+		}
+	}
+}
+
+void MonsterAI::rollAttacks()
+{
+	for (const uint32_t i : dueIndices) {
+		const auto& spells = types[i]->info.attackSpells;
+		const size_t count = std::min(spells.size(), MAX_ROLLED_ATTACKS);
+
+		uint64_t rolls = 0;
+		for (size_t spell = 0; spell < count; ++spell) {
+			if (static_cast<uint32_t>(uniform_random(1, 100)) <= spells[spell].chance) {
+				rolls |= uint64_t{1} << spell;
+			}
+		}
+
+		attackRolls[i] = rolls;
+		flags[i] |= ATTACK_ROLLED;
+	}
+}
+
+void MonsterAI::runActions()
+{
+	for (const Action& action : actions) {
+		Monster* monster = action.monster;
+		if (monster->isRemoved() || monster->getHealth() <= 0) {
+			continue;
+		}
+
+		const auto& info = monster->mType->info;
+		switch (action.type) {
+			case ACTION_CHANGE_TARGET:
+				monster->changeTarget();
+				break;
+
+			case ACTION_YELL:
+				monster->yell(info.voiceVector[action.param]);
+				break;
+
+			case ACTION_DEFENSE:
+				monster->castDefense(info.defenseSpells[action.param]);
+				break;
+
+			case ACTION_SUMMON:
+				monster->trySummon(info.summons[action.param]);
+				break;
+		}
+	}
+	actions.clear();
+}
@@ -0,0 +1,116 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_MONSTERAI_H
+#define FS_MONSTERAI_H
+
+#include "declarations.h"
+
+class MonsterType;
+
+// Timers and chance rolls of every monster on the map, kept in parallel arrays
+// indexed by Monster::aiIndex. Monsters that think during a creature check slot
+// are queued as due, think() then advances their timers one decision at a
+// time over the whole batch and only calls back into Monster for the
+// decisions that came out of it (retarget, yell, defense spell, summon).
+class MonsterAI
+{
+	public:
+		static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+		void add(Monster& monster);
+		void remove(Monster& monster);
+
+		void addDue(const MonsterPtr& monster);
+		void think(uint32_t interval);
+
+		// attack spells whose chance passed in the last think, bit n stands for the n-th attack spell
+		std::optional<uint64_t> takeAttackRolls(uint32_t index);
+
+		uint32_t getAttackTicks(uint32_t index) const {
+			return index == NO_INDEX ? 0 : attackTicks[index];
+		}
+		void setAttackTicks(uint32_t index, uint32_t ticks) {
+			if (index != NO_INDEX) {
+				attackTicks[index] = ticks;
+			}
+		}
+
+		int32_t getChallengeFocus(uint32_t index) const {
+			return index == NO_INDEX ? 0 : challengeFocus[index];
+		}
+		void challenge(uint32_t index);
+
+		size_t size() const {
+			return monsters.size();
+		}
+
+	private:
+		enum ActionType_t : uint8_t {
+			ACTION_CHANGE_TARGET,
+			ACTION_YELL,
+			ACTION_DEFENSE,
+			ACTION_SUMMON,
+		};
+
+		enum DueFlag_t : uint8_t {
+			DUE_SUMMON = 1 << 0,
+			DUE_CAN_SUMMON = 1 << 1,
+			ATTACK_ROLLED = 1 << 2,
+		};
+
+		struct Action {
+			Monster* monster;
+			ActionType_t type;
+			uint32_t param;
+		};
+
+		template <typename F>
+		void forEachArray(F&& f) {
+			f(monsters);
+			f(types);
+			f(changeTargetSpeed);
+			f(changeTargetChance);
+			f(yellSpeed);
+			f(yellChance);
+			f(attackTicks);
+			f(defenseTicks);
+			f(yellTicks);
+			f(targetChangeTicks);
+			f(targetChangeCooldown);
+			f(challengeFocus);
+			f(attackRolls);
+			f(flags);
+		}
+
+		void thinkTarget(int32_t interval);
+		void thinkYell(uint32_t interval);
+		void thinkDefense(uint32_t interval);
+		void rollAttacks();
+		void runActions();
+
+		std::vector<Monster*> monsters;
+		std::vector<const MonsterType*> types;
+
+		// copied from the type, they are read for every due monster
+		std::vector<uint32_t> changeTargetSpeed;
+		std::vector<int32_t> changeTargetChance;
+		std::vector<uint32_t> yellSpeed;
+		std::vector<uint32_t> yellChance;
+
+		std::vector<uint32_t> attackTicks;
+		std::vector<uint32_t> defenseTicks;
+		std::vector<uint32_t> yellTicks;
+		std::vector<uint32_t> targetChangeTicks;
+		std::vector<int32_t> targetChangeCooldown;
+		std::vector<int32_t> challengeFocus;
+		std::vector<uint64_t> attackRolls;
+		std::vector<uint8_t> flags;
+
+		// due monsters keep the batch alive until its actions ran
+		std::vector<MonsterPtr> due;
+		std::vector<uint32_t> dueIndices;
+		std::vector<Action> actions;
+};
+
+#endif
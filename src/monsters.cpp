@@ -20,6 +20,31 @@ extern ConfigManager g_config;
 
 gtl::flat_hash_map<std::string, SkillRegistry> monster_skills;
 
+std::optional<uint8_t> parseFactionMask(std::string_view factions)
+{
+	uint8_t mask = 0;
+	for (auto name : explodeString(factions, ";")) {
+		std::string faction = asLowerCaseString(std::string(name));
+		trimString(faction);
+		if (faction == "all") {
+			mask = FACTION_MASK_ALL;
+		} else if (faction == "player") {
+			mask |= factionMask(FACTION_PLAYER);
+		} else if (faction == "playersummon") {
+			mask |= factionMask(FACTION_PLAYER_SUMMON);
+		} else if (faction == "wild") {
+			mask |= factionMask(FACTION_WILD);
+		} else if (faction == "monstersummon") {
+			mask |= factionMask(FACTION_MONSTER_SUMMON);
+		} else if (faction == "npc") {
+			mask |= factionMask(FACTION_NPC);
+		} else if (faction != "none") {
+			return std::nullopt;
+		}
+	}
+	return mask;
+}
+
 bool Monsters::addMonsterSkill(std::string monster_name, std::string_view skill_name, const std::shared_ptr<CustomSkill>& skill)
 {
 	auto& skillMap = monster_skills[monster_name];
@@ -981,6 +1006,18 @@ MonsterType* Monsters::loadMonster(const std::string& file, const std::string& m
 				mType->info.canWalkOnFire = attr.as_bool();
 			} else if (caseInsensitiveEqual(attrName, "canwalkonpoison")) {
 				mType->info.canWalkOnPoison = attr.as_bool();
+			} else if (caseInsensitiveEqual(attrName, "friendfactions")) {
+				if (const auto mask = parseFactionMask(attr.as_string())) {
+					mType->info.friendFactions = *mask;
+				} else {
+					std::cout << "[Warning - Monsters::loadMonster] Unknown faction in friendfactions: " << attr.as_string() << ". " << file << std::endl;
+				}
+			} else if (caseInsensitiveEqual(attrName, "opponentfactions")) {
+				if (const auto mask = parseFactionMask(attr.as_string())) {
+					mType->info.opponentFactions = *mask;
+				} else {
+					std::cout << "[Warning - Monsters::loadMonster] Unknown faction in opponentfactions: " << attr.as_string() << ". " << file << std::endl;
+				}
 			} else {
 				std::cout << "[Warning - Monsters::loadMonster] Unknown flag attribute: " << attrName << ". " << file << std::endl;
 			}
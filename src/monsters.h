@@ -8,6 +8,26 @@
 
 const uint32_t MAX_LOOTCHANCE = 100000;
 
+// Monsters decide who is a friend and who is a target by the faction of the
+// other creature, see Monster::getFaction.
+enum MonsterFaction_t : uint8_t {
+	FACTION_NONE, // players ignored by monsters
+	FACTION_PLAYER,
+	FACTION_PLAYER_SUMMON,
+	FACTION_WILD, // monsters that are nobody's summon
+	FACTION_MONSTER_SUMMON,
+	FACTION_NPC,
+};
+
+static constexpr uint8_t factionMask(MonsterFaction_t faction) {
+	return static_cast<uint8_t>(1 << faction);
+}
+
+static constexpr uint8_t FACTION_MASK_ALL = 0xFF;
+
+// "player;playersummon" -> mask of the named factions, "all" names every faction
+std::optional<uint8_t> parseFactionMask(std::string_view factions);
+
 extern	gtl::flat_hash_map<std::string, SkillRegistry> monster_skills;
 
 struct LootBlock {
@@ -153,6 +173,10 @@ class MonsterType
 		bool canWalkOnFire = true;
 		bool canWalkOnPoison = true;
 
+		// relations of the type, summons of players use their master's instead
+		uint8_t friendFactions = factionMask(FACTION_WILD);
+		uint8_t opponentFactions = factionMask(FACTION_PLAYER) | factionMask(FACTION_PLAYER_SUMMON);
+
 		MonstersEvent_t eventType = MONSTERS_EVENT_NONE;
 	};
 
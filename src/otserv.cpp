@@ -7,6 +7,7 @@
 
 #include "game.h"
 
+#include "ban.h"
 #include "iomarket.h"
 
 #include "configmanager.h"
@@ -40,6 +41,7 @@ Monsters g_monsters;
 Vocations g_vocations;
 extern Scripts* g_scripts;
 RSA g_RSA;
+extern Ban g_bans;
 
 std::mutex g_loaderLock;
 std::condition_variable g_loaderSignal;
@@ -365,6 +367,12 @@ void mainLoader(int, char*[], ServiceManager* services)
 		}
 	#endif
 
+	if (const int32_t randomSeed = g_config.getNumber(ConfigManager::RANDOM_SEED); randomSeed != 0)
+	{
+		setRandomSeed(static_cast<uint64_t>(randomSeed));
+		Console::printProgress("Random Seed", true, std::to_string(randomSeed));
+	}
+
 	try
 	{
 		g_RSA.loadPEM("key.pem");
@@ -396,11 +404,6 @@ void mainLoader(int, char*[], ServiceManager* services)
 	g_databaseTasks.start();
 	DatabaseManager::updateDatabase();
 
-	if (g_config.getBoolean(ConfigManager::OPTIMIZE_DATABASE) && !DatabaseManager::optimizeTables())
-	{
-		g_utility_boss.addTask(createTask([]() { Console::printWarning("No tables were optimized."); }));
-	}
-
 	// ========================================================================
 	// SERVER CONFIGURATION
 	// ========================================================================
@@ -504,13 +507,6 @@ void mainLoader(int, char*[], ServiceManager* services)
 	// todo: split this to show both counts individually
 	g_utility_boss.addTask(createTask([]() { Console::printProgress("Outfits", true, std::to_string(Outfits::getInstance().getOutfits(PLAYERSEX_FEMALE).size() +  Outfits::getInstance().getOutfits(PLAYERSEX_MALE).size())); }));
 
-	// Load guilds
-	IOGuild::loadGuilds();
-	g_utility_boss.addTask(createTask([]()
-	{ 
-		Console::printProgress("Guilds", true, std::to_string(g_game.getGuilds().size())); 
-	}));
-
 	// Load monsters
 	if (not g_monsters.loadFromXml())
 	{
@@ -591,9 +587,21 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.map.houses.payHouses(rentPeriod);
 
+	IOMarket::loadOffers();
 	IOMarket::checkExpiredOffers();
 	IOMarket::getInstance().updateStatistics();
 
+	g_bans.sweep();
+
+	if (!IOBan::load()) {
+		startupErrorMessage("Failed to load bans.");
+		return;
+	}
+	g_scheduler.addEvent(createSchedulerTask(IOBan::REFRESH_INTERVAL, &IOBan::refresh));
+
+	// guilds are loaded on first use
+	g_scheduler.addEvent(createSchedulerTask(IOGuild::EVICT_INTERVAL, &IOGuild::evictIdleGuilds));
+
 #ifndef _WIN32
 	if (getuid() == 0 || geteuid() == 0) {
 		Console::printWarning(std::string(STATUS_SERVER_NAME) + " has been executed as root user, please consider running it as a normal user.");
@@ -602,6 +610,10 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.start(services);
 	g_game.setGameState(GAME_STATE_NORMAL);
+
+	// data backfills and table maintenance run while the world is open
+	DatabaseManager::startBackfills();
+	DatabaseManager::scheduleOptimization();
 	g_loaderSignal.notify_all();
 }
 
@@ -15,6 +15,8 @@ namespace {
 const uint16_t OUTPUTMESSAGE_FREE_LIST_CAPACITY = 2048;
 const std::chrono::milliseconds OUTPUTMESSAGE_AUTOSEND_DELAY {10};
 
+std::function<void()> beforeAutosend;
+
 void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols);
 
 void scheduleSendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
@@ -25,6 +27,10 @@ void scheduleSendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
 void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
 {
 	//dispatcher thread
+	if (beforeAutosend) {
+		beforeAutosend();
+	}
+
 	for (auto& protocol : bufferedProtocols) {
 		auto& msg = protocol->getCurrentBuffer();
 		if (msg) {
@@ -58,6 +64,11 @@ void OutputMessagePool::removeProtocolFromAutosend(const Protocol_ptr& protocol)
 	}
 }
 
+void OutputMessagePool::setBeforeAutosend(std::function<void()> f)
+{
+	beforeAutosend = std::move(f);
+}
+
 OutputMessage_ptr OutputMessagePool::getOutputMessage()
 {
 	// LockfreePoolingAllocator<void,...> will leave (void* allocate) ill-formed because
@@ -27,9 +27,22 @@ class OutputMessage : public NetworkMessage
 			add_header(info.length);
 		}
 
-		void addCryptoHeader(bool addChecksum) {
+		// the high bit of the inner length tells the client the body is deflated
+		static constexpr MsgSize_t COMPRESSED_LENGTH_FLAG = 0x8000;
+
+		void writeCompressedMessageLength() {
+			add_header(static_cast<MsgSize_t>(info.length | COMPRESSED_LENGTH_FLAG));
+		}
+
+		void setBody(const uint8_t* data, MsgSize_t size) {
+			memcpy(buffer + outputBufferStart, data, size);
+			info.length = size;
+			info.position = outputBufferStart + size;
+		}
+
+		void addCryptoHeader(bool addChecksum, uint32_t checksum) {
 			if (addChecksum) {
-				add_header(adlerChecksum(buffer + outputBufferStart, info.length));
+				add_header(checksum);
 			}
 
 			writeMessageLength();
@@ -78,6 +91,9 @@ class OutputMessagePool
 
 		void addProtocolToAutosend(Protocol_ptr protocol);
 		void removeProtocolFromAutosend(const Protocol_ptr& protocol);
+
+		// runs on the dispatcher thread right before every autosend, to write out pending updates
+		void setBeforeAutosend(std::function<void()> f);
 	private:
 		OutputMessagePool() = default;
 		//NOTE: A vector is used here because this container is mostly read
@@ -0,0 +1,57 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "packetcapture.h"
+#include "configmanager.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+
+extern ConfigManager g_config;
+
+std::unique_ptr<PacketCapture> PacketCapture::open(uint32_t characterId, uint16_t clientVersion, uint16_t operatingSystem)
+{
+	const std::string& directory = g_config.getString(ConfigManager::PACKET_CAPTURE_DIRECTORY);
+	if (directory.empty()) {
+		return nullptr;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+
+	// several sessions of the same character can start within a second
+	static std::atomic<uint32_t> sessionCounter = 0;
+	const auto path = std::filesystem::path(directory) / fmt::format("{:d}-{:d}-{:d}.btpc", time(nullptr), characterId, ++sessionCounter);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "[Warning - PacketCapture::open] Unable to create " << path.string() << std::endl;
+		return nullptr;
+	}
+
+	const uint16_t header[] = {FORMAT_VERSION, clientVersion, operatingSystem};
+	file.write("BTPC", 4);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	return std::make_unique<PacketCapture>(std::move(file));
+}
+
+void PacketCapture::record(const uint8_t* data, size_t length)
+{
+	const auto now = std::chrono::steady_clock::now();
+	writeVarint(std::chrono::duration_cast<std::chrono::microseconds>(now - lastPacket).count());
+	writeVarint(length);
+	file.write(reinterpret_cast<const char*>(data), length);
+	lastPacket = now;
+}
+
+void PacketCapture::writeVarint(uint64_t value)
+{
+	while (value >= 0x80) {
+		file.put(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	file.put(static_cast<char>(value));
+}
@@ -0,0 +1,42 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PACKETCAPTURE_H
+#define FS_PACKETCAPTURE_H
+
+#include <fstream>
+
+/** Records the decrypted packets a game client sends during one session, so
+ * the session can be played back later by tools/replay.
+ *
+ * The file starts with "BTPC", the format version, the client version and the
+ * client operating system (all uint16, little endian). Every packet follows as
+ * a varint with the microseconds since the previous packet, a varint length and
+ * the packet itself, starting at its opcode.
+ */
+class PacketCapture
+{
+	public:
+		static constexpr uint16_t FORMAT_VERSION = 1;
+
+		/** Opens a capture file in packetCaptureDirectory.
+		 * \returns nullptr when capturing is disabled or the file can not be created
+		 */
+		static std::unique_ptr<PacketCapture> open(uint32_t characterId, uint16_t clientVersion, uint16_t operatingSystem);
+
+		explicit PacketCapture(std::ofstream&& file) : file(std::move(file)) {}
+
+		// non-copyable
+		PacketCapture(const PacketCapture&) = delete;
+		PacketCapture& operator=(const PacketCapture&) = delete;
+
+		void record(const uint8_t* data, size_t length);
+
+	private:
+		void writeVarint(uint64_t value);
+
+		std::ofstream file;
+		std::chrono::steady_clock::time_point lastPacket = std::chrono::steady_clock::now();
+};
+
+#endif
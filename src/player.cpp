@@ -1534,8 +1534,26 @@ bool Player::isNearDepotBox() const
 	return false;
 }
 
+void Player::loadDepotItems()
+{
+	if (!depotItemsPending) {
+		return;
+	}
+
+	depotItemsPending = false;
+	IOLoginData::loadDepotItems(getPlayer());
+}
+
+InboxPtr Player::getInbox()
+{
+	loadDepotItems();
+	return inbox;
+}
+
 DepotChestPtr Player::getDepotChest(uint32_t depotId, const bool autoCreate)
 {
+	loadDepotItems();
+
 	auto it = depotChests.find(depotId);
 	if (it != depotChests.end()) {
 		return it->second;
@@ -1558,6 +1576,7 @@ DepotChestPtr Player::getDepotChest(uint32_t depotId, const bool autoCreate)
 DepotLockerPtr& Player::getDepotLocker()
 {
 	if (!depotLocker) {
+		loadDepotItems();
 		depotLocker = std::make_shared<DepotLocker>(ITEM_LOCKER1);
 		depotLocker->internalAddThing(Item::CreateItem(ITEM_MARKET));
 		depotLocker->internalAddThing(inbox);
@@ -1577,6 +1596,11 @@ DepotLockerPtr& Player::getDepotLocker()
 
 uint32_t Player::getDepotItemCount()
 {
+	// counted in the database until the locker is opened, stepping next to a depot asks for this
+	if (depotItemsPending) {
+		return IOLoginData::getDepotItemCount(getGUID());
+	}
+
 	uint32_t counter = 0;
 
 	for (const auto item : getDepotLocker()->getItems(true)) {
@@ -1600,6 +1624,7 @@ uint32_t Player::getDepotItemCount()
 
 RewardChestPtr& Player::getRewardChest()
 {
+	loadDepotItems();
 	if (!rewardChest) {
 		rewardChest = std::make_shared<RewardChest>(ITEM_REWARD_CHEST);
 	}
@@ -1614,9 +1639,62 @@ void Player::sendCancelMessage(ReturnValue message) const
 void Player::sendStats()
 {
 	if (client) {
-		client->sendStats();
+		queueClientUpdate(CLIENT_UPDATE_STATS);
+	}
+}
+
+void Player::queueClientUpdate(uint8_t updates, uint16_t inventorySlots/* = 0*/)
+{
+	const bool queued = pendingClientUpdates != 0 || pendingInventorySlots != 0;
+	pendingClientUpdates |= updates;
+	pendingInventorySlots |= inventorySlots;
+	++clientUpdates.queued;
+
+	if (!queued) {
+		g_game.queueClientUpdates(getPlayer());
+	}
+}
+
+void Player::flushClientUpdates()
+{
+	const uint8_t updates = std::exchange(pendingClientUpdates, 0);
+	const uint16_t inventorySlots = std::exchange(pendingInventorySlots, 0);
+
+	if ((updates & CLIENT_UPDATE_LIGHT) && !isRemoved() && getTile()) {
+		g_game.changeLight(getPlayer());
+	}
+
+	if (!client) {
+		return;
+	}
+
+	auto count = [this](bool sent) {
+		if (sent) {
+			++clientUpdates.sent;
+		} else {
+			++clientUpdates.unchanged;
+		}
+	};
+
+	for (int32_t slot = CONST_SLOT_FIRST; slot <= CONST_SLOT_LAST; ++slot) {
+		if (inventorySlots & (1 << slot)) {
+			client->sendInventoryItem(static_cast<slots_t>(slot), inventory[slot]);
+			count(true);
+		}
+	}
+
+	if (updates & CLIENT_UPDATE_STATS) {
+		count(client->sendStats());
 		lastStatsTrainingTime = getOfflineTrainingTime() / 60 / 1000;
 	}
+
+	if (updates & CLIENT_UPDATE_SKILLS) {
+		count(client->sendSkills());
+	}
+
+	if (updates & CLIENT_UPDATE_ICONS) {
+		count(client->sendIcons(getClientIcons()));
+	}
 }
 
 void Player::sendPing()
@@ -1997,6 +2075,9 @@ void Player::onRemoveCreature(const CreaturePtr& creature, bool isLogout)
 
 		if (!saved) {
 			std::cout << "Error while saving player: " << getName() << std::endl;
+		} else if (not isAccountManager()) {
+			// kept for offline lookups once the removal has finished
+			g_dispatcher.addTask(createTask([player = this->getPlayer()]() { IOLoginData::hibernatePlayer(player); }));
 		}
 	}
 }
@@ -4080,7 +4161,7 @@ void Player::updateItemsLight(bool internal /*=false*/)
 		itemsLight = maxLight;
 
 		if (!internal) {
-			g_game.changeLight(this->getPlayer());
+			queueClientUpdate(CLIENT_UPDATE_LIGHT);
 		}
 	}
 }
@@ -5256,7 +5337,7 @@ uint16_t Player::getHelpers() const
 
 		const auto& my_party = getParty();
 
-		auto guildMembers = guild->getMembersOnline();
+		const auto& guildMembers = guild->getMembersOnline();
 		helperSet.insert(guildMembers.begin(), guildMembers.end());
 
 		auto partyMembers = my_party->getMembers();
@@ -5497,13 +5578,40 @@ void Player::setGuild(Guild_ptr guild)
 		this->guild = guild;
 		this->guildRank = rank;
 		guild->addMember(this->getPlayer());
+		saveGuildMembership();
 	}
 
 	if (oldGuild) {
 		oldGuild->removeMember(this->getPlayer());
+		oldGuild->eraseMember(guid);
+		if (!this->guild) {
+			IOGuild::deleteMember(guid);
+		}
 	}
 }
 
+void Player::setGuildRank(const GuildRank_ptr& newGuildRank)
+{
+	guildRank = newGuildRank;
+	saveGuildMembership();
+}
+
+void Player::setGuildNick(const std::string& nick)
+{
+	guildNick = nick;
+	saveGuildMembership();
+}
+
+void Player::saveGuildMembership() const
+{
+	if (!guild || !guildRank) {
+		return;
+	}
+
+	guild->setMember(guid, guildRank->id, guildNick);
+	IOGuild::saveMember(guild->getId(), guid, guildRank->id, guildNick);
+}
+
 void Player::updateRegeneration() const
 {
 	if (!vocation) {
@@ -5783,8 +5891,10 @@ void Player::addImbuementEffect(const std::shared_ptr<Imbuement>& imbue) {
 CreatureType_t Player::getCreatureType(const MonsterPtr& monster) const
 {
 	auto creatureType = CREATURETYPE_MONSTER;
-	if (monster->getFriendList().size() > 0) {
-		for (auto monsterFriend : monster->getFriendList()) {
+	// only summons of players have players as friends
+	const auto& master = monster->getMaster();
+	if (master && master->getPlayer()) {
+		for (const auto& monsterFriend : monster->getFriendList()) {
 			if (const auto& ally = monsterFriend->getPlayer()) {
 
 				if (ally->getGuild() && this->getGuild() && ally->getGuild() == this->getGuild()) {
@@ -6586,7 +6696,8 @@ Position Player::generateAttackPosition(std::optional<CreaturePtr> attacker, Pos
 	}
 
 	const size_t vectorSize = possibleTargets.size();
-	const size_t index = vectorSize ? (std::rand() % vectorSize) : 0;
+	assert(vectorSize <= std::numeric_limits<uint32_t>::max());
+	const size_t index = vectorSize ? getRandomGenerator().bounded(static_cast<uint32_t>(vectorSize)) : 0;
 	return vectorSize ? possibleTargets[index] : Spells::getCasterPosition(this->getPlayer(), getOppositeDirection(this->getDirection()));
 } 
 
@@ -6602,7 +6713,8 @@ std::unique_ptr<AreaCombat> Player::generateDeflectArea(std::optional<CreaturePt
 	case DIRECTION_WEST: {
 		const auto targetAreas = _StandardDeflectionMap.find(targetCount)->second;
 			if (!targetAreas.empty()) {
-				const auto index = std::rand() % targetAreas.size();
+				assert(targetAreas.size() <= std::numeric_limits<uint32_t>::max());
+				const auto index = getRandomGenerator().bounded(static_cast<uint32_t>(targetAreas.size()));
 				const auto area = targetAreas[index];
 				combatArea->setupArea(area, 5);
 			}
@@ -6613,7 +6725,8 @@ std::unique_ptr<AreaCombat> Player::generateDeflectArea(std::optional<CreaturePt
 	case DIRECTION_NORTHWEST:
 	case DIRECTION_NORTHEAST: {
 		if (const auto targetAreas = _DiagonalDeflectionMap.find(targetCount)->second; !targetAreas.empty()) {
-			const auto index = std::rand() % targetAreas.size();
+			assert(targetAreas.size() <= std::numeric_limits<uint32_t>::max());
+			const auto index = getRandomGenerator().bounded(static_cast<uint32_t>(targetAreas.size()));
 			const auto area = targetAreas[index];
 			combatArea->setupExtArea(area, 5);
 		}
@@ -93,6 +93,20 @@ static constexpr SlotPositionBits getPositionForSlot(slots_t constSlot) {
 	}
 }
 
+// client updates that are collected during a dispatcher batch and sent once at its end
+enum ClientUpdate_t : uint8_t {
+	CLIENT_UPDATE_STATS = 1 << 0,
+	CLIENT_UPDATE_SKILLS = 1 << 1,
+	CLIENT_UPDATE_ICONS = 1 << 2,
+	CLIENT_UPDATE_LIGHT = 1 << 3,
+};
+
+struct ClientUpdateCounters {
+	uint64_t queued = 0;
+	uint64_t sent = 0;
+	uint64_t unchanged = 0;
+};
+
 struct VIPEntry {
 	VIPEntry(uint32_t guid, std::string_view name, std::string_view description, uint32_t icon, bool notify) : guid{ guid }, name{ name }, description{ description }, icon{ icon }, notify{ notify } {}
 
@@ -273,17 +287,13 @@ class Player final : public Creature, public Cylinder
 			return guildRank;
 		}
 	
-		void setGuildRank(const GuildRank_ptr& newGuildRank) {
-			guildRank = newGuildRank;
-		}
+		void setGuildRank(const GuildRank_ptr& newGuildRank);
 
 		const std::string& getGuildNick() const {
 			return guildNick;
 		}
 	
-		void setGuildNick(const std::string& nick) {
-			guildNick = nick;
-		}
+		void setGuildNick(const std::string& nick);
 
 		void setLastWalkthroughAttempt(int64_t walkthroughAttempt) {
 			lastWalkthroughAttempt = walkthroughAttempt;
@@ -293,9 +303,7 @@ class Player final : public Creature, public Cylinder
 			lastWalkthroughPosition = walkthroughPosition;
 		}
 
-		InboxPtr getInbox() const {
-			return inbox;
-		}
+		InboxPtr getInbox();
 
 		StoreInboxPtr getStoreInbox() const {
 			return storeInbox;
@@ -608,6 +616,8 @@ class Player final : public Creature, public Cylinder
 		void addConditionSuppressions(uint32_t conditions);
 		void removeConditionSuppressions(uint32_t conditions);
 
+		// reads the depot chests, inbox and reward chest of a player loaded from the database, they are left out at login
+		void loadDepotItems();
 		DepotChestPtr getDepotChest(uint32_t depotId, bool autoCreate);
 		DepotLockerPtr& getDepotLocker();
 		uint32_t getDepotItemCount();
@@ -1017,10 +1027,18 @@ class Player final : public Creature, public Cylinder
 		}
 
 		//inventory
-		void sendInventoryItem(slots_t slot, const ItemConstPtr& item) const {
-			if (client) {
+		void sendInventoryItem(slots_t slot, const ItemConstPtr& item) {
+			if (!client) {
+				return;
+			}
+
+			if (slot < CONST_SLOT_FIRST || slot > CONST_SLOT_LAST) {
 				client->sendInventoryItem(slot, item);
+				return;
 			}
+
+			// the slot is sent with whatever it holds when the batch ends
+			queueClientUpdate(0, 1 << slot);
 		}
 	
 		void sendItems() const {
@@ -1134,9 +1152,9 @@ class Player final : public Creature, public Cylinder
 	
 		void sendClosePrivate(uint16_t channelId);
 	
-		void sendIcons() const {
+		void sendIcons() {
 			if (client) {
-				client->sendIcons(getClientIcons());
+				queueClientUpdate(CLIENT_UPDATE_ICONS);
 			}
 		}
 	
@@ -1145,6 +1163,11 @@ class Player final : public Creature, public Cylinder
 				client->sendMagicEffect(pos, type);
 			}
 		}
+		void sendMagicEffects(const std::vector<Position>& positions, uint8_t type) const {
+			if (client) {
+				client->sendMagicEffects(positions, type);
+			}
+		}
 	
 		void sendPing();
 	
@@ -1174,11 +1197,17 @@ class Player final : public Creature, public Cylinder
 			}
 		}
 	
-		void sendSkills() const {
+		void sendSkills() {
 			if (client) {
-				client->sendSkills();
+				queueClientUpdate(CLIENT_UPDATE_SKILLS);
 			}
 		}
+
+		// sends what was queued by sendStats, sendSkills, sendIcons, sendInventoryItem and updateItemsLight
+		void flushClientUpdates();
+		const ClientUpdateCounters& getClientUpdateCounters() const {
+			return clientUpdates;
+		}
 	
 		void sendTextMessage(MessageClasses mclass, const std::string& message) const {
 			if (client) {
@@ -1536,6 +1565,9 @@ class Player final : public Creature, public Cylinder
 
 		void updateInventoryWeight();
 
+		// writes guild, rank and nick through to the guild cache and the database
+		void saveGuildMembership() const;
+
 		void setNextWalkActionTask(SchedulerTask* task);
 		void setNextActionTask(SchedulerTask* task, bool resetIdleTime = true);
 
@@ -1575,6 +1607,7 @@ class Player final : public Creature, public Cylinder
 
 		std::map<uint8_t, OpenContainer> openContainers;
 		std::map<uint32_t, DepotChestPtr> depotChests;
+		bool depotItemsPending = false;
 		gtl::btree_map<uint32_t, int32_t> storageMap;
 
 		std::vector<std::shared_ptr<Augment>> augments;
@@ -1667,6 +1700,9 @@ class Player final : public Creature, public Cylinder
 		int32_t idleTime = 0;
 
 		uint16_t lastStatsTrainingTime = 0;
+		uint16_t pendingInventorySlots = 0;
+		uint8_t pendingClientUpdates = 0;
+		ClientUpdateCounters clientUpdates;
 		uint16_t staminaMinutes = 2520;
 		uint16_t maxWriteLen = 0;
 
@@ -1698,6 +1734,7 @@ class Player final : public Creature, public Cylinder
 		static uint32_t playerAutoID;
 
 		void updateItemsLight(bool internal = false);
+		void queueClientUpdate(uint8_t updates, uint16_t inventorySlots = 0);
 		int32_t getStepSpeed() const override;
 		void updateBaseSpeed();
 
@@ -1734,6 +1771,7 @@ class Player final : public Creature, public Cylinder
 		friend class Actions;
 		friend class IOLoginData;
 		friend class ProtocolGame;
+		friend class Simulation;
 };
 
 #endif
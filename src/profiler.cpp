@@ -0,0 +1,67 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "profiler.h"
+
+std::atomic_bool Profiler::enabled{false};
+
+namespace {
+
+std::array<std::atomic<uint64_t>, Profiler::SUBSYSTEMS> profileNanoseconds{};
+std::array<std::atomic<uint64_t>, Profiler::SUBSYSTEMS> profileCalls{};
+
+// the subsystem currently charged on this thread and since when
+thread_local int8_t profileCurrent = -1;
+thread_local std::chrono::steady_clock::time_point profileSince;
+
+void chargeCurrent(std::chrono::steady_clock::time_point now)
+{
+	if (profileCurrent >= 0) {
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - profileSince).count();
+		profileNanoseconds[profileCurrent].fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+	}
+	profileSince = now;
+}
+
+}
+
+void Profiler::enter(Subsystem subsystem, int8_t& previous)
+{
+	chargeCurrent(std::chrono::steady_clock::now());
+	previous = profileCurrent;
+	profileCurrent = static_cast<int8_t>(subsystem);
+	profileCalls[profileCurrent].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profiler::leave(int8_t previous)
+{
+	chargeCurrent(std::chrono::steady_clock::now());
+	profileCurrent = previous;
+}
+
+Profiler::Totals Profiler::getTotals()
+{
+	Totals totals;
+	for (size_t i = 0; i < SUBSYSTEMS; ++i) {
+		totals.nanoseconds[i] = profileNanoseconds[i].load(std::memory_order_relaxed);
+		totals.calls[i] = profileCalls[i].load(std::memory_order_relaxed);
+	}
+	return totals;
+}
+
+const char* Profiler::getName(Subsystem subsystem)
+{
+	switch (subsystem) {
+		case Subsystem::CreatureThink: return "creature think";
+		case Subsystem::CreatureWalk: return "creature walk";
+		case Subsystem::Combat: return "combat";
+		case Subsystem::Conditions: return "conditions";
+		case Subsystem::Pathfinding: return "pathfinding";
+		case Subsystem::Decay: return "decay";
+		case Subsystem::Spawns: return "spawns";
+		case Subsystem::Scripts: return "scripts";
+		default: return "unknown";
+	}
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PROFILER_H
+#define FS_PROFILER_H
+
+#include <array>
+#include <atomic>
+
+enum class Subsystem : uint8_t {
+	CreatureThink,
+	CreatureWalk,
+	Combat,
+	Conditions,
+	Pathfinding,
+	Decay,
+	Spawns,
+	Scripts,
+
+	Count
+};
+
+/** CPU time per game subsystem, disabled unless enabled explicitly. Time is
+ * exclusive: a subsystem entered from another one pauses the outer clock, so
+ * a Lua callback inside a monster think is only counted as Scripts.
+ */
+class Profiler
+{
+	public:
+		static constexpr size_t SUBSYSTEMS = static_cast<size_t>(Subsystem::Count);
+
+		struct Totals
+		{
+			std::array<uint64_t, SUBSYSTEMS> nanoseconds{};
+			std::array<uint64_t, SUBSYSTEMS> calls{};
+		};
+
+		static void setEnabled(bool value) {
+			enabled.store(value, std::memory_order_relaxed);
+		}
+		static bool isEnabled() {
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		static Totals getTotals();
+		static const char* getName(Subsystem subsystem);
+
+	private:
+		static void enter(Subsystem subsystem, int8_t& previous);
+		static void leave(int8_t previous);
+
+		static std::atomic_bool enabled;
+
+		friend class ProfileScope;
+};
+
+class ProfileScope
+{
+	public:
+		explicit ProfileScope(Subsystem subsystem) {
+			if (Profiler::isEnabled()) [[unlikely]] {
+				active = true;
+				Profiler::enter(subsystem, previous);
+			}
+		}
+		~ProfileScope() {
+			if (active) [[unlikely]] {
+				Profiler::leave(previous);
+			}
+		}
+
+		// non-copyable
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		int8_t previous = -1;
+		bool active = false;
+};
+
+#endif
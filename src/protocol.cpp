@@ -7,12 +7,20 @@
 #include "outputmessage.h"
 #include "rsa.h"
 #include "xtea.h"
+#include "configmanager.h"
 
 extern RSA g_RSA;
+extern ConfigManager g_config;
 
 namespace {
 
-void XTEA_encrypt(OutputMessage& msg, const xtea::round_keys& key)
+std::atomic<uint64_t> compressedPackets = 0;
+std::atomic<uint64_t> compressedBytesIn = 0;
+std::atomic<uint64_t> compressedBytesOut = 0;
+std::atomic<uint64_t> compressionMicroseconds = 0;
+
+// returns the checksum of the encrypted message when one is requested
+uint32_t XTEA_encrypt(OutputMessage& msg, const xtea::round_keys& key, bool checksum)
 {
 	// The message must be a multiple of 8
 	size_t paddingBytes = msg.getLength() % 8u;
@@ -21,7 +29,12 @@ void XTEA_encrypt(OutputMessage& msg, const xtea::round_keys& key)
 	}
 
 	uint8_t* buffer = msg.getOutputBuffer();
+	if (checksum) {
+		return xtea::encrypt_checksum(buffer, msg.getLength(), key);
+	}
+
 	xtea::encrypt(buffer, msg.getLength(), key);
+	return 0;
 }
 
 bool XTEA_decrypt(NetworkMessage& msg, const xtea::round_keys& key)
@@ -44,14 +57,85 @@ bool XTEA_decrypt(NetworkMessage& msg, const xtea::round_keys& key)
 
 }
 
+Protocol::~Protocol()
+{
+	if (deflateStream) {
+		deflateEnd(deflateStream.get());
+	}
+}
+
+bool Protocol::compress(OutputMessage& msg) const
+{
+	const auto length = msg.getLength();
+	if (length < static_cast<uint32_t>(g_config.getNumber(ConfigManager::PACKET_COMPRESSION_THRESHOLD))) {
+		return false;
+	}
+
+	if (!deflateStream) {
+		auto stream = std::make_unique<z_stream>();
+		const int level = std::clamp<int>(g_config.getNumber(ConfigManager::PACKET_COMPRESSION_LEVEL), Z_BEST_SPEED, Z_BEST_COMPRESSION);
+		// raw deflate, the client keeps the matching inflate stream for the whole session
+		if (deflateInit2(stream.get(), level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			compressionEnabled = false;
+			return false;
+		}
+		deflateStream = std::move(stream);
+	}
+
+	// packets the stream has seen can no longer be sent uncompressed, so anything
+	// that might not fit back into the message once deflated is skipped up front
+	// (Z_SYNC_FLUSH adds up to 6 bytes on top of deflateBound)
+	z_stream* stream = deflateStream.get();
+	if (deflateBound(stream, length) + 6 > NetworkMessage::MAX_BODY_LENGTH) {
+		return false;
+	}
+
+	static thread_local uint8_t compressed[NetworkMessage::MAX_BODY_LENGTH];
+
+	const auto start = std::chrono::steady_clock::now();
+	stream->next_in = msg.getOutputBuffer();
+	stream->avail_in = length;
+	stream->next_out = compressed;
+	stream->avail_out = sizeof(compressed);
+	if (deflate(stream, Z_SYNC_FLUSH) != Z_OK || stream->avail_in != 0) {
+		// the client stream is out of sync now, nothing sensible can be sent anymore
+		disconnect();
+		return false;
+	}
+
+	const auto compressedLength = static_cast<NetworkMessage::MsgSize_t>(sizeof(compressed) - stream->avail_out);
+	msg.setBody(compressed, compressedLength);
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	compressedPackets.fetch_add(1, std::memory_order_relaxed);
+	compressedBytesIn.fetch_add(length, std::memory_order_relaxed);
+	compressedBytesOut.fetch_add(compressedLength, std::memory_order_relaxed);
+	compressionMicroseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+	return true;
+}
+
+PacketCompressionStats Protocol::getCompressionStats()
+{
+	PacketCompressionStats stats;
+	stats.packets = compressedPackets.load(std::memory_order_relaxed);
+	stats.bytesIn = compressedBytesIn.load(std::memory_order_relaxed);
+	stats.bytesOut = compressedBytesOut.load(std::memory_order_relaxed);
+	stats.microseconds = compressionMicroseconds.load(std::memory_order_relaxed);
+	return stats;
+}
+
 void Protocol::onSendMessage(const OutputMessage_ptr& msg) const
 {
 	if (!rawMessages) {
-		msg->writeMessageLength();
+		if (compressionEnabled && compress(*msg)) {
+			msg->writeCompressedMessageLength();
+		} else {
+			msg->writeMessageLength();
+		}
 
 		if (encryptionEnabled) {
-			XTEA_encrypt(*msg, key);
-			msg->addCryptoHeader(checksumEnabled);
+			const uint32_t checksum = XTEA_encrypt(*msg, key, checksumEnabled);
+			msg->addCryptoHeader(checksumEnabled, checksum);
 		}
 	}
 }
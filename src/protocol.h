@@ -4,17 +4,29 @@
 #ifndef FS_PROTOCOL_H
 #define FS_PROTOCOL_H
 
+#include <atomic>
 #include <zlib.h>
 #include "connection.h"
 #include "xtea.h"
 #include "networkopcodes.h"
 
+/** Totals of the work done by the outgoing packet compression since startup,
+ * used to tune packetCompressionThreshold and packetCompressionLevel.
+ */
+struct PacketCompressionStats
+{
+	uint64_t packets = 0;
+	uint64_t bytesIn = 0;
+	uint64_t bytesOut = 0;
+	uint64_t microseconds = 0;
+};
+
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
 	public:
 		// todo: use reference for connections
 		explicit Protocol(Connection_ptr connection) : connection(connection) {}
-		virtual ~Protocol() = default;
+		virtual ~Protocol();
 
 		// non-copyable
 		Protocol(const Protocol&) = delete;
@@ -37,6 +49,8 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 
 		uint32_t getIP() const;
 
+		static PacketCompressionStats getCompressionStats();
+
 		//Use this function for autosend messages only
 		OutputMessage_ptr getOutputBuffer(int32_t size);
 
@@ -69,6 +83,14 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 			checksumEnabled = false;
 		}
 
+		/** Starts deflating outgoing packets of at least packetCompressionThreshold bytes.
+		 * Compressed packets are flagged with the high bit of the inner length header,
+		 * so the client can tell them apart from the packets left uncompressed.
+		 */
+		void enableCompression() {
+			compressionEnabled = true;
+		}
+
 		static bool RSA_decrypt(NetworkMessage& msg);
 
 		void setRawMessages(bool value) {
@@ -80,6 +102,8 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 	private:
 		friend class Connection;
 
+		bool compress(OutputMessage& msg) const;
+
 		OutputMessage_ptr outputBuffer;
 
 		const ConnectionWeak_ptr connection;
@@ -87,6 +111,9 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 		bool encryptionEnabled = false;
 		bool checksumEnabled = true;
 		bool rawMessages = false;
+		mutable std::atomic_bool compressionEnabled = false;
+		// only touched from onSendMessage, which the connection serializes
+		mutable std::unique_ptr<z_stream> deflateStream;
 };
 
 #endif
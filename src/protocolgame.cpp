@@ -37,6 +37,10 @@ namespace
 	std::deque<std::pair<int64_t, uint32_t>> waitList; // (timeout, player guid)
 	auto priorityEnd = waitList.end();
 
+	// extended opcode reserved to negotiate packet compression with OTClient
+	constexpr uint8_t COMPRESSION_OPCODE = 0xFD;
+	constexpr std::string_view COMPRESSION_METHOD = "deflate";
+
 	auto findClient(uint32_t guid) 
 	{
 		std::size_t slot = 1;
@@ -420,6 +424,16 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 		opcodeMessage.add(CommonCode::Zero); // uint8_t -- 1 byte width
 		opcodeMessage.add<SpecialCode>(SpecialCode::Zero); // uint16_t -- 2 byte width
 		writeToOutputBuffer(opcodeMessage);
+
+		// the client answers with the same opcode when it wants compressed packets
+		if (g_config.getBoolean(ConfigManager::PACKET_COMPRESSION))
+		{
+			NetworkMessage compressionMessage;
+			compressionMessage.add(ServerCode::ExtendedOpcode);
+			compressionMessage.addByte(COMPRESSION_OPCODE);
+			compressionMessage.addString(COMPRESSION_METHOD);
+			writeToOutputBuffer(compressionMessage);
+		}
 	}
 
 	msg.skipBytes(1); // gamemaster flag
@@ -515,6 +529,7 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 		return;
 	}
 
+	capture = PacketCapture::open(characterId, version, operatingSystem);
 	g_dispatcher.addTask([=, thisPtr = getThis()]() { thisPtr->login(characterId, accountId, operatingSystem); });
 }
 
@@ -561,8 +576,25 @@ void ProtocolGame::writeToOutputBuffer(const NetworkMessage& msg)
 	out->append(msg);
 }
 
+bool ProtocolGame::writeIfChanged(const NetworkMessage& msg, std::string& lastWritten)
+{
+	const std::string_view body(reinterpret_cast<const char*>(msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION), msg.getLength());
+	if (body == lastWritten) {
+		return false;
+	}
+
+	lastWritten = body;
+	writeToOutputBuffer(msg);
+	return true;
+}
+
 void ProtocolGame::parsePacket(NetworkMessage& msg)
 {
+	if (capture)
+	{
+		capture->record(msg.getBuffer() + msg.getBufferPosition(), msg.getLength());
+	}
+
 	if (not acceptPackets or g_game.getGameState() == GAME_STATE_SHUTDOWN or msg.getLength() == 0)
 	{
 		return;
@@ -1622,11 +1654,11 @@ void ProtocolGame::sendReLoginWindow(uint8_t unfairFightReduction)
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendStats()
+bool ProtocolGame::sendStats()
 {
 	NetworkMessage msg;
 	AddPlayerStats(msg);
-	writeToOutputBuffer(msg);
+	return writeIfChanged(msg, lastStats);
 }
 
 void ProtocolGame::sendBasicData()
@@ -1782,12 +1814,12 @@ void ProtocolGame::sendChannelMessage(const std::string& author, const std::stri
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendIcons(uint16_t icons)
+bool ProtocolGame::sendIcons(uint16_t icons)
 {
 	NetworkMessage msg;
 	msg.add(ServerCode::Icons);
 	msg.add<uint16_t>(icons);
-	writeToOutputBuffer(msg);
+	return writeIfChanged(msg, lastIcons);
 }
 
 void ProtocolGame::sendContainer(uint8_t cid, const ContainerConstPtr& container, bool hasParent, uint16_t firstIndex)
@@ -1971,6 +2003,7 @@ void ProtocolGame::sendMarketEnter()
 	player->setInMarket(true);
 
 	std::map<uint16_t, uint32_t> depotItems;
+	player->loadDepotItems();
 	std::forward_list<ContainerPtr> containerList{ player->getInbox() };
 
 	for (const auto& chest : player->depotChests)
@@ -2775,11 +2808,11 @@ void ProtocolGame::sendCancelWalk()
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendSkills()
+bool ProtocolGame::sendSkills()
 {
 	NetworkMessage msg;
 	AddPlayerSkills(msg);
-	writeToOutputBuffer(msg);
+	return writeIfChanged(msg, lastSkills);
 }
 
 void ProtocolGame::sendPing()
@@ -2819,6 +2852,24 @@ void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type)
 	writeToOutputBuffer(msg);
 }
 
+void ProtocolGame::sendMagicEffects(const std::vector<Position>& positions, uint8_t type)
+{
+	NetworkMessage msg;
+	for (const Position& pos : positions) {
+		if (not canSee(pos)) {
+			continue;
+		}
+
+		msg.add(ServerCode::MagicEffect);
+		msg.addPosition(pos);
+		msg.addByte(type);
+	}
+
+	if (msg.getLength() != 0) {
+		writeToOutputBuffer(msg);
+	}
+}
+
 void ProtocolGame::sendCreatureHealth(const CreatureConstPtr& creature)
 {
 	NetworkMessage msg;
@@ -3866,6 +3917,13 @@ void ProtocolGame::parseExtendedOpcode(NetworkMessage& msg)
 	uint8_t opcode = msg.getByte();
 	auto buffer = msg.getString();
 
+	if (opcode == COMPRESSION_OPCODE) {
+		if (buffer == COMPRESSION_METHOD && g_config.getBoolean(ConfigManager::PACKET_COMPRESSION) && player->getOperatingSystem() >= CLIENTOS_OTCLIENT_LINUX) {
+			enableCompression();
+		}
+		return;
+	}
+
 	// process additional opcodes via lua script event
 	addGameTask([=, playerID = player->getID(), buffer = std::string{ buffer }]() { g_game.parsePlayerExtendedOpcode(playerID, opcode, buffer); });
 }
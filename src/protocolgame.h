@@ -8,6 +8,7 @@
 #include "chat.h"
 #include "creature.h"
 #include "tasks.h"
+#include "packetcapture.h"
 
 class NetworkMessage;
 class Player;
@@ -64,6 +65,8 @@ class ProtocolGame final : public Protocol
 		void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
 		void disconnectClient(const std::string& message) const;
 		void writeToOutputBuffer(const NetworkMessage& msg);
+		// skips the message if it is the same as the last one written through the same cache
+		bool writeIfChanged(const NetworkMessage& msg, std::string& lastWritten);
 
 		void release() override;
 
@@ -158,13 +161,14 @@ class ProtocolGame final : public Protocol
 		void sendOpenPrivateChannel(const std::string& receiver);
 		void sendToChannel(const CreatureConstPtr& creature, SpeakClasses type, const std::string& text, uint16_t channelId);
 		void sendPrivateMessage(const PlayerConstPtr& speaker, SpeakClasses type, const std::string& text);
-		void sendIcons(uint16_t icons);
+		bool sendIcons(uint16_t icons);
 		void sendFYIBox(const std::string& message);
 
 		void sendDistanceShoot(const Position& from, const Position& to, uint8_t type);
 		void sendMagicEffect(const Position& pos, uint8_t type);
+		void sendMagicEffects(const std::vector<Position>& positions, uint8_t type);
 		void sendCreatureHealth(const CreatureConstPtr& creature);
-		void sendSkills();
+		bool sendSkills();
 		void sendPing();
 		void sendPingBack();
 		void sendCreatureTurn(const CreatureConstPtr& creature, uint32_t stackPos);
@@ -177,7 +181,7 @@ class ProtocolGame final : public Protocol
 		void sendChangeSpeed(const CreatureConstPtr& creature, uint32_t speed);
 		void sendCancelTarget();
 		void sendCreatureOutfit(const CreatureConstPtr& creature, const Outfit_t& outfit);
-		void sendStats();
+		bool sendStats();
 		void sendBasicData();
 		void sendTextMessage(const TextMessage& message);
 		void sendReLoginWindow(uint8_t unfairFightReduction);
@@ -368,7 +372,11 @@ class ProtocolGame final : public Protocol
 		}
 
 		std::unordered_set<uint32_t> knownCreatureSet;
+		std::unique_ptr<PacketCapture> capture;
 		PlayerPtr player = nullptr;
+		std::string lastStats;
+		std::string lastSkills;
+		std::string lastIcons;
 		std::string account_name{};
 		std::string account_password{};
 		std::string character_name{};
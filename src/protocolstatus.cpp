@@ -23,6 +23,7 @@ enum RequestedInfo_t : uint16_t {
 	REQUEST_EXT_PLAYERS_INFO = 1 << 5,
 	REQUEST_PLAYER_STATUS_INFO = 1 << 6,
 	REQUEST_SERVER_SOFTWARE_INFO = 1 << 7,
+	REQUEST_PERFORMANCE_INFO = 1 << 8,
 };
 
 void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
@@ -208,6 +209,18 @@ void ProtocolStatus::sendInfo(uint16_t requestedInfo, const std::string& charact
 		output->addString(STATUS_SERVER_VERSION);
 		output->addString(CLIENT_VERSION_STR);
 	}
+
+	// the status protocol has no authentication, the load counters are only shared when configured
+	if ((requestedInfo & REQUEST_PERFORMANCE_INFO) && g_config.getBoolean(ConfigManager::STATUS_PERFORMANCE_INFO)) {
+		output->addByte(0x24); // dispatcher totals, read by the replay tool
+		const DispatcherStats stats = g_dispatcher.getStats();
+		output->add<uint64_t>(stats.ticks);
+		output->add<uint64_t>(stats.tasks);
+		output->add<uint64_t>(stats.busyMicroseconds);
+		output->add<uint64_t>(stats.maxTickMicroseconds);
+		output->add<uint64_t>(stats.waitMicroseconds);
+		output->add<uint64_t>(stats.maxWaitMicroseconds);
+	}
 	send(std::move(output));
 	disconnect();
 }
@@ -19,6 +19,8 @@ class RSA
 
 		void loadPEM(const std::string& filename);
 		void decrypt(char* msg) const;
+		// public key operation, only needed by the client side in tools/
+		void encrypt(char* msg) const;
 
 	private:
 		CryptoPP::RSA::PrivateKey pk;
@@ -4,6 +4,7 @@
 #include "otpch.h"
 
 #include "scheduler.h"
+#include "tools.h"
 #include <boost/asio/post.hpp>
 #include <memory>
 
@@ -14,6 +15,13 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 		task->setEventId(++lastEventId);
 	}
 
+	if (simulated) {
+		const int64_t due = simulatedTime + task->getDelay();
+		simulatedEvents.emplace(std::make_pair(due, task->getEventId()), task);
+		simulatedEventTimes[task->getEventId()] = due;
+		return task->getEventId();
+	}
+
 	boost::asio::post(io_context, [this, task]() {
 		// insert the event id in the list of active events
 		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
@@ -42,6 +50,16 @@ void Scheduler::stopEvent(uint32_t eventId)
 		return;
 	}
 
+	if (simulated) {
+		if (auto it = simulatedEventTimes.find(eventId); it != simulatedEventTimes.end()) {
+			auto event = simulatedEvents.find(std::make_pair(it->second, eventId));
+			delete event->second;
+			simulatedEvents.erase(event);
+			simulatedEventTimes.erase(it);
+		}
+		return;
+	}
+
 	boost::asio::post(io_context, [this, eventId]() {
 		// search the event id
 		auto it = eventIdTimerMap.find(eventId);
@@ -54,6 +72,15 @@ void Scheduler::stopEvent(uint32_t eventId)
 void Scheduler::shutdown()
 {
 	setState(THREAD_STATE_TERMINATED);
+	if (simulated) {
+		for (auto& it : simulatedEvents) {
+			delete it.second;
+		}
+		simulatedEvents.clear();
+		simulatedEventTimes.clear();
+		return;
+	}
+
 	boost::asio::post(io_context, [this]() {
 		// cancel all active timers
 		for (auto& it : eventIdTimerMap) {
@@ -64,6 +91,35 @@ void Scheduler::shutdown()
 	});
 }
 
+void Scheduler::startSimulation(int64_t startTime)
+{
+	setState(THREAD_STATE_RUNNING);
+	simulated = true;
+	simulatedTime = startTime;
+	setSimulatedTime(startTime);
+}
+
+bool Scheduler::runNextEvent(int64_t until)
+{
+	auto it = simulatedEvents.begin();
+	if (it == simulatedEvents.end() || it->first.first > until) {
+		simulatedTime = until;
+		setSimulatedTime(until);
+		return false;
+	}
+
+	const auto [due, eventId] = it->first;
+
+	SchedulerTask* task = it->second;
+	simulatedEvents.erase(it);
+	simulatedEventTimes.erase(eventId);
+
+	simulatedTime = due;
+	setSimulatedTime(due);
+	g_dispatcher.addTask(task);
+	return true;
+}
+
 SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f)
 {
 	return new SchedulerTask(delay, std::move(f));
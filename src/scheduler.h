@@ -45,10 +45,28 @@ class Scheduler : public ThreadHolder<Scheduler>
 
 		void shutdown();
 
+		/** Switches to simulated time instead of starting the thread: events
+		 * wait in a queue ordered by due time until runNextEvent hands them to
+		 * the dispatcher. Used by the offline simulator, single threaded only.
+		 */
+		void startSimulation(int64_t startTime);
+		/** Advances the simulated time to the next due event and queues it in
+		 * the dispatcher. Returns false when no event is due up to the given
+		 * time, the clock then stands at that time.
+		 */
+		bool runNextEvent(int64_t until);
+
 		void threadMain() { io_context.run(); }
 	private:
 		std::atomic<uint32_t> lastEventId{0};
 		gtl::node_hash_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
+
+		// simulated time, events are ordered by due time and then by id so runs are repeatable
+		bool simulated = false;
+		int64_t simulatedTime = 0;
+		std::map<std::pair<int64_t, uint32_t>, SchedulerTask*> simulatedEvents;
+		gtl::flat_hash_map<uint32_t, int64_t> simulatedEventTimes;
+
 		boost::asio::io_context io_context;
 		boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{ io_context.get_executor() };
 };
@@ -93,8 +93,9 @@ void ServicePort::onAccept(const Connection_ptr& connection, const boost::system
 			return;
 		}
 
-		auto remote_ip = connection->getIP();
-		if (remote_ip != 0 && g_bans.acceptConnection(remote_ip)) {
+		boost::system::error_code endpointError;
+		const auto endpoint = connection->getSocket().remote_endpoint(endpointError);
+		if (!endpointError && endpoint.address().is_v4() && g_bans.acceptConnection(endpoint.address())) {
 			Service_ptr service = services.front();
 			if (service->is_single_socket()) {
 				connection->accept(service->make_protocol(connection));
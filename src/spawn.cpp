@@ -6,6 +6,7 @@
 #include "spawn.h"
 #include "game.h"
 #include "monster.h"
+#include "profiler.h"
 #include "configmanager.h"
 #include "scheduler.h"
 
@@ -343,6 +344,7 @@ void Spawn::startup()
 
 void Spawn::checkSpawn()
 {
+	ProfileScope profile(Subsystem::Spawns);
 	checkSpawnEvent = 0;
 
 	cleanup();
@@ -31,12 +31,16 @@ Spells::~Spells()
 
 TalkActionResult_t Spells::playerSaySpell(const PlayerPtr& player, std::string& words)
 {
-	std::string str_words = words;
+	std::string_view text = words;
 
-	//strip trailing spaces
-	trimString(str_words);
+	//strip leading and trailing spaces
+	const size_t first = text.find_first_not_of(' ');
+	if (first == std::string_view::npos) {
+		return TALKACTION_CONTINUE;
+	}
+	text = text.substr(first, text.find_last_not_of(' ') - first + 1);
 
-	InstantSpell* instantSpell = getInstantSpell(str_words);
+	InstantSpell* instantSpell = getInstantSpell(text);
 	if (!instantSpell) {
 		return TALKACTION_CONTINUE;
 	}
@@ -44,14 +48,12 @@ TalkActionResult_t Spells::playerSaySpell(const PlayerPtr& player, std::string&
 	std::string param;
 
 	if (instantSpell->getHasParam()) {
-		size_t spellLen = instantSpell->getWords().length();
-		size_t paramLen = str_words.length() - spellLen;
-		std::string paramText = str_words.substr(spellLen, paramLen);
+		std::string_view paramText = text.substr(instantSpell->getWords().length());
 		if (!paramText.empty() && paramText.front() == ' ') {
 			size_t loc1 = paramText.find('"', 1);
-			if (loc1 != std::string::npos) {
+			if (loc1 != std::string_view::npos) {
 				size_t loc2 = paramText.find('"', loc1 + 1);
-				if (loc2 == std::string::npos) {
+				if (loc2 == std::string_view::npos) {
 					loc2 = paramText.length();
 				} else if (paramText.find_last_not_of(' ') != loc2) {
 					return TALKACTION_CONTINUE;
@@ -59,9 +61,8 @@ TalkActionResult_t Spells::playerSaySpell(const PlayerPtr& player, std::string&
 
 				param = paramText.substr(loc1 + 1, loc2 - loc1 - 1);
 			} else {
-				trimString(paramText);
-				loc1 = paramText.find(' ', 0);
-				if (loc1 == std::string::npos) {
+				paramText.remove_prefix(std::min(paramText.find_first_not_of(' '), paramText.size()));
+				if (paramText.find(' ') == std::string_view::npos) {
 					param = paramText;
 				} else {
 					return TALKACTION_CONTINUE;
@@ -100,6 +101,8 @@ void Spells::clearMaps(bool fromLua)
 			++rune;
 		}
 	}
+
+	rebuildInstantIndex();
 }
 
 void Spells::clear(bool fromLua)
@@ -146,6 +149,8 @@ bool Spells::registerInstantLuaEvent(InstantSpell* event)
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
 		if (!result.second) {
 			std::cout << "[Warning - Spells::registerInstantLuaEvent] Duplicate registered instant spell with words: " << words << std::endl;
+		} else {
+			indexInstant(result.first->second);
 		}
 		return result.second;
 	}
@@ -201,31 +206,63 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name)
 	return nullptr;
 }
 
-InstantSpell* Spells::getInstantSpell(const std::string& words)
+void Spells::indexInstant(InstantSpell& instant)
 {
-	InstantSpell* result = nullptr;
+	const std::string& words = instant.getWords();
+	if (words.empty()) {
+		return;
+	}
 
+	// words that only differ in case keep the spell that was indexed first
+	if (!instantsByWords.emplace(asLowerCaseString(words), &instant).second) {
+		return;
+	}
+
+	const auto it = std::lower_bound(instantWordLengths.begin(), instantWordLengths.end(), words.length(), std::greater<>());
+	if (it == instantWordLengths.end() || *it != words.length()) {
+		instantWordLengths.insert(it, words.length());
+	}
+}
+
+void Spells::rebuildInstantIndex()
+{
+	instantsByWords.clear();
+	instantWordLengths.clear();
 	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
-			if (!result || spellLen > result->getWords().size()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
+		indexInstant(it.second);
+	}
+}
+
+InstantSpell* Spells::getInstantSpell(std::string_view words)
+{
+	if (instantWordLengths.empty() || words.length() < instantWordLengths.back()) {
+		return nullptr;
+	}
+
+	// only the part that can be spell words is folded, the rest of a chat line is never looked at
+	std::string folded(words.substr(0, instantWordLengths.front()));
+	toLowerCaseString(folded);
+
+	InstantSpell* result = nullptr;
+	for (const size_t spellLen : instantWordLengths) {
+		if (spellLen > folded.length()) {
+			continue;
+		}
+
+		const auto it = instantsByWords.find(std::string_view(folded).substr(0, spellLen));
+		if (it != instantsByWords.end()) {
+			result = it->second;
+			break;
 		}
 	}
 
 	if (result) {
-		const std::string& resultWords = result->getWords();
-		if (words.length() > resultWords.length()) {
+		const size_t spellLen = result->getWords().length();
+		if (words.length() > spellLen) {
 			if (!result->getHasParam()) {
 				return nullptr;
 			}
 
-			size_t spellLen = resultWords.length();
 			size_t paramLen = words.length() - spellLen;
 			if (paramLen < 2 || words[spellLen] != ' ') {
 				return nullptr;
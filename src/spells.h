@@ -9,6 +9,8 @@
 #include "talkaction.h"
 #include "baseevents.h"
 
+#include <gtl/phmap.hpp>
+
 class InstantSpell;
 class RuneSpell;
 class Spell;
@@ -31,7 +33,7 @@ class Spells final : public BaseEvents
 		RuneSpell* getRuneSpell(uint32_t id);
 		RuneSpell* getRuneSpellByName(const std::string& name);
 
-		InstantSpell* getInstantSpell(const std::string& words);
+		InstantSpell* getInstantSpell(std::string_view words);
 		InstantSpell* getInstantSpellByName(const std::string& name);
 
 		TalkActionResult_t playerSaySpell(const PlayerPtr& player, std::string& words);
@@ -54,9 +56,16 @@ class Spells final : public BaseEvents
 		Event_ptr getEvent(const std::string& nodeName) override;
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
+		void indexInstant(InstantSpell& instant);
+		void rebuildInstantIndex();
+
 		std::map<uint16_t, RuneSpell> runes;
 		std::map<std::string, InstantSpell> instants;
 
+		// lower case spell words, looked up once per distinct words length (longest first)
+		gtl::flat_hash_map<std::string, InstantSpell*> instantsByWords;
+		std::vector<size_t> instantWordLengths;
+
 		friend class CombatSpell;
 		LuaScriptInterface scriptInterface { "Spell Interface" };
 };
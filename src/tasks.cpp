@@ -34,8 +34,14 @@ void Dispatcher::threadMain()
 		tmpTaskList.swap(taskList);
 		taskLockUnique.unlock();
 
+		const auto tickStart = std::chrono::steady_clock::now();
+		uint64_t tickWait = 0, tickMaxWait = 0;
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
+				const auto wait = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - task->queued).count());
+				tickWait += wait;
+				tickMaxWait = std::max(tickMaxWait, wait);
+
 				++dispatcherCycle;
 				// execute it
 				(*task)();
@@ -43,12 +49,71 @@ void Dispatcher::threadMain()
 			delete task;
 		}
 		tmpTaskList.clear();
+
+		if (batchEnd) {
+			batchEnd();
+		}
+
+		const auto tickTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tickStart).count());
+		ticks.fetch_add(1, std::memory_order_relaxed);
+		busyMicroseconds.fetch_add(tickTime, std::memory_order_relaxed);
+		waitMicroseconds.fetch_add(tickWait, std::memory_order_relaxed);
+		// only this thread writes the maximums
+		if (tickTime > maxTickMicroseconds.load(std::memory_order_relaxed)) {
+			maxTickMicroseconds.store(tickTime, std::memory_order_relaxed);
+		}
+		if (tickMaxWait > maxWaitMicroseconds.load(std::memory_order_relaxed)) {
+			maxWaitMicroseconds.store(tickMaxWait, std::memory_order_relaxed);
+		}
 	}
 }
 
+size_t Dispatcher::runPending()
+{
+	size_t executed = 0;
+	std::vector<Task*> tmpTaskList;
+	while (true) {
+		{
+			std::lock_guard<std::mutex> lockClass(taskLock);
+			if (taskList.empty()) {
+				break;
+			}
+			tmpTaskList.swap(taskList);
+		}
+
+		for (Task* task : tmpTaskList) {
+			if (!task->hasExpired()) {
+				++dispatcherCycle;
+				++executed;
+				(*task)();
+			}
+			delete task;
+		}
+		tmpTaskList.clear();
+
+		if (batchEnd) {
+			batchEnd();
+		}
+	}
+	return executed;
+}
+
+DispatcherStats Dispatcher::getStats() const
+{
+	DispatcherStats stats;
+	stats.ticks = ticks.load(std::memory_order_relaxed);
+	stats.tasks = dispatcherCycle;
+	stats.busyMicroseconds = busyMicroseconds.load(std::memory_order_relaxed);
+	stats.maxTickMicroseconds = maxTickMicroseconds.load(std::memory_order_relaxed);
+	stats.waitMicroseconds = waitMicroseconds.load(std::memory_order_relaxed);
+	stats.maxWaitMicroseconds = maxWaitMicroseconds.load(std::memory_order_relaxed);
+	return stats;
+}
+
 void Dispatcher::addTask(Task* task)
 {
 	bool do_signal = false;
+	task->queued = std::chrono::steady_clock::now();
 
 	taskLock.lock();
 
@@ -73,6 +138,7 @@ void Dispatcher::shutdown()
 		setState(THREAD_STATE_TERMINATED);
 		taskSignal.notify_one();
 	});
+	task->queued = std::chrono::steady_clock::now();
 
 	std::lock_guard<std::mutex> lockClass(taskLock);
 	taskList.push_back(task);
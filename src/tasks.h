@@ -4,6 +4,7 @@
 #ifndef FS_TASKS_H
 #define FS_TASKS_H
 
+#include <atomic>
 #include <condition_variable>
 #include "thread_holder_base.h"
 #include "enums.h"
@@ -40,6 +41,12 @@ class Task
 	protected:
 		std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
 
+	private:
+		friend class Dispatcher;
+
+		// when the task entered the dispatcher queue
+		std::chrono::steady_clock::time_point queued;
+
 	private:
 		// Expiration has another meaning for scheduler tasks,
 		// then it is the time the task should be added to the
@@ -50,6 +57,19 @@ class Task
 Task* createTask(TaskFunc&& f);
 Task* createTask(uint32_t expiration, TaskFunc&& f);
 
+/** Totals since startup, a tick is one batch of tasks taken from the queue
+ * and wait is the time a task spent queued before it ran.
+ */
+struct DispatcherStats
+{
+	uint64_t ticks = 0;
+	uint64_t tasks = 0;
+	uint64_t busyMicroseconds = 0;
+	uint64_t maxTickMicroseconds = 0;
+	uint64_t waitMicroseconds = 0;
+	uint64_t maxWaitMicroseconds = 0;
+};
+
 class Dispatcher : public ThreadHolder<Dispatcher> {
 	public:
 		void addTask(Task* task);
@@ -60,10 +80,26 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 
 		void shutdown();
 
+		/** Accepts tasks without starting the thread, they only run when
+		 * runPending is called. Used by the offline simulator.
+		 */
+		void startInline() {
+			setState(THREAD_STATE_RUNNING);
+		}
+		// runs queued tasks on the calling thread until the queue is empty, returns how many ran
+		size_t runPending();
+
 		uint64_t getDispatcherCycle() const {
 			return dispatcherCycle;
 		}
 
+		DispatcherStats getStats() const;
+
+		// runs on the dispatcher thread after every batch of tasks, before the next one is taken
+		void setBatchEnd(TaskFunc&& f) {
+			batchEnd = std::move(f);
+		}
+
 		void threadMain();
 
 	private:
@@ -71,7 +107,14 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 		std::condition_variable taskSignal;
 
 		std::vector<Task*> taskList;
+		TaskFunc batchEnd;
 		uint64_t dispatcherCycle = 0;
+
+		std::atomic<uint64_t> ticks = 0;
+		std::atomic<uint64_t> busyMicroseconds = 0;
+		std::atomic<uint64_t> maxTickMicroseconds = 0;
+		std::atomic<uint64_t> waitMicroseconds = 0;
+		std::atomic<uint64_t> maxWaitMicroseconds = 0;
 };
 
 extern Dispatcher g_dispatcher;
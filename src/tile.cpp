@@ -1210,7 +1210,7 @@ bool Tile::hasCreature(CreaturePtr& creature)
 
 void Tile::removeCreature(CreaturePtr& creature)
 {
-	g_game.map.getQTNode(tilePos.x, tilePos.y)->removeCreature(creature);
+	g_game.map.getSector(tilePos.x, tilePos.y)->removeCreature(creature, tilePos.z);
 	removeThing(creature, 0);
 }
 
@@ -1574,6 +1574,8 @@ void Tile::setTileFlags(const ItemConstPtr& item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	g_game.map.refreshTileLayers(this);
 }
 
 void Tile::resetTileFlags(const ItemPtr& item)
@@ -1633,6 +1635,8 @@ void Tile::resetTileFlags(const ItemPtr& item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	g_game.map.refreshTileLayers(this);
 }
 
 bool Tile::isMoveableBlocking() const
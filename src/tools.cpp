@@ -9,6 +9,7 @@
 #include <fmt/chrono.h>
 #include <gtl/phmap.hpp>
 
+#include <atomic>
 #include <regex>
 
 extern ConfigManager g_config;
@@ -304,32 +305,120 @@ IntegerVector vectorAtoi(const std::vector<std::string_view>& stringVector)
 	return returnVector;
 }
 
-std::mt19937& getRandomGenerator()
+namespace {
+
+std::atomic<uint64_t> randomSeed{0};
+std::atomic<uint64_t> randomSeedGeneration{0};
+std::atomic<uint64_t> randomThreadCounter{0};
+
+uint64_t splitmix64(uint64_t& x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+	return z ^ (z >> 31);
+}
+
+uint64_t nextThreadSeed()
+{
+	if (const uint64_t seed = randomSeed.load(std::memory_order_acquire); seed != 0) {
+		uint64_t x = seed ^ (randomThreadCounter.fetch_add(1, std::memory_order_relaxed) * 0xD1B54A32D192ED03);
+		return splitmix64(x);
+	}
+
+	std::random_device rd;
+	return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+// Inverse CDF of the normal distribution (mean 0.5, deviation 0.25) truncated to [0, 1],
+// sampled at evenly spaced probabilities. normal_random interpolates between entries.
+class NormalTable
+{
+	public:
+		static constexpr size_t BITS = 10;
+		static constexpr size_t SIZE = 1 << BITS;
+
+		NormalTable() {
+			const auto cdf = [](double x) { return 0.5 * std::erfc(-(x - 0.5) / (0.25 * std::sqrt(2.0))); };
+			const double low = cdf(0.0);
+			const double high = cdf(1.0);
+
+			for (size_t i = 0; i <= SIZE; ++i) {
+				const double target = low + (high - low) * i / SIZE;
+
+				double a = 0.0, b = 1.0;
+				for (int step = 0; step < 50; ++step) {
+					const double mid = (a + b) / 2;
+					if (cdf(mid) < target) {
+						a = mid;
+					} else {
+						b = mid;
+					}
+				}
+				values[i] = static_cast<float>((a + b) / 2);
+			}
+		}
+
+		float sample(uint64_t bits) const {
+			const size_t index = bits >> (64 - BITS);
+			const float fraction = static_cast<float>((bits >> (64 - BITS - 24)) & 0xFFFFFF) * 0x1.0p-24f;
+			return values[index] + (values[index + 1] - values[index]) * fraction;
+		}
+
+	private:
+		float values[SIZE + 1];
+};
+
+const NormalTable normalTable;
+
+}
+
+void RandomGenerator::seed(uint64_t seed)
+{
+	for (auto& s : state) {
+		s = splitmix64(seed);
+	}
+}
+
+RandomGenerator& getRandomGenerator()
 {
-	static std::random_device rd;
-	static std::mt19937 generator(rd());
+	thread_local RandomGenerator generator(nextThreadSeed());
+	thread_local uint64_t generation = randomSeedGeneration.load(std::memory_order_acquire);
+
+	// reseed threads that were already running when the global seed changed
+	if (const uint64_t current = randomSeedGeneration.load(std::memory_order_acquire); generation != current) [[unlikely]] {
+		generation = current;
+		generator.seed(nextThreadSeed());
+	}
 	return generator;
 }
 
+void setRandomSeed(uint64_t seed)
+{
+	randomSeed.store(seed, std::memory_order_release);
+	randomThreadCounter.store(0, std::memory_order_relaxed);
+	randomSeedGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
 int32_t uniform_random(int32_t minNumber, int32_t maxNumber)
 {
-	static std::uniform_int_distribution<int32_t> uniformRand;
 	if (minNumber == maxNumber) {
 		return minNumber;
 	} else if (minNumber > maxNumber) {
 		std::swap(minNumber, maxNumber);
 	}
-	return uniformRand(getRandomGenerator(), std::uniform_int_distribution<int32_t>::param_type(minNumber, maxNumber));
+
+	const uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(maxNumber) - minNumber) + 1;
+	if (range == 0) {
+		// the full int32_t range
+		return static_cast<int32_t>(static_cast<uint32_t>(getRandomGenerator()() >> 32));
+	}
+	return static_cast<int32_t>(static_cast<int64_t>(minNumber) + getRandomGenerator().bounded(range));
 }
 
 int32_t normal_random(int32_t minNumber, int32_t maxNumber)
 {
-	static std::normal_distribution<float> normalRand(0.5f, 0.25f);
-
-	float v;
-	do {
-		v = normalRand(getRandomGenerator());
-	} while (v < 0.0 || v > 1.0);
+	const float v = normalTable.sample(getRandomGenerator()());
 
 	auto&& [a, b] = std::minmax(minNumber, maxNumber);
 	return a + std::lround(v * (b - a));
@@ -337,8 +426,7 @@ int32_t normal_random(int32_t minNumber, int32_t maxNumber)
 
 bool boolean_random(double probability /* = 0.5*/)
 {
-	static std::bernoulli_distribution booleanRand;
-	return booleanRand(getRandomGenerator(), std::bernoulli_distribution::param_type(probability));
+	return getRandomGenerator().uniform() < probability;
 }
 
 void trimString(std::string& str)
@@ -798,32 +886,6 @@ std::string getSkillName(uint8_t skillid)
 	}
 }
 
-uint32_t adlerChecksum(const uint8_t* data, size_t length)
-{
-	if (length > NETWORKMESSAGE_MAXSIZE) {
-		return 0;
-	}
-
-	const uint16_t adler = 65521;
-
-	uint32_t a = 1, b = 0;
-
-	while (length > 0) {
-		size_t tmp = length > 5552 ? 5552 : length;
-		length -= tmp;
-
-		do {
-			a += *data++;
-			b += a;
-		} while (--tmp);
-
-		a %= adler;
-		b %= adler;
-	}
-
-	return (b << 16) | a;
-}
-
 std::string ucfirst(std::string str)
 {
 	for (char& i : str) {
@@ -1239,11 +1301,21 @@ const char* getReturnMessage(ReturnValue value)
 	}
 }
 
+static std::atomic<int64_t> simulatedTime{0};
+
 int64_t OTSYS_TIME()
 {
+	if (const int64_t time = simulatedTime.load(std::memory_order_relaxed); time != 0) [[unlikely]] {
+		return time;
+	}
 	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+void setSimulatedTime(int64_t time)
+{
+	simulatedTime.store(time, std::memory_order_relaxed);
+}
+
 SpellGroup_t stringToSpellGroup(const std::string& value)
 {
 	std::string tmpStr = asLowerCaseString(value);
@@ -7,7 +7,9 @@
 #include "position.h"
 #include "const.h"
 #include "enums.h"
+#include "adler32.h"
 
+#include <limits>
 #include <random>
 #include <string_view>
 #include <utility>
@@ -72,7 +74,79 @@ constexpr bool hasBitSet(uint32_t flag, uint32_t flags) {
 	return (flags & flag) != 0;
 }
 
-std::mt19937& getRandomGenerator();
+/**
+  * xoshiro256** generator. Every thread owns one (see getRandomGenerator), so
+  * drawing numbers never contends with other threads.
+  * Satisfies UniformRandomBitGenerator, so it can be used with std::shuffle.
+  */
+class RandomGenerator
+{
+	public:
+		using result_type = uint64_t;
+
+		explicit RandomGenerator(uint64_t seed) {
+			this->seed(seed);
+		}
+
+		static constexpr result_type min() {
+			return 0;
+		}
+
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		void seed(uint64_t seed);
+
+		result_type operator()() {
+			const uint64_t result = rotl(state[1] * 5, 7) * 9;
+			const uint64_t t = state[1] << 17;
+
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotl(state[3], 45);
+			return result;
+		}
+
+		// uniform integer in [0, range) using Lemire's multiply-shift method
+		uint32_t bounded(uint32_t range) {
+			uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * range;
+			uint32_t low = static_cast<uint32_t>(m);
+			if (low < range) {
+				const uint32_t threshold = -range % range;
+				while (low < threshold) {
+					m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * range;
+					low = static_cast<uint32_t>(m);
+				}
+			}
+			return static_cast<uint32_t>(m >> 32);
+		}
+
+		// wider ranges would be narrowed silently, callers convert (and check) them explicitly
+		template <typename T>
+		uint32_t bounded(T range) = delete;
+
+		// uniform double in [0, 1)
+		double uniform() {
+			return ((*this)() >> 11) * 0x1.0p-53;
+		}
+
+	private:
+		static constexpr uint64_t rotl(uint64_t x, int k) {
+			return (x << k) | (x >> (64 - k));
+		}
+
+		uint64_t state[4];
+};
+
+// The generator of the calling thread
+RandomGenerator& getRandomGenerator();
+// Makes every thread generator deterministic from now on (0 restores random seeding).
+// Each thread derives its seed from the global one and the order it first drew a number in.
+void setRandomSeed(uint64_t seed);
 int32_t uniform_random(int32_t minNumber, int32_t maxNumber);
 int32_t normal_random(int32_t minNumber, int32_t maxNumber);
 bool boolean_random(double probability = 0.5);
@@ -80,13 +154,7 @@ bool boolean_random(double probability = 0.5);
 [[nodiscard]]
 static inline uint8_t generate_percent() noexcept
 {
-    static uint32_t x = 0xA341316Cu;
-
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-
-    return static_cast<uint8_t>((uint64_t(x) * 100u >> 32) + 1);
+    return static_cast<uint8_t>(getRandomGenerator().bounded(100u) + 1);
 }
 
 [[nodiscard]]
@@ -140,8 +208,6 @@ std::string getStatName(uint8_t id);
 
 bool isAllowedRegistration(std::string_view name);
 
-uint32_t adlerChecksum(const uint8_t* data, size_t length);
-
 std::string ucfirst(std::string str);
 std::string ucwords(std::string str);
 bool booleanString(std::string_view str);
@@ -160,6 +226,10 @@ itemAttrTypes stringToItemAttribute(const std::string& str);
 const char* getReturnMessage(ReturnValue value);
 
 int64_t OTSYS_TIME();
+/** Pins OTSYS_TIME to the given millisecond timestamp, the offline simulator
+ * advances it event by event. 0 goes back to the system clock.
+ */
+void setSimulatedTime(int64_t time);
 
 SpellGroup_t stringToSpellGroup(const std::string& value);
 
@@ -4,6 +4,8 @@
 #include "otpch.h"
 
 #include "xtea.h"
+#include "adler32.h"
+#include "const.h"
 
 #include <array>
 #include <assert.h>
@@ -40,6 +42,27 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
+uint32_t encrypt_checksum(uint8_t* data, size_t length, const round_keys& k)
+{
+	// blocks are independent, so the buffer is encrypted a chunk at a time and
+	// each chunk is checksummed while it is still in L1 instead of in a second pass
+	constexpr size_t chunkSize = 2048;
+
+	// adlerChecksum refuses anything larger than a network message
+	if (length > NETWORKMESSAGE_MAXSIZE) {
+		encrypt(data, length, k);
+		return 0;
+	}
+
+	uint32_t checksum = 1;
+	for (size_t offset = 0; offset < length; offset += chunkSize) {
+		const size_t size = std::min(chunkSize, length - offset);
+		encrypt(data + offset, size, k);
+		checksum = adlerUpdate(checksum, data + offset, size);
+	}
+	return checksum;
+}
+
 void decrypt(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (int32_t i = k.size() - 1; i > 0; i -= 2) {
@@ -11,6 +11,8 @@ using round_keys = std::array<uint32_t, 64>;
 
 round_keys expand_key(const key& k);
 void encrypt(uint8_t* data, size_t length, const round_keys& k);
+// same as encrypt, also returns adlerChecksum of the encrypted data (0 above NETWORKMESSAGE_MAXSIZE)
+uint32_t encrypt_checksum(uint8_t* data, size_t length, const round_keys& k);
 void decrypt(uint8_t* data, size_t length, const round_keys& k);
 
 } // namespace xtea
@@ -0,0 +1,470 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Headless load generator: logs N bots in through the login server, enters
+// the game with the session key and plays scripted behaviour profiles while
+// reporting throughput and response latency.
+
+#include "otpch.h"
+
+#include "accounts.h"
+#include "clientmessage.h"
+#include "const.h"
+#include "gameclient.h"
+#include "loginclient.h"
+#include "profile.h"
+#include "statusquery.h"
+
+#include <fmt/format.h>
+
+#include <future>
+#include <iostream>
+#include <random>
+
+using namespace BlackTek::Network;
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr uint16_t OS_LINUX = 1;
+
+struct Options
+{
+	std::string host = "127.0.0.1";
+	uint16_t loginPort = 7171;
+	std::string keyFile = "key.pem";
+	std::string accountsFile = "accounts.txt";
+	std::string profilesFile = "profiles.txt";
+	std::string profile;
+	size_t bots = 1;
+	size_t threads = 2;
+	uint32_t rampMilliseconds = 50;
+	uint32_t durationSeconds = 60;
+	uint32_t reportSeconds = 5;
+};
+
+struct Bot
+{
+	GameClient::Credentials credentials;
+	const BotProfile* profile = nullptr;
+	std::shared_ptr<GameClient> client;
+	std::vector<std::unique_ptr<boost::asio::steady_timer>> timers;
+	std::string error;
+	// response samples already handed to a report
+	size_t reportedResponses = 0;
+};
+
+struct Sample
+{
+	size_t online = 0;
+	size_t failed = 0;
+	uint64_t packetsSent = 0;
+	uint64_t bytesSent = 0;
+	uint64_t packetsReceived = 0;
+	uint64_t bytesReceived = 0;
+	std::vector<uint32_t> responseMicroseconds;
+};
+
+// all bots of a shard live on one io_context that is only run by its thread
+struct Shard
+{
+	boost::asio::io_context io;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work = boost::asio::make_work_guard(io);
+	std::vector<Bot> bots;
+	std::mt19937 random{std::random_device{}()};
+	std::thread thread;
+};
+
+void printUsage()
+{
+	std::cout << "Usage: bots [options]\n"
+	          << "  --host <address>       login server address (127.0.0.1)\n"
+	          << "  --port <port>          login port, also answers the status queries (7171)\n"
+	          << "  --key <file>           server RSA key (key.pem)\n"
+	          << "  --accounts <file>      one account:password:character per line (accounts.txt)\n"
+	          << "  --profiles <file>      behaviour profiles (profiles.txt)\n"
+	          << "  --profile <name>       run every bot with this profile instead of round robin\n"
+	          << "  --bots <n>             number of bots (1)\n"
+	          << "  --threads <n>          network threads the bots are spread over (2)\n"
+	          << "  --ramp <ms>            delay between bot logins (50)\n"
+	          << "  --duration <s>         time to stay logged in (60)\n"
+	          << "  --report <s>           report interval (5)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		auto value = [&]() -> std::string {
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("missing value for " + arg);
+			}
+			return argv[++i];
+		};
+
+		if (arg == "--host") {
+			options.host = value();
+		} else if (arg == "--port") {
+			options.loginPort = static_cast<uint16_t>(std::stoul(value()));
+		} else if (arg == "--key") {
+			options.keyFile = value();
+		} else if (arg == "--accounts") {
+			options.accountsFile = value();
+		} else if (arg == "--profiles") {
+			options.profilesFile = value();
+		} else if (arg == "--profile") {
+			options.profile = value();
+		} else if (arg == "--bots") {
+			options.bots = std::max<size_t>(1, std::stoul(value()));
+		} else if (arg == "--threads") {
+			options.threads = std::max<size_t>(1, std::stoul(value()));
+		} else if (arg == "--ramp") {
+			options.rampMilliseconds = std::stoul(value());
+		} else if (arg == "--duration") {
+			options.durationSeconds = std::stoul(value());
+		} else if (arg == "--report") {
+			options.reportSeconds = std::max<uint32_t>(1, std::stoul(value()));
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+ClientMessage buildStep(const BotStep& step, std::mt19937& random)
+{
+	const uint8_t direction = step.direction < 4 ? step.direction : static_cast<uint8_t>(random() % 4);
+	switch (step.action) {
+		case BotAction::Walk:
+			return ClientMessage(static_cast<ClientCode>(static_cast<uint8_t>(ClientCode::MoveNorth) + direction));
+
+		case BotAction::Turn:
+			return ClientMessage(static_cast<ClientCode>(static_cast<uint8_t>(ClientCode::TurnNorth) + direction));
+
+		case BotAction::Say: {
+			ClientMessage msg(ClientCode::Say);
+			msg.addByte(TALKTYPE_SAY);
+			msg.addString(step.text);
+			return msg;
+		}
+
+		case BotAction::Use: {
+			// hotkey use, the server looks the item up in the inventory
+			ClientMessage msg(ClientCode::UseItem);
+			msg.addPosition(0xFFFF, 0, 0);
+			msg.add<uint16_t>(step.itemId);
+			msg.addByte(0);
+			msg.addByte(0);
+			return msg;
+		}
+
+		case BotAction::Buy: {
+			ClientMessage msg(ClientCode::Purchase);
+			msg.add<uint16_t>(step.itemId);
+			msg.addByte(0);
+			msg.addByte(step.amount);
+			msg.addByte(0); // ignore capacity
+			msg.addByte(0); // in backpacks
+			return msg;
+		}
+
+		case BotAction::Sell: {
+			ClientMessage msg(ClientCode::Sale);
+			msg.add<uint16_t>(step.itemId);
+			msg.addByte(0);
+			msg.addByte(step.amount);
+			msg.addByte(0); // ignore equipped
+			return msg;
+		}
+
+		case BotAction::Ping:
+		default:
+			return ClientMessage(ClientCode::Ping);
+	}
+}
+
+void scheduleStep(Shard& shard, Bot& bot, boost::asio::steady_timer& timer, const BotStep& step)
+{
+	timer.async_wait([&shard, &bot, &timer, &step](const boost::system::error_code& error) {
+		if (error || !bot.client->isLoggedIn()) {
+			return;
+		}
+
+		const ClientMessage msg = buildStep(step, shard.random);
+		bot.client->send(msg.data(), msg.size());
+
+		if (step.intervalMilliseconds != 0) {
+			// fixed rate, a late wakeup does not shift the following steps
+			timer.expires_at(timer.expiry() + std::chrono::milliseconds(step.intervalMilliseconds));
+			scheduleStep(shard, bot, timer, step);
+		}
+	});
+}
+
+void startProfile(Shard& shard, Bot& bot)
+{
+	std::uniform_int_distribution<uint32_t> jitter(0, 999);
+	for (const BotStep& step : bot.profile->steps) {
+		auto& timer = bot.timers.emplace_back(std::make_unique<boost::asio::steady_timer>(shard.io));
+		// spread repeating steps so bots that logged in together do not act in lockstep
+		const uint32_t delay = step.intervalMilliseconds != 0 ? jitter(shard.random) % step.intervalMilliseconds : 0;
+		timer->expires_after(std::chrono::milliseconds(delay));
+		scheduleStep(shard, bot, *timer, step);
+	}
+}
+
+void enterGame(Shard& shard, Bot& bot, const RSA& rsa, const Options& options, const LoginClient::Result& result)
+{
+	if (!result.success) {
+		bot.error = "login server: " + result.error;
+		return;
+	}
+
+	auto it = std::find_if(result.characters.begin(), result.characters.end(), [&bot](const LoginClient::Character& character) {
+		return bot.credentials.character.empty() || boost::iequals(character.name, bot.credentials.character);
+	});
+	if (it == result.characters.end()) {
+		bot.error = "character not found on account " + bot.credentials.account;
+		return;
+	}
+
+	boost::system::error_code error;
+	auto address = boost::asio::ip::make_address(it->host, error);
+	if (error) {
+		// the world address is a name, the bots only run against a local server
+		address = boost::asio::ip::make_address(options.host);
+	}
+
+	bot.credentials.character = it->name;
+	bot.credentials.session = result.session;
+	bot.client = std::make_shared<GameClient>(shard.io, rsa, CLIENT_VERSION_MAX, OS_LINUX);
+	bot.client->connect(tcp::endpoint(address, it->port), bot.credentials, [&shard, &bot](bool success, const std::string& error) {
+		if (!success) {
+			bot.error = "game server: " + error;
+			return;
+		}
+
+		startProfile(shard, bot);
+	});
+}
+
+void stopBots(Shard& shard)
+{
+	for (Bot& bot : shard.bots) {
+		for (auto& timer : bot.timers) {
+			timer->cancel();
+		}
+
+		if (bot.client && bot.client->isLoggedIn()) {
+			const ClientMessage msg(ClientCode::Logout);
+			bot.client->send(msg.data(), msg.size());
+		}
+	}
+
+	// give the logout packets a moment to leave before the sockets close
+	auto timer = std::make_shared<boost::asio::steady_timer>(shard.io, std::chrono::milliseconds(500));
+	timer->async_wait([&shard, timer](const boost::system::error_code&) {
+		for (Bot& bot : shard.bots) {
+			if (bot.client) {
+				bot.client->close();
+			}
+		}
+	});
+}
+
+Sample collect(Shard& shard)
+{
+	Sample sample;
+	for (Bot& bot : shard.bots) {
+		if (!bot.error.empty()) {
+			++sample.failed;
+		}
+		if (!bot.client) {
+			continue;
+		}
+
+		if (bot.client->isLoggedIn()) {
+			++sample.online;
+		}
+
+		const auto& stats = bot.client->getStats();
+		sample.packetsSent += stats.packetsSent;
+		sample.bytesSent += stats.bytesSent;
+		sample.packetsReceived += stats.packetsReceived;
+		sample.bytesReceived += stats.bytesReceived;
+		sample.responseMicroseconds.insert(sample.responseMicroseconds.end(), stats.responseMicroseconds.begin() + bot.reportedResponses,
+		                                   stats.responseMicroseconds.end());
+		bot.reportedResponses = stats.responseMicroseconds.size();
+	}
+	return sample;
+}
+
+// runs collect on every shard thread and merges the results
+Sample collectAll(std::vector<std::unique_ptr<Shard>>& shards)
+{
+	std::vector<std::future<Sample>> futures;
+	for (auto& shard : shards) {
+		auto task = std::make_shared<std::packaged_task<Sample()>>([&shard]() { return collect(*shard); });
+		futures.push_back(task->get_future());
+		boost::asio::post(shard->io, [task]() { (*task)(); });
+	}
+
+	Sample total;
+	for (auto& future : futures) {
+		Sample sample = future.get();
+		total.online += sample.online;
+		total.failed += sample.failed;
+		total.packetsSent += sample.packetsSent;
+		total.bytesSent += sample.bytesSent;
+		total.packetsReceived += sample.packetsReceived;
+		total.bytesReceived += sample.bytesReceived;
+		total.responseMicroseconds.insert(total.responseMicroseconds.end(), sample.responseMicroseconds.begin(), sample.responseMicroseconds.end());
+	}
+	std::sort(total.responseMicroseconds.begin(), total.responseMicroseconds.end());
+	return total;
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+	return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+void report(const Sample& now, const Sample& last, double seconds)
+{
+	std::cout << fmt::format("online {:5d}  failed {:4d}  out {:7.0f} pkt/s {:8.1f} KB/s  in {:7.0f} msg/s {:8.1f} KB/s  response p50 {:6d} us p99 {:7d} us\n",
+	                         now.online, now.failed, (now.packetsSent - last.packetsSent) / seconds, (now.bytesSent - last.bytesSent) / seconds / 1024,
+	                         (now.packetsReceived - last.packetsReceived) / seconds, (now.bytesReceived - last.bytesReceived) / seconds / 1024,
+	                         percentile(now.responseMicroseconds, 0.50), percentile(now.responseMicroseconds, 0.99));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	std::vector<GameClient::Credentials> accounts;
+	std::vector<BotProfile> profiles;
+	RSA rsa;
+
+	try {
+		if (!parseOptions(argc, argv, options)) {
+			printUsage();
+			return 1;
+		}
+
+		accounts = loadAccounts(options.accountsFile);
+		profiles = loadProfiles(options.profilesFile);
+		rsa.loadPEM(options.keyFile);
+	} catch (const std::exception& e) {
+		std::cout << "[Error] " << e.what() << std::endl;
+		return 1;
+	}
+
+	if (accounts.size() < options.bots) {
+		std::cout << "[Error] " << options.bots << " bots need as many accounts, " << options.accountsFile << " has " << accounts.size() << std::endl;
+		return 1;
+	}
+
+	if (!options.profile.empty()) {
+		std::erase_if(profiles, [&options](const BotProfile& profile) { return profile.name != options.profile; });
+		if (profiles.empty()) {
+			std::cout << "[Error] Unknown profile " << options.profile << std::endl;
+			return 1;
+		}
+	}
+
+	tcp::endpoint loginEndpoint;
+	try {
+		boost::asio::io_context io;
+		loginEndpoint = *tcp::resolver(io).resolve(options.host, std::to_string(options.loginPort)).begin();
+	} catch (const boost::system::system_error& e) {
+		std::cout << "[Error] " << e.what() << std::endl;
+		return 1;
+	}
+
+	const auto before = queryServerPerformance(options.host, options.loginPort);
+
+	// bots are created before any thread runs, so their addresses stay stable
+	std::vector<std::unique_ptr<Shard>> shards;
+	for (size_t i = 0; i < std::min(options.threads, options.bots); ++i) {
+		shards.push_back(std::make_unique<Shard>());
+	}
+	for (size_t i = 0; i < options.bots; ++i) {
+		Shard& shard = *shards[i % shards.size()];
+		Bot& bot = shard.bots.emplace_back();
+		bot.credentials = accounts[i];
+		bot.profile = &profiles[i % profiles.size()];
+	}
+
+	const auto runStart = Clock::now();
+	for (size_t i = 0; i < options.bots; ++i) {
+		Shard& shard = *shards[i % shards.size()];
+		Bot& bot = shard.bots[i / shards.size()];
+		const auto start = runStart + std::chrono::milliseconds(static_cast<int64_t>(i) * options.rampMilliseconds);
+
+		auto timer = std::make_shared<boost::asio::steady_timer>(shard.io, start);
+		timer->async_wait([&shard, &bot, &rsa, &options, &loginEndpoint, timer](const boost::system::error_code&) {
+			auto login = std::make_shared<LoginClient>(shard.io, rsa, CLIENT_VERSION_MAX, OS_LINUX);
+			login->login(loginEndpoint, bot.credentials.account, bot.credentials.password, [&shard, &bot, &rsa, &options](const LoginClient::Result& result) {
+				enterGame(shard, bot, rsa, options, result);
+			});
+		});
+	}
+
+	for (auto& shard : shards) {
+		shard->thread = std::thread([&shard]() { shard->io.run(); });
+	}
+
+	const auto runEnd = runStart + std::chrono::milliseconds(static_cast<int64_t>(options.bots) * options.rampMilliseconds) +
+	                    std::chrono::seconds(options.durationSeconds);
+	Sample last;
+	auto lastTime = runStart;
+	while (Clock::now() < runEnd) {
+		std::this_thread::sleep_until(std::min(runEnd, lastTime + std::chrono::seconds(options.reportSeconds)));
+
+		const auto now = Clock::now();
+		Sample sample = collectAll(shards);
+		report(sample, last, std::chrono::duration<double>(now - lastTime).count());
+		last = std::move(sample);
+		lastTime = now;
+	}
+
+	for (auto& shard : shards) {
+		boost::asio::post(shard->io, [&shard]() { stopBots(*shard); });
+		shard->work.reset();
+	}
+	for (auto& shard : shards) {
+		shard->thread.join();
+	}
+
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - runStart).count();
+	size_t failed = 0;
+	for (auto& shard : shards) {
+		for (const Bot& bot : shard->bots) {
+			if (!bot.error.empty()) {
+				std::cout << "[Warning] " << bot.credentials.account << ": " << bot.error << std::endl;
+				++failed;
+			}
+		}
+	}
+
+	std::cout << fmt::format("bots:       {:d}/{:d} entered the game, {:.1f} s\n", options.bots - failed, options.bots, elapsed);
+	std::cout << fmt::format("sent:       {:d} packets, {:d} bytes\n", last.packetsSent, last.bytesSent);
+	std::cout << fmt::format("received:   {:d} messages, {:d} bytes\n", last.packetsReceived, last.bytesReceived);
+
+	const auto after = queryServerPerformance(options.host, options.loginPort);
+	if (before && after) {
+		const ServerPerformance run = *after - *before;
+		std::cout << fmt::format("dispatcher: {:d} ticks, {:d} tasks, {:.1f}% busy, {:.1f} us per tick (max {:d} us since startup)\n", run.ticks, run.tasks,
+		                         run.busyMicroseconds / (elapsed * 1e4), run.ticks ? double(run.busyMicroseconds) / run.ticks : 0.0, run.maxTickMicroseconds);
+		std::cout << fmt::format("task wait:  {:.1f} us average (max {:d} us since startup)\n", run.tasks ? double(run.waitMicroseconds) / run.tasks : 0.0,
+		                         run.maxWaitMicroseconds);
+	} else {
+		std::cout << "dispatcher: unavailable, the status port did not answer" << std::endl;
+	}
+	return failed == 0 ? 0 : 2;
+}
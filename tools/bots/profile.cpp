@@ -0,0 +1,118 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "profile.h"
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <limits>
+
+namespace {
+
+uint8_t parseDirection(const std::string& value)
+{
+	if (value.empty() || value == "random") {
+		return 4;
+	} else if (value == "north") {
+		return 0;
+	} else if (value == "east") {
+		return 1;
+	} else if (value == "south") {
+		return 2;
+	} else if (value == "west") {
+		return 3;
+	}
+	throw std::runtime_error("Unknown direction: " + value);
+}
+
+BotStep parseStep(std::istringstream& line)
+{
+	std::string action;
+	line >> action;
+
+	BotStep step;
+	if (action == "walk" || action == "turn") {
+		std::string direction;
+		line >> direction;
+		step.action = action == "walk" ? BotAction::Walk : BotAction::Turn;
+		step.direction = parseDirection(direction);
+	} else if (action == "say") {
+		step.action = BotAction::Say;
+		std::getline(line >> std::ws, step.text);
+		if (step.text.empty()) {
+			throw std::runtime_error("say needs a text");
+		}
+	} else if (action == "use" || action == "buy" || action == "sell") {
+		step.action = action == "use" ? BotAction::Use : (action == "buy" ? BotAction::Buy : BotAction::Sell);
+		uint32_t itemId = 0, amount = 1;
+		if (!(line >> itemId) || itemId == 0 || itemId > std::numeric_limits<uint16_t>::max()) {
+			throw std::runtime_error(action + " needs an item id");
+		}
+		line >> amount;
+		step.itemId = static_cast<uint16_t>(itemId);
+		step.amount = static_cast<uint8_t>(std::clamp<uint32_t>(amount, 1, 100));
+	} else if (action == "ping") {
+		step.action = BotAction::Ping;
+	} else {
+		throw std::runtime_error("Unknown action: " + action);
+	}
+	return step;
+}
+
+}
+
+std::vector<BotProfile> loadProfiles(const std::string& filename)
+{
+	std::ifstream file(filename);
+	if (!file) {
+		throw std::runtime_error("Unable to open " + filename);
+	}
+
+	std::vector<BotProfile> profiles;
+	size_t lineNumber = 0;
+	for (std::string text; std::getline(file, text);) {
+		++lineNumber;
+		boost::algorithm::trim(text);
+		if (text.empty() || text[0] == '#') {
+			continue;
+		}
+
+		if (text.front() == '[' && text.back() == ']') {
+			profiles.push_back({text.substr(1, text.size() - 2), {}});
+			continue;
+		}
+
+		try {
+			if (profiles.empty()) {
+				throw std::runtime_error("step outside of a [profile] section");
+			}
+
+			std::istringstream line(text);
+			std::string when;
+			line >> when;
+
+			uint32_t interval = 0;
+			if (when == "every") {
+				if (!(line >> interval) || interval == 0) {
+					throw std::runtime_error("every needs an interval in milliseconds");
+				}
+			} else if (when != "once") {
+				throw std::runtime_error("steps start with once or every");
+			}
+
+			BotStep step = parseStep(line);
+			step.intervalMilliseconds = interval;
+			profiles.back().steps.push_back(std::move(step));
+		} catch (const std::exception& e) {
+			throw std::runtime_error(fmt::format("{:s}:{:d}: {:s}", filename, lineNumber, e.what()));
+		}
+	}
+
+	if (profiles.empty()) {
+		throw std::runtime_error(filename + " has no profiles");
+	}
+	return profiles;
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_PROFILE_H
+#define FS_TOOLS_PROFILE_H
+
+enum class BotAction : uint8_t {
+	Walk,
+	Turn,
+	Say,
+	Use,
+	Buy,
+	Sell,
+	Ping,
+};
+
+struct BotStep
+{
+	BotAction action;
+	// 0 runs the step once right after entering the game
+	uint32_t intervalMilliseconds = 0;
+	// direction for walk and turn, 4 picks a random one
+	uint8_t direction = 4;
+	uint16_t itemId = 0;
+	uint8_t amount = 1;
+	std::string text;
+};
+
+struct BotProfile
+{
+	std::string name;
+	std::vector<BotStep> steps;
+};
+
+/** Loads behaviour profiles:
+ *
+ *   [hunter]
+ *   once say utani hur
+ *   every 600 walk random
+ *   every 2000 say exori
+ *   every 30000 use 266
+ *   every 60000 buy 268 5
+ *
+ * Actions are walk/turn [north|east|south|west|random], say <text>,
+ * use <client item id>, buy/sell <client item id> [amount] and ping.
+ */
+std::vector<BotProfile> loadProfiles(const std::string& filename);
+
+#endif
@@ -0,0 +1,31 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "accounts.h"
+
+#include <fstream>
+
+std::vector<GameClient::Credentials> loadAccounts(const std::string& filename)
+{
+	std::ifstream file(filename);
+	if (!file) {
+		throw std::runtime_error("Unable to open " + filename);
+	}
+
+	std::vector<GameClient::Credentials> accounts;
+	for (std::string line; std::getline(file, line);) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		const auto first = line.find(':');
+		const auto second = line.find(':', first + 1);
+		if (first == std::string::npos || second == std::string::npos) {
+			throw std::runtime_error("Malformed account line: " + line);
+		}
+		accounts.push_back({line.substr(0, first), line.substr(first + 1, second - first - 1), line.substr(second + 1)});
+	}
+	return accounts;
+}
@@ -0,0 +1,14 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_ACCOUNTS_H
+#define FS_TOOLS_ACCOUNTS_H
+
+#include "gameclient.h"
+
+/** Reads one account:password:character per line, empty lines and lines
+ * starting with # are skipped. The character may be left empty.
+ */
+std::vector<GameClient::Credentials> loadAccounts(const std::string& filename);
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_CLIENTMESSAGE_H
+#define FS_TOOLS_CLIENTMESSAGE_H
+
+#include "networkopcodes.h"
+
+#include <cstring>
+
+/** Builds one client packet. The server NetworkMessage can not be linked into
+ * the tools because its item and creature helpers pull in the game sources.
+ */
+class ClientMessage
+{
+	public:
+		explicit ClientMessage(BlackTek::Network::ClientCode opcode) {
+			addByte(static_cast<uint8_t>(opcode));
+		}
+
+		void addByte(uint8_t value) {
+			buffer.push_back(value);
+		}
+
+		template <typename T>
+		void add(T value) {
+			const auto size = buffer.size();
+			buffer.resize(size + sizeof(T));
+			std::memcpy(buffer.data() + size, &value, sizeof(T));
+		}
+
+		void addString(std::string_view value) {
+			add<uint16_t>(static_cast<uint16_t>(value.size()));
+			buffer.insert(buffer.end(), value.begin(), value.end());
+		}
+
+		void addPosition(uint16_t x, uint16_t y, uint8_t z) {
+			add<uint16_t>(x);
+			add<uint16_t>(y);
+			addByte(z);
+		}
+
+		const uint8_t* data() const {
+			return buffer.data();
+		}
+		size_t size() const {
+			return buffer.size();
+		}
+
+	private:
+		std::vector<uint8_t> buffer;
+};
+
+#endif
@@ -0,0 +1,283 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "gameclient.h"
+#include "adler32.h"
+#include "networkopcodes.h"
+
+#include <cstring>
+#include <random>
+
+using namespace BlackTek::Network;
+using boost::asio::ip::tcp;
+
+namespace {
+
+constexpr uint16_t COMPRESSED_LENGTH_FLAG = 0x8000;
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, T value)
+{
+	const auto size = buffer.size();
+	buffer.resize(size + sizeof(T));
+	std::memcpy(buffer.data() + size, &value, sizeof(T));
+}
+
+void putString(std::vector<uint8_t>& buffer, const std::string& value)
+{
+	put<uint16_t>(buffer, static_cast<uint16_t>(value.size()));
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+template <typename T>
+T get(const uint8_t* data)
+{
+	T value;
+	std::memcpy(&value, data, sizeof(T));
+	return value;
+}
+
+}
+
+GameClient::GameClient(boost::asio::io_context& io, const RSA& rsa, uint16_t clientVersion, uint16_t operatingSystem) :
+	socket(io), rsa(rsa), clientVersion(clientVersion), operatingSystem(operatingSystem)
+{
+	static std::random_device rd;
+	for (auto& part : key) {
+		part = rd();
+	}
+	roundKeys = xtea::expand_key(key);
+}
+
+void GameClient::connect(const tcp::endpoint& endpoint, Credentials credentials, LoginCallback onLogin)
+{
+	this->credentials = std::move(credentials);
+	this->onLogin = std::move(onLogin);
+
+	socket.async_connect(endpoint, [self = shared_from_this()](const boost::system::error_code& error) {
+		if (error) {
+			self->failLogin("connect: " + error.message());
+			return;
+		}
+
+		boost::system::error_code ignored;
+		self->socket.set_option(tcp::no_delay(true), ignored);
+		self->state = State::Challenge;
+		self->readHeader();
+	});
+}
+
+void GameClient::send(const uint8_t* data, size_t length)
+{
+	if (state != State::Game) {
+		return;
+	}
+
+	// [length][checksum][xtea: [inner length][packet][padding]]
+	const size_t encrypted = (length + 2 + 7) & ~size_t(7);
+	std::vector<uint8_t> frame(2 + 4 + encrypted);
+	const uint16_t innerLength = static_cast<uint16_t>(length);
+	std::memcpy(frame.data() + 6, &innerLength, 2);
+	std::memcpy(frame.data() + 8, data, length);
+	xtea::encrypt(frame.data() + 6, encrypted, roundKeys);
+
+	const uint32_t checksum = adlerChecksum(frame.data() + 6, encrypted);
+	const uint16_t frameLength = static_cast<uint16_t>(frame.size() - 2);
+	std::memcpy(frame.data(), &frameLength, 2);
+	std::memcpy(frame.data() + 2, &checksum, 4);
+
+	if (!awaitingResponse) {
+		awaitingResponse = true;
+		awaitingSince = std::chrono::steady_clock::now();
+	}
+
+	++stats.packetsSent;
+	write(std::move(frame));
+}
+
+void GameClient::close()
+{
+	if (state == State::Closed) {
+		return;
+	}
+
+	state = State::Closed;
+	boost::system::error_code ignored;
+	socket.shutdown(tcp::socket::shutdown_both, ignored);
+	socket.close(ignored);
+}
+
+void GameClient::readHeader()
+{
+	boost::asio::async_read(socket, boost::asio::buffer(header), [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+		if (error) {
+			self->failLogin("read: " + error.message());
+			self->close();
+			return;
+		}
+
+		self->readBody(static_cast<uint16_t>(self->header[0] | self->header[1] << 8));
+	});
+}
+
+void GameClient::readBody(uint16_t size)
+{
+	body.resize(size);
+	boost::asio::async_read(socket, boost::asio::buffer(body), [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+		if (error) {
+			self->failLogin("read: " + error.message());
+			self->close();
+			return;
+		}
+
+		self->parseMessage();
+		if (self->state != State::Closed) {
+			self->readHeader();
+		}
+	});
+}
+
+void GameClient::parseMessage()
+{
+	++stats.packetsReceived;
+	stats.bytesReceived += body.size() + 2;
+
+	if (awaitingResponse) {
+		awaitingResponse = false;
+		const auto elapsed = std::chrono::steady_clock::now() - awaitingSince;
+		stats.responseMicroseconds.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+	}
+
+	// [checksum][inner length][opcode][timestamp][random]
+	if (state == State::Challenge) {
+		if (body.size() < 12 || static_cast<ServerCode>(body[6]) != ServerCode::Challenge) {
+			failLogin("unexpected challenge");
+			close();
+			return;
+		}
+
+		sendLogin(get<uint32_t>(body.data() + 7), body[11]);
+		state = State::Login;
+		return;
+	}
+
+	if (body.size() < 12 || ((body.size() - 4) & 7) != 0) {
+		return;
+	}
+
+	if (state != State::Login && !onMessage) {
+		return;
+	}
+
+	xtea::decrypt(body.data() + 4, body.size() - 4, roundKeys);
+	const uint16_t innerLength = get<uint16_t>(body.data() + 4);
+	if ((innerLength & COMPRESSED_LENGTH_FLAG) != 0 || innerLength + 6u > body.size() || innerLength == 0) {
+		return;
+	}
+
+	const uint8_t* message = body.data() + 6;
+	if (state == State::Login) {
+		switch (static_cast<ServerCode>(message[0])) {
+			case ServerCode::LoginOrPendingState: {
+				uint16_t length = innerLength >= 3 ? get<uint16_t>(message + 1) : 0;
+				failLogin(std::string(reinterpret_cast<const char*>(message + 3), std::min<size_t>(length, innerLength - 3)));
+				close();
+				return;
+			}
+
+			case ServerCode::LoginQueue:
+				failLogin("placed on the waiting list");
+				close();
+				return;
+
+			case ServerCode::PendingStateEntered:
+			case ServerCode::EnterWorld:
+			case ServerCode::LoginSuccess:
+				state = State::Game;
+				if (onLogin) {
+					auto callback = std::move(onLogin);
+					onLogin = nullptr;
+					callback(true, {});
+				}
+				break;
+
+			default:
+				return;
+		}
+	}
+
+	if (onMessage) {
+		onMessage(message, innerLength);
+	}
+}
+
+void GameClient::sendLogin(uint32_t timestamp, uint8_t random)
+{
+	std::vector<uint8_t> frame;
+	put<uint16_t>(frame, 0); // length
+	put<uint32_t>(frame, 0); // checksum
+	frame.push_back(0x0A); // protocol id
+	put<uint16_t>(frame, operatingSystem);
+	put<uint16_t>(frame, clientVersion);
+	frame.resize(frame.size() + 7); // client version, client type and dat revision are not checked
+
+	std::vector<uint8_t> block;
+	block.push_back(0);
+	for (uint32_t part : key) {
+		put<uint32_t>(block, part);
+	}
+	block.push_back(0); // gamemaster flag
+	putString(block, credentials.session.empty() ? credentials.account + "\n" + credentials.password + "\n\n0" : credentials.session);
+	putString(block, credentials.character);
+	put<uint32_t>(block, timestamp);
+	block.push_back(random);
+	if (block.size() > 128) {
+		failLogin("account, password and character do not fit the login block");
+		close();
+		return;
+	}
+	block.resize(128);
+	rsa.encrypt(reinterpret_cast<char*>(block.data()));
+	frame.insert(frame.end(), block.begin(), block.end());
+
+	const uint16_t frameLength = static_cast<uint16_t>(frame.size() - 2);
+	const uint32_t checksum = adlerChecksum(frame.data() + 6, frame.size() - 6);
+	std::memcpy(frame.data(), &frameLength, 2);
+	std::memcpy(frame.data() + 2, &checksum, 4);
+	write(std::move(frame));
+}
+
+void GameClient::write(std::vector<uint8_t>&& frame)
+{
+	stats.bytesSent += frame.size();
+	writeQueue.push_back(std::move(frame));
+	if (writeQueue.size() == 1) {
+		writeNext();
+	}
+}
+
+void GameClient::writeNext()
+{
+	boost::asio::async_write(socket, boost::asio::buffer(writeQueue.front()), [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+		if (error) {
+			self->close();
+			return;
+		}
+
+		self->writeQueue.pop_front();
+		if (!self->writeQueue.empty()) {
+			self->writeNext();
+		}
+	});
+}
+
+void GameClient::failLogin(const std::string& error)
+{
+	if (onLogin) {
+		auto callback = std::move(onLogin);
+		onLogin = nullptr;
+		callback(false, error);
+	}
+}
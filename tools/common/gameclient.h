@@ -0,0 +1,102 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_GAMECLIENT_H
+#define FS_TOOLS_GAMECLIENT_H
+
+#include <deque>
+
+#include "rsa.h"
+#include "xtea.h"
+
+/** Minimal headless game client: performs the challenge and RSA login, then
+ * sends raw client packets and keeps traffic counters. Server packets are only
+ * decoded as far as needed to know whether the login succeeded.
+ */
+class GameClient : public std::enable_shared_from_this<GameClient>
+{
+	public:
+		struct Credentials
+		{
+			std::string account;
+			std::string password;
+			std::string character;
+			// session key from the login server, built from account and password when empty
+			std::string session;
+		};
+
+		struct Stats
+		{
+			uint64_t packetsSent = 0;
+			uint64_t bytesSent = 0;
+			uint64_t packetsReceived = 0;
+			uint64_t bytesReceived = 0;
+			// time from a sent packet to the next message of the server
+			std::vector<uint32_t> responseMicroseconds;
+		};
+
+		using LoginCallback = std::function<void(bool success, const std::string& error)>;
+		// called with every decrypted, uncompressed server message once logged in
+		using MessageCallback = std::function<void(const uint8_t* data, size_t length)>;
+
+		GameClient(boost::asio::io_context& io, const RSA& rsa, uint16_t clientVersion, uint16_t operatingSystem);
+
+		// non-copyable
+		GameClient(const GameClient&) = delete;
+		GameClient& operator=(const GameClient&) = delete;
+
+		void connect(const boost::asio::ip::tcp::endpoint& endpoint, Credentials credentials, LoginCallback onLogin);
+		void setMessageCallback(MessageCallback callback) {
+			onMessage = std::move(callback);
+		}
+
+		/** Sends one client packet.
+		 * \param data the packet starting at its opcode
+		 */
+		void send(const uint8_t* data, size_t length);
+		void close();
+
+		bool isOpen() const {
+			return state != State::Closed;
+		}
+		bool isLoggedIn() const {
+			return state == State::Game;
+		}
+		const Stats& getStats() const {
+			return stats;
+		}
+
+	private:
+		enum class State { Connecting, Challenge, Login, Game, Closed };
+
+		void readHeader();
+		void readBody(uint16_t size);
+		void parseMessage();
+		void sendLogin(uint32_t timestamp, uint8_t random);
+		void write(std::vector<uint8_t>&& frame);
+		void writeNext();
+		void failLogin(const std::string& error);
+
+		boost::asio::ip::tcp::socket socket;
+		const RSA& rsa;
+		xtea::key key;
+		xtea::round_keys roundKeys;
+
+		Credentials credentials;
+		LoginCallback onLogin;
+		MessageCallback onMessage;
+
+		uint8_t header[2];
+		std::vector<uint8_t> body;
+		std::deque<std::vector<uint8_t>> writeQueue;
+
+		Stats stats;
+		std::chrono::steady_clock::time_point awaitingSince;
+		bool awaitingResponse = false;
+
+		uint16_t clientVersion;
+		uint16_t operatingSystem;
+		State state = State::Connecting;
+};
+
+#endif
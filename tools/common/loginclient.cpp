@@ -0,0 +1,251 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "loginclient.h"
+#include "adler32.h"
+
+#include <cstring>
+#include <random>
+
+using boost::asio::ip::tcp;
+
+namespace {
+
+// reads the login server answer, any overrun makes the whole answer invalid
+class Reader
+{
+	public:
+		Reader(const uint8_t* data, size_t length) : data(data), length(length) {}
+
+		template <typename T>
+		T get() {
+			T value{};
+			if (position + sizeof(T) > length) {
+				overrun = true;
+				return value;
+			}
+			std::memcpy(&value, data + position, sizeof(T));
+			position += sizeof(T);
+			return value;
+		}
+
+		std::string getString() {
+			const auto size = get<uint16_t>();
+			if (position + size > length) {
+				overrun = true;
+				return {};
+			}
+			std::string value(reinterpret_cast<const char*>(data + position), size);
+			position += size;
+			return value;
+		}
+
+		bool atEnd() const {
+			return position >= length;
+		}
+
+		bool overrun = false;
+
+	private:
+		const uint8_t* data;
+		size_t length;
+		size_t position = 0;
+};
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, T value)
+{
+	const auto size = buffer.size();
+	buffer.resize(size + sizeof(T));
+	std::memcpy(buffer.data() + size, &value, sizeof(T));
+}
+
+void putString(std::vector<uint8_t>& buffer, const std::string& value)
+{
+	put<uint16_t>(buffer, static_cast<uint16_t>(value.size()));
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+}
+
+LoginClient::LoginClient(boost::asio::io_context& io, const RSA& rsa, uint16_t clientVersion, uint16_t operatingSystem) :
+	socket(io), rsa(rsa), clientVersion(clientVersion), operatingSystem(operatingSystem)
+{
+	static std::random_device rd;
+	for (auto& part : key) {
+		part = rd();
+	}
+	roundKeys = xtea::expand_key(key);
+}
+
+void LoginClient::login(const tcp::endpoint& endpoint, const std::string& account, const std::string& password, Callback callback)
+{
+	this->callback = std::move(callback);
+	socket.async_connect(endpoint, [self = shared_from_this(), account, password](const boost::system::error_code& error) {
+		if (error) {
+			self->finish({false, "connect: " + error.message()});
+			return;
+		}
+
+		self->sendLogin(account, password);
+	});
+}
+
+void LoginClient::sendLogin(const std::string& account, const std::string& password)
+{
+	request.clear();
+	put<uint16_t>(request, 0); // length
+	put<uint32_t>(request, 0); // checksum
+	request.push_back(0x01); // protocol id
+	put<uint16_t>(request, operatingSystem);
+	put<uint16_t>(request, clientVersion);
+	request.resize(request.size() + 17); // protocol version, dat, spr and pic signatures
+
+	std::vector<uint8_t> block;
+	block.push_back(0);
+	for (uint32_t part : key) {
+		put<uint32_t>(block, part);
+	}
+	putString(block, account);
+	putString(block, password);
+	if (block.size() > 128) {
+		finish({false, "account and password do not fit the login block"});
+		return;
+	}
+	block.resize(128);
+	rsa.encrypt(reinterpret_cast<char*>(block.data()));
+	request.insert(request.end(), block.begin(), block.end());
+
+	// the last block holds the authenticator token and the stay logged in flag
+	block.assign(1, 0);
+	putString(block, "");
+	block.push_back(0);
+	block.resize(128);
+	rsa.encrypt(reinterpret_cast<char*>(block.data()));
+	request.insert(request.end(), block.begin(), block.end());
+
+	const uint16_t length = static_cast<uint16_t>(request.size() - 2);
+	const uint32_t checksum = adlerChecksum(request.data() + 6, request.size() - 6);
+	std::memcpy(request.data(), &length, 2);
+	std::memcpy(request.data() + 2, &checksum, 4);
+
+	boost::asio::async_write(socket, boost::asio::buffer(request), [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+		if (error) {
+			self->finish({false, "write: " + error.message()});
+			return;
+		}
+
+		self->readResponse();
+	});
+}
+
+void LoginClient::readResponse()
+{
+	boost::asio::async_read(socket, boost::asio::buffer(header), [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+		if (error) {
+			self->finish({false, "read: " + error.message()});
+			return;
+		}
+
+		self->body.resize(self->header[0] | self->header[1] << 8);
+		boost::asio::async_read(self->socket, boost::asio::buffer(self->body), [self](const boost::system::error_code& error, size_t) {
+			if (error) {
+				self->finish({false, "read: " + error.message()});
+				return;
+			}
+
+			self->parseResponse();
+		});
+	});
+}
+
+void LoginClient::parseResponse()
+{
+	// [checksum][xtea: [inner length][opcodes]]
+	if (body.size() < 12 || ((body.size() - 4) & 7) != 0) {
+		finish({false, "malformed login response"});
+		return;
+	}
+
+	xtea::decrypt(body.data() + 4, body.size() - 4, roundKeys);
+	uint16_t innerLength;
+	std::memcpy(&innerLength, body.data() + 4, 2);
+	if (innerLength + 6u > body.size()) {
+		finish({false, "malformed login response"});
+		return;
+	}
+
+	Result result;
+	std::vector<std::pair<std::string, uint16_t>> worlds;
+	Reader reader(body.data() + 6, innerLength);
+	while (!reader.atEnd() && !reader.overrun) {
+		switch (reader.get<uint8_t>()) {
+			case 0x0A:
+			case 0x0B:
+				finish({false, reader.getString()});
+				return;
+
+			case 0x0D:
+				finish({false, "authenticator token required"});
+				return;
+
+			case 0x0C:
+				reader.get<uint8_t>();
+				break;
+
+			case 0x14: // motd
+				reader.getString();
+				break;
+
+			case 0x28:
+				result.session = reader.getString();
+				break;
+
+			case 0x64: {
+				const uint8_t worldCount = reader.get<uint8_t>();
+				for (uint8_t i = 0; i < worldCount; ++i) {
+					reader.get<uint8_t>(); // world id
+					reader.getString(); // world name
+					std::string host = reader.getString();
+					const uint16_t port = reader.get<uint16_t>();
+					reader.get<uint8_t>(); // preview state
+					worlds.emplace_back(std::move(host), port);
+				}
+
+				const uint8_t characterCount = reader.get<uint8_t>();
+				for (uint8_t i = 0; i < characterCount; ++i) {
+					const uint8_t world = reader.get<uint8_t>();
+					std::string name = reader.getString();
+					if (world < worlds.size()) {
+						result.characters.push_back({std::move(name), worlds[world].first, worlds[world].second});
+					}
+				}
+
+				// premium state closes the answer
+				result.success = !reader.overrun && !result.session.empty();
+				finish(std::move(result));
+				return;
+			}
+
+			default:
+				finish({false, "unknown login response"});
+				return;
+		}
+	}
+
+	finish({false, "incomplete login response"});
+}
+
+void LoginClient::finish(Result&& result)
+{
+	boost::system::error_code ignored;
+	socket.close(ignored);
+
+	if (callback) {
+		auto done = std::move(callback);
+		callback = nullptr;
+		done(result);
+	}
+}
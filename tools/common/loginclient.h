@@ -0,0 +1,61 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_LOGINCLIENT_H
+#define FS_TOOLS_LOGINCLIENT_H
+
+#include "rsa.h"
+#include "xtea.h"
+
+/** One account login against ProtocolLogin, returning the session key and
+ * the game world of every character on the account.
+ */
+class LoginClient : public std::enable_shared_from_this<LoginClient>
+{
+	public:
+		struct Character
+		{
+			std::string name;
+			std::string host;
+			uint16_t port = 0;
+		};
+
+		struct Result
+		{
+			bool success = false;
+			std::string error;
+			std::string session;
+			std::vector<Character> characters;
+		};
+
+		using Callback = std::function<void(const Result& result)>;
+
+		LoginClient(boost::asio::io_context& io, const RSA& rsa, uint16_t clientVersion, uint16_t operatingSystem);
+
+		// non-copyable
+		LoginClient(const LoginClient&) = delete;
+		LoginClient& operator=(const LoginClient&) = delete;
+
+		void login(const boost::asio::ip::tcp::endpoint& endpoint, const std::string& account, const std::string& password, Callback callback);
+
+	private:
+		void sendLogin(const std::string& account, const std::string& password);
+		void readResponse();
+		void parseResponse();
+		void finish(Result&& result);
+
+		boost::asio::ip::tcp::socket socket;
+		const RSA& rsa;
+		xtea::key key;
+		xtea::round_keys roundKeys;
+		Callback callback;
+
+		uint8_t header[2];
+		std::vector<uint8_t> body;
+		std::vector<uint8_t> request;
+
+		uint16_t clientVersion;
+		uint16_t operatingSystem;
+};
+
+#endif
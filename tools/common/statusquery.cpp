@@ -0,0 +1,60 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "statusquery.h"
+
+#include <cstring>
+#include <vector>
+
+using boost::asio::ip::tcp;
+
+ServerPerformance ServerPerformance::operator-(const ServerPerformance& other) const
+{
+	ServerPerformance result;
+	result.ticks = ticks - other.ticks;
+	result.tasks = tasks - other.tasks;
+	result.busyMicroseconds = busyMicroseconds - other.busyMicroseconds;
+	result.waitMicroseconds = waitMicroseconds - other.waitMicroseconds;
+	// maximums are kept since startup and can not be subtracted
+	result.maxTickMicroseconds = maxTickMicroseconds;
+	result.maxWaitMicroseconds = maxWaitMicroseconds;
+	return result;
+}
+
+std::optional<ServerPerformance> queryServerPerformance(const std::string& host, uint16_t port)
+{
+	try {
+		boost::asio::io_context io;
+		tcp::socket socket(io);
+		boost::asio::connect(socket, tcp::resolver(io).resolve(host, std::to_string(port)));
+
+		// [length][status protocol][server info request][REQUEST_PERFORMANCE_INFO]
+		const uint8_t request[] = {0x04, 0x00, 0xFF, 0x01, 0x00, 0x01};
+		boost::asio::write(socket, boost::asio::buffer(request));
+
+		uint8_t header[2];
+		boost::asio::read(socket, boost::asio::buffer(header));
+		std::vector<uint8_t> body(header[0] | header[1] << 8);
+		boost::asio::read(socket, boost::asio::buffer(body));
+
+		if (body.size() < 1 + 6 * sizeof(uint64_t) || body[0] != 0x24) {
+			return std::nullopt;
+		}
+
+		uint64_t values[6];
+		std::memcpy(values, body.data() + 1, sizeof(values));
+
+		ServerPerformance performance;
+		performance.ticks = values[0];
+		performance.tasks = values[1];
+		performance.busyMicroseconds = values[2];
+		performance.maxTickMicroseconds = values[3];
+		performance.waitMicroseconds = values[4];
+		performance.maxWaitMicroseconds = values[5];
+		return performance;
+	} catch (const boost::system::system_error&) {
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,29 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_STATUSQUERY_H
+#define FS_TOOLS_STATUSQUERY_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// dispatcher totals as sent by the status protocol, see DispatcherStats
+struct ServerPerformance
+{
+	uint64_t ticks = 0;
+	uint64_t tasks = 0;
+	uint64_t busyMicroseconds = 0;
+	uint64_t maxTickMicroseconds = 0;
+	uint64_t waitMicroseconds = 0;
+	uint64_t maxWaitMicroseconds = 0;
+
+	ServerPerformance operator-(const ServerPerformance& other) const;
+};
+
+/** Asks the status protocol for the dispatcher totals.
+ * \returns nothing when the server can not be reached or does not send them
+ */
+std::optional<ServerPerformance> queryServerPerformance(const std::string& host, uint16_t port);
+
+#endif
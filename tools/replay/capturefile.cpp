@@ -0,0 +1,69 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "capturefile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint16_t FORMAT_VERSION = 1;
+
+bool readVarint(const std::vector<uint8_t>& data, size_t& position, uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && position < data.size(); shift += 7) {
+		const uint8_t byte = data[position++];
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+CaptureFile CaptureFile::load(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Unable to open " + filename);
+	}
+
+	const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	if (data.size() < 10 || std::memcmp(data.data(), "BTPC", 4) != 0) {
+		throw std::runtime_error(filename + " is not a packet capture");
+	}
+
+	uint16_t header[3];
+	std::memcpy(header, data.data() + 4, sizeof(header));
+	if (header[0] != FORMAT_VERSION) {
+		throw std::runtime_error(filename + " has an unsupported capture format version");
+	}
+
+	CaptureFile capture;
+	capture.name = filename;
+	capture.clientVersion = header[1];
+	capture.operatingSystem = header[2];
+
+	uint64_t offset = 0;
+	size_t position = 10;
+	while (position < data.size()) {
+		uint64_t delta, length;
+		if (!readVarint(data, position, delta) || !readVarint(data, position, length) || length > data.size() - position) {
+			// a session cut short by a crash, keep what was complete
+			break;
+		}
+
+		offset += delta;
+		capture.packets.push_back({offset, std::vector<uint8_t>(data.begin() + position, data.begin() + position + length)});
+		position += length;
+	}
+	return capture;
+}
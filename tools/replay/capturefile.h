@@ -0,0 +1,32 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_CAPTUREFILE_H
+#define FS_TOOLS_CAPTUREFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** A session recorded by the server with packetCaptureDirectory set,
+ * the format is described in src/packetcapture.h.
+ */
+struct CaptureFile
+{
+	struct Packet
+	{
+		// microseconds since the session started
+		uint64_t offset;
+		std::vector<uint8_t> data;
+	};
+
+	std::string name;
+	uint16_t clientVersion = 0;
+	uint16_t operatingSystem = 0;
+	std::vector<Packet> packets;
+
+	// throws std::runtime_error when the file is missing or malformed
+	static CaptureFile load(const std::string& filename);
+};
+
+#endif
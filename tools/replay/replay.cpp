@@ -0,0 +1,237 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Replays captured client sessions against a test world with N synthetic
+// clients and reports the dispatcher tick time, response latency and traffic.
+
+#include "otpch.h"
+
+#include "accounts.h"
+#include "capturefile.h"
+#include "gameclient.h"
+#include "statusquery.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iostream>
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options
+{
+	std::string host = "127.0.0.1";
+	uint16_t gamePort = 7172;
+	uint16_t statusPort = 7171;
+	std::string keyFile = "key.pem";
+	std::string accountsFile = "accounts.txt";
+	size_t clients = 1;
+	double speed = 1.0;
+	uint32_t rampMilliseconds = 100;
+	uint32_t lingerMilliseconds = 2000;
+	std::vector<std::string> captures;
+};
+
+struct Session
+{
+	std::shared_ptr<GameClient> client;
+	const CaptureFile* capture = nullptr;
+	GameClient::Credentials credentials;
+	std::unique_ptr<boost::asio::steady_timer> timer;
+	Clock::time_point start;
+	size_t next = 0;
+	bool loggedIn = false;
+	std::string error;
+};
+
+void printUsage()
+{
+	std::cout << "Usage: replay [options] capture.btpc [capture.btpc ...]\n"
+	          << "  --host <address>       game server address (127.0.0.1)\n"
+	          << "  --port <port>          game port (7172)\n"
+	          << "  --status-port <port>   status port, used for the dispatcher stats (7171)\n"
+	          << "  --key <file>           server RSA key (key.pem)\n"
+	          << "  --accounts <file>      one account:password:character per line (accounts.txt)\n"
+	          << "  --clients <n>          synthetic clients, captures are assigned round robin (1)\n"
+	          << "  --speed <factor>       playback speed, 2 replays twice as fast (1)\n"
+	          << "  --ramp <ms>            delay between client logins (100)\n"
+	          << "  --linger <ms>          time to stay connected after the last packet (2000)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		auto value = [&]() -> std::string {
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("missing value for " + arg);
+			}
+			return argv[++i];
+		};
+
+		if (arg == "--host") {
+			options.host = value();
+		} else if (arg == "--port") {
+			options.gamePort = static_cast<uint16_t>(std::stoul(value()));
+		} else if (arg == "--status-port") {
+			options.statusPort = static_cast<uint16_t>(std::stoul(value()));
+		} else if (arg == "--key") {
+			options.keyFile = value();
+		} else if (arg == "--accounts") {
+			options.accountsFile = value();
+		} else if (arg == "--clients") {
+			options.clients = std::max<size_t>(1, std::stoul(value()));
+		} else if (arg == "--speed") {
+			options.speed = std::max(0.01, std::stod(value()));
+		} else if (arg == "--ramp") {
+			options.rampMilliseconds = std::stoul(value());
+		} else if (arg == "--linger") {
+			options.lingerMilliseconds = std::stoul(value());
+		} else if (arg == "--help" || arg == "-h") {
+			return false;
+		} else {
+			options.captures.push_back(arg);
+		}
+	}
+	return !options.captures.empty();
+}
+
+void scheduleNext(Session& session, const Options& options)
+{
+	const auto& packets = session.capture->packets;
+	if (session.next >= packets.size()) {
+		session.timer->expires_after(std::chrono::milliseconds(options.lingerMilliseconds));
+		session.timer->async_wait([&session](const boost::system::error_code&) { session.client->close(); });
+		return;
+	}
+
+	// deadlines are absolute, so slow sends never shift the rest of the session
+	const auto offset = std::chrono::microseconds(static_cast<int64_t>(packets[session.next].offset / options.speed));
+	session.timer->expires_at(session.start + offset);
+	session.timer->async_wait([&session, &options](const boost::system::error_code& error) {
+		if (error || !session.client->isOpen()) {
+			return;
+		}
+
+		const auto& packet = session.capture->packets[session.next++];
+		session.client->send(packet.data.data(), packet.data.size());
+		scheduleNext(session, options);
+	});
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+	return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	std::vector<CaptureFile> captures;
+	std::vector<GameClient::Credentials> accounts;
+	RSA rsa;
+
+	try {
+		if (!parseOptions(argc, argv, options)) {
+			printUsage();
+			return 1;
+		}
+
+		for (const auto& name : options.captures) {
+			captures.push_back(CaptureFile::load(name));
+		}
+		accounts = loadAccounts(options.accountsFile);
+		rsa.loadPEM(options.keyFile);
+	} catch (const std::exception& e) {
+		std::cout << "[Error] " << e.what() << std::endl;
+		return 1;
+	}
+
+	if (accounts.size() < options.clients) {
+		std::cout << "[Error] " << options.clients << " clients need as many accounts, " << options.accountsFile << " has " << accounts.size() << std::endl;
+		return 1;
+	}
+
+	boost::asio::io_context io;
+	tcp::endpoint endpoint;
+	try {
+		endpoint = *tcp::resolver(io).resolve(options.host, std::to_string(options.gamePort)).begin();
+	} catch (const boost::system::system_error& e) {
+		std::cout << "[Error] " << e.what() << std::endl;
+		return 1;
+	}
+
+	const auto before = queryServerPerformance(options.host, options.statusPort);
+
+	std::vector<Session> sessions(options.clients);
+	const auto runStart = Clock::now();
+	for (size_t i = 0; i < sessions.size(); ++i) {
+		Session& session = sessions[i];
+		session.capture = &captures[i % captures.size()];
+		session.credentials = accounts[i];
+		session.client = std::make_shared<GameClient>(io, rsa, session.capture->clientVersion, session.capture->operatingSystem);
+		session.timer = std::make_unique<boost::asio::steady_timer>(io);
+
+		session.timer->expires_at(runStart + std::chrono::milliseconds(static_cast<int64_t>(i) * options.rampMilliseconds));
+		session.timer->async_wait([&session, &options, &endpoint](const boost::system::error_code&) {
+			session.client->connect(endpoint, session.credentials, [&session, &options](bool success, const std::string& error) {
+				if (!success) {
+					session.error = error;
+					return;
+				}
+
+				session.loggedIn = true;
+				session.start = Clock::now();
+				scheduleNext(session, options);
+			});
+		});
+	}
+
+	io.run();
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - runStart).count();
+
+	GameClient::Stats total;
+	size_t loggedIn = 0;
+	for (const Session& session : sessions) {
+		if (!session.loggedIn) {
+			std::cout << "[Warning] " << session.credentials.character << " did not log in: " << session.error << std::endl;
+			continue;
+		}
+
+		++loggedIn;
+		const auto& stats = session.client->getStats();
+		total.packetsSent += stats.packetsSent;
+		total.bytesSent += stats.bytesSent;
+		total.packetsReceived += stats.packetsReceived;
+		total.bytesReceived += stats.bytesReceived;
+		total.responseMicroseconds.insert(total.responseMicroseconds.end(), stats.responseMicroseconds.begin(), stats.responseMicroseconds.end());
+	}
+	std::sort(total.responseMicroseconds.begin(), total.responseMicroseconds.end());
+
+	std::cout << fmt::format("clients:    {:d}/{:d} logged in, {:.1f} s\n", loggedIn, sessions.size(), elapsed);
+	std::cout << fmt::format("sent:       {:d} packets, {:d} bytes, {:.1f} KB/s\n", total.packetsSent, total.bytesSent, total.bytesSent / elapsed / 1024);
+	std::cout << fmt::format("received:   {:d} messages, {:d} bytes, {:.1f} KB/s\n", total.packetsReceived, total.bytesReceived, total.bytesReceived / elapsed / 1024);
+	std::cout << fmt::format("response:   p50 {:d} us, p95 {:d} us, p99 {:d} us, max {:d} us\n", percentile(total.responseMicroseconds, 0.50),
+	                         percentile(total.responseMicroseconds, 0.95), percentile(total.responseMicroseconds, 0.99),
+	                         total.responseMicroseconds.empty() ? 0 : total.responseMicroseconds.back());
+
+	const auto after = queryServerPerformance(options.host, options.statusPort);
+	if (before && after) {
+		const ServerPerformance run = *after - *before;
+		std::cout << fmt::format("dispatcher: {:d} ticks, {:d} tasks, {:.1f}% busy, {:.1f} us per tick (max {:d} us since startup)\n", run.ticks, run.tasks,
+		                         run.busyMicroseconds / (elapsed * 1e4), run.ticks ? double(run.busyMicroseconds) / run.ticks : 0.0, run.maxTickMicroseconds);
+		std::cout << fmt::format("task wait:  {:.1f} us average (max {:d} us since startup)\n", run.tasks ? double(run.waitMicroseconds) / run.tasks : 0.0,
+		                         run.maxWaitMicroseconds);
+	} else {
+		std::cout << "dispatcher: unavailable, the status port did not answer (statusPerformanceInfo must be enabled)" << std::endl;
+	}
+	return loggedIn == sessions.size() ? 0 : 2;
+}
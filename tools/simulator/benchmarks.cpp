@@ -0,0 +1,31 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+
+const std::vector<Benchmarks::Case>& Benchmarks::getCases()
+{
+	static const std::vector<Case> cases {
+		{"checksum", "adler-32 and xtea over packet sizes, separate passes against the fused one", false, checksum},
+		{"dispatcher", "task queueing and execution on the dispatcher", false, dispatcher},
+		{"loot", "random draws and the loot drop of the first --monster", true, loot},
+		{"los", "line of sight around --center, against the stepped line it replaced", true, lineOfSight},
+		{"map", "tile lookups on the whole map and spectator scans around --center", true, map},
+		{"market", "order book creation, browsing and accepting with synthetic offers", false, market},
+		{"ratelimit", "connection rate limiter under 100k distinct addresses, a sustained flood and every core", false, rateLimit},
+		{"spellwords", "chat lines against the loaded instant spells, the words index and the scan it replaced", true, spellWords},
+	};
+	return cases;
+}
+
+const Benchmarks::Case* Benchmarks::getCase(std::string_view name)
+{
+	for (const Case& benchmark : getCases()) {
+		if (benchmark.name == name) {
+			return &benchmark;
+		}
+	}
+	return nullptr;
+}
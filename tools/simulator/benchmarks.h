@@ -0,0 +1,73 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_BENCHMARKS_H
+#define FS_TOOLS_BENCHMARKS_H
+
+#include "position.h"
+
+#include <fmt/format.h>
+
+/** Micro-benchmarks of single hot paths, run with --bench instead of a
+ * simulation. Cases that need the datapack or the map run after the world
+ * is loaded, the rest run on their own.
+ */
+namespace Benchmarks {
+
+struct Options
+{
+	// 0 lets every case pick its own count
+	uint64_t iterations = 0;
+	Position center;
+	uint16_t radius = 20;
+	// the first --monster, for the cases that need a monster type
+	std::string monsterName = "rat";
+
+	uint64_t iterationsOr(uint64_t fallback) const {
+		return iterations != 0 ? iterations : fallback;
+	}
+};
+
+struct Case
+{
+	std::string_view name;
+	std::string_view description;
+	bool needsWorld;
+	void (*run)(const Options& options);
+};
+
+const std::vector<Case>& getCases();
+const Case* getCase(std::string_view name);
+
+// results are added here so the measured work can't be optimized away
+inline volatile uint64_t sink = 0;
+
+// times iterations calls of f(i) and prints the cost of one call
+template <typename F>
+void measure(std::string_view label, uint64_t iterations, F&& f)
+{
+	uint64_t result = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < iterations; ++i) {
+		result += static_cast<uint64_t>(f(i));
+	}
+	const auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	sink = sink + result;
+
+	const double perCall = iterations != 0 ? nanoseconds / iterations : 0.0;
+	std::cout << fmt::format("  {:<44} {:>12.1f} ns/op {:>14.0f} ops/s", label, perCall, perCall > 0 ? 1e9 / perCall : 0.0) << std::endl;
+}
+
+// the cases, one per hot path
+void checksum(const Options& options);
+void dispatcher(const Options& options);
+void lineOfSight(const Options& options);
+void loot(const Options& options);
+void map(const Options& options);
+void market(const Options& options);
+void rateLimit(const Options& options);
+void spellWords(const Options& options);
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "const.h"
+#include "tools.h"
+#include "xtea.h"
+
+namespace {
+
+// from a small status answer up to the largest message, all multiples of the xtea block
+constexpr std::array<size_t, 6> CHECKSUM_PACKET_SIZES = {16, 128, 1024, 4096, 16384, NETWORKMESSAGE_MAXSIZE & ~size_t{7}};
+constexpr uint64_t CHECKSUM_BYTES_PER_SIZE = 256 * 1024 * 1024;
+
+// the byte at a time loop adlerChecksum used before the SIMD versions
+uint32_t adlerBytewise(const uint8_t* data, size_t length)
+{
+	constexpr uint32_t ADLER_MOD = 65521;
+	uint32_t a = 1, b = 0;
+	for (size_t i = 0; i < length; ++i) {
+		a = (a + data[i]) % ADLER_MOD;
+		b = (b + a) % ADLER_MOD;
+	}
+	return (b << 16) | a;
+}
+
+}
+
+void Benchmarks::checksum(const Options& options)
+{
+	const xtea::round_keys key = xtea::expand_key({0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210});
+
+	for (const size_t size : CHECKSUM_PACKET_SIZES) {
+		std::vector<uint8_t> packet(size);
+		for (auto& byte : packet) {
+			byte = static_cast<uint8_t>(uniform_random(0, 0xFF));
+		}
+
+		// both paths must leave the same bytes and report the same checksum
+		std::vector<uint8_t> separate = packet;
+		std::vector<uint8_t> fused = packet;
+		xtea::encrypt(separate.data(), separate.size(), key);
+		const uint32_t separateChecksum = adlerChecksum(separate.data(), separate.size());
+		const uint32_t fusedChecksum = xtea::encrypt_checksum(fused.data(), fused.size(), key);
+		const bool identical = separate == fused && separateChecksum == fusedChecksum && separateChecksum == adlerBytewise(separate.data(), separate.size());
+		std::cout << fmt::format("  {:d} byte packets: output {}", size, identical ? "identical" : "DIFFERS") << std::endl;
+
+		const uint64_t iterations = options.iterationsOr(std::max<uint64_t>(1, CHECKSUM_BYTES_PER_SIZE / size));
+		measure(fmt::format("{:d} bytes, bytewise adler", size), iterations, [&](uint64_t) { return adlerBytewise(packet.data(), packet.size()); });
+		measure(fmt::format("{:d} bytes, adlerChecksum", size), iterations, [&](uint64_t) { return adlerChecksum(packet.data(), packet.size()); });
+		measure(fmt::format("{:d} bytes, encrypt then adlerChecksum", size), iterations, [&](uint64_t) {
+			xtea::encrypt(separate.data(), separate.size(), key);
+			return adlerChecksum(separate.data(), separate.size());
+		});
+		measure(fmt::format("{:d} bytes, encrypt_checksum", size), iterations, [&](uint64_t) {
+			return xtea::encrypt_checksum(fused.data(), fused.size(), key);
+		});
+	}
+}
@@ -0,0 +1,28 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "tasks.h"
+
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+constexpr uint64_t DISPATCHER_BATCH_SIZE = 1000;
+
+}
+
+void Benchmarks::dispatcher(const Options& options)
+{
+	// the fixed cost every game action pays: queueing a task and running it
+	uint64_t counter = 0;
+	measure(fmt::format("addTask + runPending, {:d} tasks per batch", DISPATCHER_BATCH_SIZE), options.iterationsOr(2'000), [&](uint64_t) {
+		for (uint64_t task = 0; task < DISPATCHER_BATCH_SIZE; ++task) {
+			g_dispatcher.addTask(createTask([&counter]() { ++counter; }));
+		}
+		return g_dispatcher.runPending();
+	});
+	sink = sink + counter;
+}
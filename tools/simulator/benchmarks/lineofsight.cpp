@@ -0,0 +1,108 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "game.h"
+
+extern Game g_game;
+
+namespace {
+
+constexpr size_t SIGHT_PAIRS = 4096;
+constexpr size_t SIGHT_TARGETS_PER_ORIGIN = 32;
+
+// the stepped line checkSightLine walked before the ray tables, one tile lookup per cell
+bool steppedSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+{
+	if (x0 == x1 && y0 == y1) {
+		return true;
+	}
+
+	const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+	if (steep) {
+		std::swap(x0, y0);
+		std::swap(x1, y1);
+	}
+	if (x0 > x1) {
+		std::swap(x0, x1);
+		std::swap(y0, y1);
+	}
+
+	const float dx = x1 - x0;
+	const float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
+	float yi = y0 + slope;
+	for (uint16_t x = x0 + 1; x < x1; ++x) {
+		const auto y = static_cast<uint16_t>(std::floor(yi + 0.1));
+		if (!(steep ? g_game.map.isTileClear(y, x, z) : g_game.map.isTileClear(x, y, z))) {
+			return false;
+		}
+		yi += slope;
+	}
+	return true;
+}
+
+Position randomOffset(const Position& origin, int32_t range)
+{
+	return Position(static_cast<uint16_t>(origin.x + uniform_random(-range, range)), static_cast<uint16_t>(origin.y + uniform_random(-range, range)), origin.z);
+}
+
+}
+
+void Benchmarks::lineOfSight(const Options& options)
+{
+	// origins around the center, targets anywhere in their viewport
+	std::vector<std::pair<Position, Position>> pairs;
+	pairs.reserve(SIGHT_PAIRS);
+	for (size_t i = 0; i < SIGHT_PAIRS; ++i) {
+		const Position origin = randomOffset(options.center, options.radius);
+		pairs.emplace_back(origin, randomOffset(origin, Map::maxViewportX));
+	}
+
+	size_t mismatches = 0;
+	for (const auto& [from, to] : pairs) {
+		if (steppedSightLine(from.x, from.y, to.x, to.y, from.z) != Map::checkSightLine(from.x, from.y, to.x, to.y, from.z)) {
+			++mismatches;
+		}
+	}
+	std::cout << fmt::format("  {:d} of {:d} sight lines differ from the stepped line", mismatches, pairs.size()) << std::endl;
+
+	const uint64_t iterations = options.iterationsOr(1'000'000);
+	measure("stepped line, tile lookup per cell", iterations, [&](uint64_t i) {
+		const auto& [from, to] = pairs[i % pairs.size()];
+		return steppedSightLine(from.x, from.y, to.x, to.y, from.z);
+	});
+	measure("Map::checkSightLine, ray tables", iterations, [&](uint64_t i) {
+		const auto& [from, to] = pairs[i % pairs.size()];
+		return Map::checkSightLine(from.x, from.y, to.x, to.y, from.z);
+	});
+	measure("Map::isSightClear", iterations, [&](uint64_t i) {
+		const auto& [from, to] = pairs[i % pairs.size()];
+		return g_game.map.isSightClear(from, to, true);
+	});
+
+	// one origin against many targets, as a monster looking over its spectators
+	std::vector<std::pair<Position, std::vector<Position>>> batches(SIGHT_PAIRS / SIGHT_TARGETS_PER_ORIGIN);
+	for (auto& [origin, targets] : batches) {
+		origin = randomOffset(options.center, options.radius);
+		for (size_t target = 0; target < SIGHT_TARGETS_PER_ORIGIN; ++target) {
+			targets.push_back(randomOffset(origin, Map::maxViewportX));
+		}
+	}
+
+	std::vector<bool> results;
+	measure(fmt::format("{:d} targets, one isSightClear each", SIGHT_TARGETS_PER_ORIGIN), iterations / SIGHT_TARGETS_PER_ORIGIN, [&](uint64_t i) {
+		const auto& [origin, targets] = batches[i % batches.size()];
+		int64_t clear = 0;
+		for (const Position& target : targets) {
+			clear += g_game.map.isSightClear(origin, target, true);
+		}
+		return clear;
+	});
+	measure(fmt::format("{:d} targets, one batch isSightClear", SIGHT_TARGETS_PER_ORIGIN), iterations / SIGHT_TARGETS_PER_ORIGIN, [&](uint64_t i) {
+		const auto& [origin, targets] = batches[i % batches.size()];
+		g_game.map.isSightClear(origin, targets, results, true);
+		return std::ranges::count(results, true);
+	});
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "container.h"
+#include "events.h"
+#include "monster.h"
+#include "monsters.h"
+
+extern Events* g_events;
+extern Monsters g_monsters;
+
+void Benchmarks::loot(const Options& options)
+{
+	const uint64_t iterations = options.iterationsOr(10'000'000);
+
+	// the draws loot, combat and spawns make, on this thread's generator
+	measure("uniform_random(1, MAX_LOOTCHANCE)", iterations, [](uint64_t) { return uniform_random(1, MAX_LOOTCHANCE); });
+	measure("normal_random(1, 100)", iterations, [](uint64_t) { return normal_random(1, 100); });
+	measure("generate_percent()", iterations, [](uint64_t) { return generate_percent(); });
+
+	// what every draw cost before: a shared mt19937 and a distribution per call
+	std::mt19937 mersenne(static_cast<uint32_t>(iterations));
+	measure("std::mt19937 + uniform_int_distribution", iterations, [&](uint64_t) {
+		return std::uniform_int_distribution<int32_t>(1, MAX_LOOTCHANCE)(mersenne);
+	});
+
+	const MonsterType* mType = g_monsters.getMonsterType(options.monsterName);
+	if (!mType) {
+		std::cout << "  unknown monster " << options.monsterName << ", loot is not measured" << std::endl;
+		return;
+	}
+
+	const auto monster = Monster::createMonster(options.monsterName);
+	const auto corpseItem = Item::CreateItem(mType->info.lookcorpse);
+	if (!monster || !corpseItem || !corpseItem->getContainer()) {
+		std::cout << "  " << options.monsterName << " has no corpse container, loot is not measured" << std::endl;
+		return;
+	}
+
+	// the drop Monster::dropLoot makes on a kill, through the onDropLoot event and Container.createLootItem
+	measure(fmt::format("loot of {} ({:d} entries) into a new corpse", options.monsterName, mType->info.lootItems.size()), options.iterationsOr(100'000), [&](uint64_t) {
+		const auto corpse = Item::CreateItem(mType->info.lookcorpse)->getContainer();
+		g_events->eventMonsterOnDropLoot(monster, corpse);
+		return corpse->size();
+	});
+}
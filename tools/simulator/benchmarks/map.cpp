@@ -0,0 +1,64 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "game.h"
+
+extern Game g_game;
+
+namespace {
+
+constexpr size_t MAP_LOOKUPS = 1 << 16;
+constexpr size_t MAP_SPECTATOR_CENTERS = 1024;
+
+}
+
+void Benchmarks::map(const Options& options)
+{
+	Map& map = g_game.map;
+	const int32_t width = std::max<int32_t>(1, map.getWidth());
+	const int32_t height = std::max<int32_t>(1, map.getHeight());
+	std::cout << fmt::format("  map of {:d}x{:d} tiles", width, height) << std::endl;
+
+	// anywhere on the map, mostly sectors without tiles, and around the center where every tile exists
+	std::vector<Position> anywhere;
+	std::vector<Position> populated;
+	anywhere.reserve(MAP_LOOKUPS);
+	populated.reserve(MAP_LOOKUPS);
+	const int32_t radius = options.radius;
+	for (size_t i = 0; i < MAP_LOOKUPS; ++i) {
+		anywhere.emplace_back(static_cast<uint16_t>(uniform_random(0, width - 1)), static_cast<uint16_t>(uniform_random(0, height - 1)),
+		                      static_cast<uint8_t>(uniform_random(0, MAP_MAX_LAYERS - 1)));
+		populated.emplace_back(static_cast<uint16_t>(options.center.x + uniform_random(-radius, radius)),
+		                       static_cast<uint16_t>(options.center.y + uniform_random(-radius, radius)), options.center.z);
+	}
+
+	const uint64_t iterations = options.iterationsOr(10'000'000);
+	measure("getTile, anywhere on the map", iterations, [&](uint64_t i) {
+		return map.getTile(anywhere[i % anywhere.size()]) != nullptr;
+	});
+	measure("getTile, around the center", iterations, [&](uint64_t i) {
+		return map.getTile(populated[i % populated.size()]) != nullptr;
+	});
+
+	// explicit ranges skip the spectator cache, so every call scans the sectors
+	const uint64_t spectatorIterations = options.iterationsOr(1'000'000);
+	const size_t centers = std::min(MAP_SPECTATOR_CENTERS, populated.size());
+	measure("getSpectators, viewport", spectatorIterations, [&](uint64_t i) {
+		SpectatorVec spectators;
+		map.getSpectators(spectators, populated[i % centers], false, false, Map::maxViewportX, Map::maxViewportX, Map::maxViewportY, Map::maxViewportY);
+		return spectators.size();
+	});
+	measure("getSpectators, viewport, multifloor", spectatorIterations, [&](uint64_t i) {
+		SpectatorVec spectators;
+		map.getSpectators(spectators, populated[i % centers], true, false, Map::maxViewportX, Map::maxViewportX, Map::maxViewportY, Map::maxViewportY);
+		return spectators.size();
+	});
+	measure("getSpectators, viewport, multifloor, players", spectatorIterations, [&](uint64_t i) {
+		SpectatorVec spectators;
+		map.getSpectators(spectators, populated[i % centers], true, true, Map::maxViewportX, Map::maxViewportX, Map::maxViewportY, Map::maxViewportY);
+		return spectators.size();
+	});
+}
@@ -0,0 +1,76 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "iomarket.h"
+#include "tools.h"
+
+namespace {
+
+// a busy world: many traded items with deep books, offers spread over many sellers
+constexpr uint16_t MARKET_ITEMS = 2000;
+constexpr uint32_t MARKET_OFFERS_PER_ITEM = 50;
+constexpr uint32_t MARKET_PLAYERS = 5000;
+constexpr uint16_t MARKET_FIRST_ITEM = 2000;
+constexpr uint16_t MARKET_OFFER_AMOUNT = 1000;
+
+MarketAction_t marketSide(uint64_t i)
+{
+	return (i & 1) ? MARKETACTION_SELL : MARKETACTION_BUY;
+}
+
+}
+
+void Benchmarks::market(const Options& options)
+{
+	// synthetic players, the book only keeps their id and name
+	std::vector<std::string> names;
+	names.reserve(MARKET_PLAYERS);
+	for (uint32_t player = 0; player < MARKET_PLAYERS; ++player) {
+		names.push_back(fmt::format("Trader {:d}", player));
+	}
+
+	const uint64_t offers = static_cast<uint64_t>(MARKET_ITEMS) * MARKET_OFFERS_PER_ITEM;
+	measure(fmt::format("createOffer, {:d} offers on {:d} items", offers, MARKET_ITEMS), offers, [&](uint64_t i) {
+		const uint32_t player = static_cast<uint32_t>(i % MARKET_PLAYERS);
+		const uint16_t itemId = static_cast<uint16_t>(MARKET_FIRST_ITEM + i / MARKET_OFFERS_PER_ITEM);
+		IOMarket::createOffer(player + 1, names[player], marketSide(i), itemId, MARKET_OFFER_AMOUNT, static_cast<uint32_t>(uniform_random(1, 100'000)), (i % 7) == 0);
+		return 1;
+	});
+
+	// what a player browsing an item sees, both sides of its book
+	const uint64_t iterations = options.iterationsOr(100'000);
+	measure("browse an item, getActiveOffers for buy and sell", iterations, [](uint64_t) {
+		const auto itemId = static_cast<uint16_t>(MARKET_FIRST_ITEM + uniform_random(0, MARKET_ITEMS - 1));
+		return IOMarket::getActiveOffers(MARKETACTION_BUY, itemId).size() + IOMarket::getActiveOffers(MARKETACTION_SELL, itemId).size();
+	});
+	measure("own offers, getOwnOffers for buy and sell", iterations, [](uint64_t) {
+		const auto playerId = static_cast<uint32_t>(uniform_random(1, MARKET_PLAYERS));
+		return IOMarket::getOwnOffers(MARKETACTION_BUY, playerId).size() + IOMarket::getOwnOffers(MARKETACTION_SELL, playerId).size();
+	});
+
+	// the client names an offer by timestamp and counter, as it does when accepting one
+	std::vector<std::pair<uint32_t, uint16_t>> handles;
+	for (uint32_t playerId = 1; playerId <= MARKET_PLAYERS; ++playerId) {
+		for (const MarketAction_t side : {MARKETACTION_BUY, MARKETACTION_SELL}) {
+			for (const auto& offer : IOMarket::getOwnOffers(side, playerId)) {
+				handles.emplace_back(offer.timestamp, offer.counter);
+			}
+		}
+	}
+
+	measure("accept one unit, getOfferByCounter + acceptOffer", std::min<uint64_t>(iterations, handles.size() * (MARKET_OFFER_AMOUNT - 1)), [&](uint64_t i) {
+		const auto& [timestamp, counter] = handles[i % handles.size()];
+		const MarketOfferEx offer = IOMarket::getOfferByCounter(timestamp, counter);
+		IOMarket::acceptOffer(offer.id, 1);
+		return offer.id;
+	});
+
+	// the write-behind batch of everything above, built on the dispatcher; nothing is sent without a database
+	measure("flush of the pending changes", 1, [](uint64_t) {
+		IOMarket::getInstance().flush();
+		return 1;
+	});
+}
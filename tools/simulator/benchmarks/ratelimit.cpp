@@ -0,0 +1,91 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "ban.h"
+#include "benchmarks.h"
+#include "tools.h"
+
+namespace {
+
+constexpr uint32_t RATELIMIT_DISTINCT_ADDRESSES = 100'000;
+constexpr uint32_t RATELIMIT_FLOODERS = 64;
+constexpr uint32_t RATELIMIT_CLIENTS = 1000;
+// the sustained flood in simulated time, every flooder connects once a millisecond
+constexpr int64_t RATELIMIT_FLOOD_MILLISECONDS = 60 * 1000;
+constexpr uint32_t RATELIMIT_CHURN_PER_MILLISECOND = 100;
+// a regular client reconnects every 10 seconds
+constexpr int64_t RATELIMIT_CLIENT_INTERVAL = 10 * 1000;
+
+boost::asio::ip::address ratelimitAddress(uint32_t ip)
+{
+	return boost::asio::ip::address_v4(ip);
+}
+
+}
+
+void Benchmarks::rateLimit(const Options& options)
+{
+	const int64_t startTime = OTSYS_TIME();
+	auto ban = std::make_unique<Ban>();
+
+	// first sight of 100k distinct addresses, every one replaces an entry of the fixed table
+	const uint64_t iterations = options.iterationsOr(10'000'000);
+	measure(fmt::format("acceptConnection, {:d} distinct addresses", RATELIMIT_DISTINCT_ADDRESSES), iterations, [&](uint64_t i) {
+		if (i % RATELIMIT_CHURN_PER_MILLISECOND == 0) {
+			setSimulatedTime(startTime + static_cast<int64_t>(i / RATELIMIT_CHURN_PER_MILLISECOND));
+		}
+		return ban->acceptConnection(ratelimitAddress(0x0A000000 + static_cast<uint32_t>(i % RATELIMIT_DISTINCT_ADDRESSES)));
+	});
+
+	// a sustained flood from a few addresses hidden in a stream of new ones, while
+	// regular clients reconnect now and then: flooders must stay blocked, clients never are
+	ban = std::make_unique<Ban>();
+	uint64_t flooderAttempts = 0, flooderAccepted = 0, clientAttempts = 0, clientAccepted = 0;
+	uint32_t churn = 0;
+	const auto flood = std::chrono::steady_clock::now();
+	for (int64_t millisecond = 0; millisecond < RATELIMIT_FLOOD_MILLISECONDS; ++millisecond) {
+		setSimulatedTime(startTime + millisecond);
+		for (uint32_t flooder = 0; flooder < RATELIMIT_FLOODERS; ++flooder) {
+			++flooderAttempts;
+			flooderAccepted += ban->acceptConnection(ratelimitAddress(0xC0A80000 + flooder));
+		}
+		for (uint32_t i = 0; i < RATELIMIT_CHURN_PER_MILLISECOND; ++i) {
+			ban->acceptConnection(ratelimitAddress(0x0A000000 + (churn++ % RATELIMIT_DISTINCT_ADDRESSES)));
+		}
+		for (auto client = static_cast<uint32_t>(millisecond % RATELIMIT_CLIENT_INTERVAL); client < RATELIMIT_CLIENTS; client += RATELIMIT_CLIENT_INTERVAL) {
+			++clientAttempts;
+			clientAccepted += ban->acceptConnection(ratelimitAddress(0xAC100000 + client));
+		}
+	}
+	const auto floodSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - flood).count();
+	std::cout << fmt::format("  {:d} s flood: flooders {:d} of {:d} accepted ({:.2f}%), clients {:d} of {:d} accepted, {:.1f} ns per attempt",
+	                         RATELIMIT_FLOOD_MILLISECONDS / 1000, flooderAccepted, flooderAttempts, flooderAccepted * 100.0 / flooderAttempts, clientAccepted,
+	                         clientAttempts, floodSeconds * 1e9 / (flooderAttempts + clientAttempts + RATELIMIT_FLOOD_MILLISECONDS * RATELIMIT_CHURN_PER_MILLISECOND))
+	          << std::endl;
+
+	// acceptors on every core, each on its own addresses
+	ban = std::make_unique<Ban>();
+	const uint32_t threads = std::max(2u, std::thread::hardware_concurrency());
+	const uint64_t perThread = iterations / threads;
+	const auto concurrent = std::chrono::steady_clock::now();
+	std::vector<uint64_t> accepted(threads);
+	std::vector<std::thread> acceptors;
+	for (uint32_t thread = 0; thread < threads; ++thread) {
+		acceptors.emplace_back([&ban, &accepted, perThread, thread]() {
+			for (uint64_t i = 0; i < perThread; ++i) {
+				accepted[thread] += ban->acceptConnection(ratelimitAddress(0x0A000000 + thread * RATELIMIT_DISTINCT_ADDRESSES + static_cast<uint32_t>(i % RATELIMIT_DISTINCT_ADDRESSES)));
+			}
+		});
+	}
+	for (auto& acceptor : acceptors) {
+		acceptor.join();
+	}
+	sink = sink + std::accumulate(accepted.begin(), accepted.end(), uint64_t{0});
+	const double concurrentSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - concurrent).count();
+	std::cout << fmt::format("  {:<44} {:>12.1f} ns/op {:>14.0f} ops/s", fmt::format("acceptConnection on {:d} threads", threads),
+	                         concurrentSeconds * 1e9 / (perThread * threads), perThread * threads / concurrentSeconds) << std::endl;
+
+	setSimulatedTime(startTime);
+}
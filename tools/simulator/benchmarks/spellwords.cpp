@@ -0,0 +1,91 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "spells.h"
+#include "tools.h"
+
+extern Spells* g_spells;
+
+namespace {
+
+// what players say most of the time, none of it is a spell
+constexpr std::array<std::string_view, 8> SPELLWORDS_CHAT = {
+	"hi",
+	"anyone selling a magic plate armor? paying well",
+	"follow me, the quest entrance is north of the depot",
+	"lol",
+	"exura vita is not a spell you can use yet",
+	"utani hur? no, just walking",
+	"trade",
+	"brb, dinner",
+};
+
+// the scan every chat line went through before the words index
+const InstantSpell* spellWordsScan(std::string_view words)
+{
+	const InstantSpell* result = nullptr;
+	for (const auto& it : g_spells->getInstantSpells()) {
+		const std::string& instantSpellWords = it.second.getWords();
+		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
+			if (!result || instantSpellWords.length() > result->getWords().size()) {
+				result = &it.second;
+				if (words.length() == instantSpellWords.length()) {
+					break;
+				}
+			}
+		}
+	}
+
+	if (result && words.length() > result->getWords().length()) {
+		const size_t spellLen = result->getWords().length();
+		if (!result->getHasParam() || words.length() - spellLen < 2 || words[spellLen] != ' ') {
+			return nullptr;
+		}
+	}
+	return result;
+}
+
+}
+
+void Benchmarks::spellWords(const Options& options)
+{
+	const auto& instants = g_spells->getInstantSpells();
+	if (instants.empty()) {
+		std::cout << "  no instant spells are loaded, spell words are not measured" << std::endl;
+		return;
+	}
+
+	// one chat line in four is a spell, some of them shouted in upper case or with a parameter
+	std::vector<std::string> lines;
+	for (const auto& it : instants) {
+		const InstantSpell& instant = it.second;
+		std::string words = instant.getWords();
+		if (instant.getHasParam()) {
+			words += " \"Bubble";
+		} else if (lines.size() % 3 == 0) {
+			words = asUpperCaseString(words);
+		}
+		lines.push_back(std::move(words));
+		for (size_t i = 0; i < 3; ++i) {
+			lines.emplace_back(SPELLWORDS_CHAT[lines.size() % SPELLWORDS_CHAT.size()]);
+		}
+	}
+
+	size_t spells = 0, mismatches = 0;
+	for (const std::string& line : lines) {
+		const InstantSpell* indexed = g_spells->getInstantSpell(line);
+		spells += indexed != nullptr;
+		mismatches += indexed != spellWordsScan(line);
+	}
+	std::cout << fmt::format("  {:d} instant spells, {:d} lines of which {:d} are spells, {:d} differ from the scan", instants.size(), lines.size(), spells,
+	                         mismatches)
+	          << std::endl;
+
+	// the match playerSaySpell makes before casting, casting itself needs a player and is left out
+	const uint64_t iterations = options.iterationsOr(1'000'000);
+	measure("scan of every instant spell", iterations, [&](uint64_t i) { return spellWordsScan(lines[i % lines.size()]) != nullptr; });
+	measure("getInstantSpell, words index", iterations, [&](uint64_t i) { return g_spells->getInstantSpell(lines[i % lines.size()]) != nullptr; });
+}
@@ -0,0 +1,232 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "simulation.h"
+#include "game.h"
+#include "monster.h"
+#include "scheduler.h"
+
+#include <fmt/format.h>
+
+extern Game g_game;
+extern Monsters g_monsters;
+extern Vocations g_vocations;
+
+namespace {
+
+// synthetic players act once per second, casting and retargeting on a slower beat
+constexpr uint32_t PLAYER_INPUT_INTERVAL = 1000;
+constexpr uint32_t PLAYER_SPELL_TICKS = 2;
+constexpr int32_t PLAYER_TARGET_RANGE = 7;
+
+// killed extra monsters come back on this beat with --respawn
+constexpr uint32_t MONSTER_RESPAWN_INTERVAL = 5000;
+
+constexpr uint32_t SIMULATED_MINUTE = 60 * 1000;
+
+uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point since)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+}
+
+Position Simulation::randomPosition() const
+{
+	const int32_t radius = options.radius;
+	return Position(static_cast<uint16_t>(options.center.x + uniform_random(-radius, radius)),
+	                static_cast<uint16_t>(options.center.y + uniform_random(-radius, radius)), options.center.z);
+}
+
+void Simulation::populate()
+{
+	addMonsters();
+	addPlayers();
+	std::cout << fmt::format(">> Placed {:d} monsters and {:d} synthetic players around {:d}, {:d}, {:d}", monstersPlaced, playersPlaced, options.center.x,
+	                         options.center.y, options.center.z) << std::endl;
+}
+
+void Simulation::addMonsters()
+{
+	if (options.monsterNames.empty()) {
+		return;
+	}
+
+	monsterIds.assign(options.monsters, 0);
+	for (size_t i = 0; i < options.monsters; ++i) {
+		const auto& name = options.monsterNames[i % options.monsterNames.size()];
+		if (!g_monsters.getMonsterType(name)) {
+			std::cout << "[Warning - Simulation::addMonsters] Unknown monster " << name << std::endl;
+			return;
+		}
+
+		if (const auto monster = placeMonster(name)) {
+			monsterIds[i] = monster->getID();
+			++monstersPlaced;
+		}
+	}
+
+	if (options.respawn) {
+		scheduleRespawn();
+	}
+}
+
+MonsterPtr Simulation::placeMonster(const std::string& name)
+{
+	const auto monster = Monster::createMonster(name);
+	if (!monster || !g_game.placeCreature(monster, randomPosition(), true)) {
+		return nullptr;
+	}
+	return monster;
+}
+
+void Simulation::scheduleRespawn()
+{
+	g_scheduler.addEvent(createSchedulerTask(MONSTER_RESPAWN_INTERVAL, [this]() { respawnMonsters(); }));
+}
+
+void Simulation::respawnMonsters()
+{
+	for (size_t i = 0; i < monsterIds.size(); ++i) {
+		if (monsterIds[i] != 0 && g_game.getMonsterByID(monsterIds[i])) {
+			continue;
+		}
+
+		if (const auto monster = placeMonster(options.monsterNames[i % options.monsterNames.size()])) {
+			monsterIds[i] = monster->getID();
+			++monstersRespawned;
+		}
+	}
+	scheduleRespawn();
+}
+
+void Simulation::addPlayers()
+{
+	const Vocation* vocation = g_vocations.getVocation(options.vocation);
+	Group* group = g_game.groups.getGroup(1);
+	const auto& towns = g_game.map.towns.getTowns();
+	if (!vocation || !group || towns.empty()) {
+		std::cout << "[Warning - Simulation::addPlayers] Synthetic players need vocation " << options.vocation << ", group 1 and a town" << std::endl;
+		return;
+	}
+
+	// stats as a character of that level would have gained them, see Player::addExperience
+	const uint32_t gainedLevels = options.level > 8 ? options.level - 8 : 0;
+	for (size_t i = 0; i < options.players; ++i) {
+		const auto player = Player::makePlayer(nullptr);
+		player->setName(fmt::format("Simulated {:d}", i + 1));
+		player->setGUID(static_cast<uint32_t>(i + 1));
+		player->setGroup(group);
+		player->setVocation(options.vocation);
+		player->setSex(PLAYERSEX_MALE);
+		player->setTown(towns.begin()->second);
+
+		player->level = options.level;
+		player->experience = Player::getExpForLevel(options.level);
+		player->healthMax = 185 + gainedLevels * vocation->getHPGain();
+		player->health = player->healthMax;
+		player->manaMax = 90 + gainedLevels * vocation->getManaGain();
+		player->mana = player->manaMax;
+		player->capacity = (400 + gainedLevels * vocation->getCapGain()) * 100;
+		player->loginPosition = randomPosition();
+
+		if (!g_game.placeCreature(player, player->loginPosition, true)) {
+			continue;
+		}
+
+		++playersPlaced;
+		g_game.playerSetFightModes(player->getID(), FIGHTMODE_ATTACK, true, false);
+		schedulePlayerInput(player->getID(), static_cast<uint32_t>(i));
+	}
+}
+
+void Simulation::schedulePlayerInput(uint32_t playerId, uint32_t tick)
+{
+	g_scheduler.addEvent(createSchedulerTask(PLAYER_INPUT_INTERVAL, [this, playerId, tick]() { playerInput(playerId, tick); }));
+}
+
+void Simulation::playerInput(uint32_t playerId, uint32_t tick)
+{
+	const auto player = g_game.getPlayerByID(playerId);
+	if (!player) {
+		// died or got kicked, a real client would have to log in again
+		return;
+	}
+
+	// answer the ping a real client would have answered
+	player->lastPong = OTSYS_TIME();
+
+	const auto target = player->getAttackedCreature();
+	if (!target || target->isRemoved() || target->getHealth() <= 0) {
+		SpectatorVec spectators;
+		g_game.map.getSpectators(spectators, player->getPosition(), false, false, PLAYER_TARGET_RANGE, PLAYER_TARGET_RANGE, PLAYER_TARGET_RANGE,
+		                         PLAYER_TARGET_RANGE);
+		for (const auto& spectator : spectators) {
+			if (spectator->getMonster() && spectator->getHealth() > 0) {
+				g_game.playerSetAttackedCreature(playerId, spectator->getID());
+				break;
+			}
+		}
+	}
+
+	if (player->getAttackedCreature()) {
+		if (!options.spell.empty() && tick % PLAYER_SPELL_TICKS == 0) {
+			g_game.playerSay(playerId, 0, TALKTYPE_SAY, "", options.spell);
+		}
+	} else {
+		g_game.playerMove(playerId, static_cast<Direction>(uniform_random(DIRECTION_NORTH, DIRECTION_WEST)));
+	}
+
+	schedulePlayerInput(playerId, tick + 1);
+}
+
+void Simulation::run()
+{
+	std::cout << fmt::format(">> Simulating {:d} minutes", options.minutes) << std::endl;
+	std::cout << fmt::format("{:>6} {:>9} {:>8} {:>9}", "minute", "wall ms", "speedup", "tasks");
+	for (size_t i = 0; i < Profiler::SUBSYSTEMS; ++i) {
+		std::cout << fmt::format(" {:>14}", Profiler::getName(static_cast<Subsystem>(i)));
+	}
+	std::cout << fmt::format(" {:>9}", "other") << std::endl;
+
+	int64_t minuteEnd = OTSYS_TIME();
+	current.profile = Profiler::getTotals();
+	Sample last = current;
+	for (uint32_t minute = 1; minute <= options.minutes; ++minute) {
+		minuteEnd += SIMULATED_MINUTE;
+		const auto wallStart = std::chrono::steady_clock::now();
+
+		do {
+			const auto start = std::chrono::steady_clock::now();
+			current.tasks += g_dispatcher.runPending();
+			g_utility_boss.runPending();
+			current.dispatcherNanoseconds += elapsedNanoseconds(start);
+		} while (g_scheduler.runNextEvent(minuteEnd));
+
+		current.profile = Profiler::getTotals();
+		report(minute, current, last, std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count());
+		last = current;
+	}
+
+	if (options.respawn) {
+		std::cout << fmt::format(">> Respawned {:d} monsters", monstersRespawned) << std::endl;
+	}
+}
+
+void Simulation::report(uint32_t minute, const Sample& now, const Sample& last, double wallSeconds) const
+{
+	std::cout << fmt::format("{:>6d} {:>9.1f} {:>7.0f}x {:>9d}", minute, wallSeconds * 1e3, wallSeconds > 0 ? 60.0 / wallSeconds : 0.0, now.tasks - last.tasks);
+
+	// milliseconds of CPU time and how often the subsystem was entered
+	uint64_t profiled = 0;
+	for (size_t i = 0; i < Profiler::SUBSYSTEMS; ++i) {
+		const uint64_t nanoseconds = now.profile.nanoseconds[i] - last.profile.nanoseconds[i];
+		profiled += nanoseconds;
+		std::cout << fmt::format(" {:>7.1f}/{:<6d}", nanoseconds / 1e6, now.profile.calls[i] - last.profile.calls[i]);
+	}
+
+	const uint64_t busy = now.dispatcherNanoseconds - last.dispatcherNanoseconds;
+	std::cout << fmt::format(" {:>9.1f}", (busy > profiled ? busy - profiled : 0) / 1e6) << std::endl;
+}
@@ -0,0 +1,71 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TOOLS_SIMULATION_H
+#define FS_TOOLS_SIMULATION_H
+
+#include "declarations.h"
+#include "position.h"
+#include "profiler.h"
+
+/** Runs a loaded world in simulated time: the scheduler hands out events in
+ * due order, the dispatcher runs them on this thread and the clock jumps
+ * straight to the next event instead of sleeping.
+ */
+class Simulation
+{
+	public:
+		struct Options
+		{
+			uint32_t minutes = 10;
+			uint64_t seed = 1;
+			// extra monsters and synthetic players around the center, on top of the map spawns
+			size_t monsters = 0;
+			std::vector<std::string> monsterNames;
+			// replace killed extra monsters, keeps fights going for the whole run
+			bool respawn = false;
+			size_t players = 0;
+			uint16_t vocation = 4;
+			uint32_t level = 50;
+			std::string spell;
+			Position center;
+			uint16_t radius = 20;
+		};
+
+		explicit Simulation(Options options) : options(std::move(options)) {}
+
+		// non-copyable
+		Simulation(const Simulation&) = delete;
+		Simulation& operator=(const Simulation&) = delete;
+
+		void populate();
+		void run();
+
+	private:
+		struct Sample
+		{
+			Profiler::Totals profile;
+			uint64_t dispatcherNanoseconds = 0;
+			uint64_t tasks = 0;
+		};
+
+		Position randomPosition() const;
+		void addMonsters();
+		MonsterPtr placeMonster(const std::string& name);
+		void scheduleRespawn();
+		void respawnMonsters();
+		void addPlayers();
+		void schedulePlayerInput(uint32_t playerId, uint32_t tick);
+		void playerInput(uint32_t playerId, uint32_t tick);
+		void report(uint32_t minute, const Sample& now, const Sample& last, double wallSeconds) const;
+
+		Options options;
+		size_t monstersPlaced = 0;
+		size_t monstersRespawned = 0;
+		// ids of the extra monsters, 0 where placing failed
+		std::vector<uint32_t> monsterIds;
+		size_t playersPlaced = 0;
+		Sample current;
+};
+
+#endif
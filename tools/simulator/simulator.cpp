@@ -0,0 +1,281 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Offline world-tick simulator: loads the datapack and map like the server
+// does, but without listening sockets or a database, then runs the game in
+// fast-forward simulated time and reports CPU time per subsystem for every
+// simulated minute. With --bench it runs micro-benchmarks of single hot
+// paths instead.
+
+#include "otpch.h"
+
+#include "benchmarks.h"
+#include "simulation.h"
+
+#include "augments.h"
+#include "configmanager.h"
+#include "console.h"
+#include "databasetasks.h"
+#include "game.h"
+#include "monsters.h"
+#include "outfit.h"
+#include "rsa.h"
+#include "scheduler.h"
+#include "script.h"
+#include "scriptmanager.h"
+#include "zones.h"
+
+#include <fmt/format.h>
+
+DatabaseTasks g_databaseTasks;
+Dispatcher g_dispatcher;
+Dispatcher g_utility_boss;
+Scheduler g_scheduler;
+
+Game g_game;
+ConfigManager g_config;
+Monsters g_monsters;
+Vocations g_vocations;
+extern Scripts* g_scripts;
+RSA g_RSA;
+
+namespace {
+
+// fixed start so OTSYS_TIME based state is the same on every run
+constexpr int64_t SIMULATION_EPOCH = 1'700'000'000'000;
+
+void printUsage()
+{
+	std::cout << "Usage: simulator [options]\n"
+	          << "  --config <file>        server config, the datapack and map are taken from it (config.lua)\n"
+	          << "  --minutes <n>          simulated minutes (10)\n"
+	          << "  --seed <n>             random seed, same seed and options give the same run (1)\n"
+	          << "  --center <x,y,z>       center of the populated area (temple of the first town)\n"
+	          << "  --radius <n>           radius of the populated area (20)\n"
+	          << "  --monsters <n>         extra monsters besides the map spawns (0)\n"
+	          << "  --monster <name>       monster type of the extra monsters, may be repeated (rat)\n"
+	          << "  --respawn              place killed extra monsters again, e.g. --monsters 50 --monster dragon --respawn\n"
+	          << "  --players <n>          synthetic players that walk and attack nearby monsters (0)\n"
+	          << "  --vocation <id>        vocation of the synthetic players (4)\n"
+	          << "  --level <n>            level of the synthetic players (50)\n"
+	          << "  --spell <words>        spell the synthetic players cast while attacking\n"
+	          << "  --bench <name>         run a benchmark instead of a simulation, \"all\" runs every one, \"list\" lists them\n"
+	          << "  --iterations <n>       iterations of every benchmark measurement (chosen per benchmark)\n";
+}
+
+bool parseOptions(int argc, char** argv, Simulation::Options& options, std::optional<Position>& center, std::string& bench, Benchmarks::Options& benchOptions)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		auto value = [&]() -> std::string {
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("missing value for " + arg);
+			}
+			return argv[++i];
+		};
+
+		if (arg == "--config") {
+			g_config.setString(ConfigManager::CONFIG_FILE, value());
+		} else if (arg == "--minutes") {
+			options.minutes = std::max<uint32_t>(1, std::stoul(value()));
+		} else if (arg == "--seed") {
+			options.seed = std::stoull(value());
+		} else if (arg == "--center") {
+			const std::string text = value();
+			const auto parts = explodeString(text, ",");
+			if (parts.size() != 3) {
+				throw std::invalid_argument("--center expects x,y,z");
+			}
+			center = Position(static_cast<uint16_t>(std::stoul(std::string(parts[0]))), static_cast<uint16_t>(std::stoul(std::string(parts[1]))),
+			                  static_cast<uint8_t>(std::stoul(std::string(parts[2]))));
+		} else if (arg == "--radius") {
+			options.radius = static_cast<uint16_t>(std::stoul(value()));
+		} else if (arg == "--monsters") {
+			options.monsters = std::stoul(value());
+		} else if (arg == "--monster") {
+			options.monsterNames.push_back(value());
+		} else if (arg == "--respawn") {
+			options.respawn = true;
+		} else if (arg == "--players") {
+			options.players = std::stoul(value());
+		} else if (arg == "--vocation") {
+			options.vocation = static_cast<uint16_t>(std::stoul(value()));
+		} else if (arg == "--level") {
+			options.level = std::max<uint32_t>(1, std::stoul(value()));
+		} else if (arg == "--spell") {
+			options.spell = value();
+		} else if (arg == "--bench") {
+			bench = value();
+		} else if (arg == "--iterations") {
+			benchOptions.iterations = std::stoull(value());
+		} else {
+			return false;
+		}
+	}
+
+	if (options.monsterNames.empty()) {
+		options.monsterNames.emplace_back("rat");
+	}
+	return true;
+}
+
+// the benchmarks named by --bench, empty if the name is unknown
+std::vector<const Benchmarks::Case*> selectBenchmarks(const std::string& bench)
+{
+	std::vector<const Benchmarks::Case*> selected;
+	if (bench == "all") {
+		for (const auto& benchmark : Benchmarks::getCases()) {
+			selected.push_back(&benchmark);
+		}
+	} else if (const auto benchmark = Benchmarks::getCase(bench)) {
+		selected.push_back(benchmark);
+	}
+	return selected;
+}
+
+void runBenchmarks(const std::vector<const Benchmarks::Case*>& selected, const Benchmarks::Options& options)
+{
+	for (const auto benchmark : selected) {
+		std::cout << ">> Benchmark " << benchmark->name << ": " << benchmark->description << std::endl;
+		benchmark->run(options);
+	}
+}
+
+// the data part of mainLoader in otserv.cpp, without database and services
+bool loadWorld()
+{
+	if (!g_config.load()) {
+		std::cout << "[Error] Unable to load " << g_config.getString(ConfigManager::CONFIG_FILE) << std::endl;
+		return false;
+	}
+
+	std::string worldType = asLowerCaseString(g_config.getString(ConfigManager::WORLD_TYPE));
+	if (worldType == "no-pvp") {
+		g_game.setWorldType(WORLD_TYPE_NO_PVP);
+	} else if (worldType == "pvp-enforced") {
+		g_game.setWorldType(WORLD_TYPE_PVP_ENFORCED);
+	} else {
+		g_game.setWorldType(WORLD_TYPE_PVP);
+	}
+
+	if (!g_vocations.loadFromToml()) {
+		std::cout << "[Error] Unable to load vocations" << std::endl;
+		return false;
+	}
+
+	if (!Item::items.loadFromDat(g_config.getString(ConfigManager::ASSETS_DAT_PATH)) || !Item::items.loadFromToml()) {
+		std::cout << "[Error] Unable to load items" << std::endl;
+		return false;
+	}
+
+	if (!ScriptingManager::getInstance().loadScriptSystems() || !g_scripts->loadScripts("scripts", false, false)) {
+		std::cout << "[Error] Unable to load scripts" << std::endl;
+		return false;
+	}
+
+	if (!Outfits::getInstance().load()) {
+		std::cout << "[Error] Unable to load outfits" << std::endl;
+		return false;
+	}
+
+	if (!g_monsters.loadFromXml() || !g_scripts->loadScripts("monster", false, false)) {
+		std::cout << "[Error] Unable to load monsters" << std::endl;
+		return false;
+	}
+
+	Zones::load();
+	Augments::loadAll();
+
+	std::cout << ">> Loading map " << g_config.getString(ConfigManager::MAP_NAME) << std::endl;
+	if (!g_game.loadMainMap(g_config.getString(ConfigManager::MAP_NAME))) {
+		return false;
+	}
+
+	g_game.setGameState(GAME_STATE_INIT);
+	g_game.start(nullptr);
+	g_game.setGameState(GAME_STATE_NORMAL);
+	return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	Simulation::Options options;
+	std::optional<Position> center;
+	std::string bench;
+	Benchmarks::Options benchOptions;
+	try {
+		if (!parseOptions(argc, argv, options, center, bench, benchOptions)) {
+			printUsage();
+			return 1;
+		}
+	} catch (const std::exception& e) {
+		std::cout << "[Error] " << e.what() << std::endl;
+		printUsage();
+		return 1;
+	}
+
+	if (bench == "list") {
+		for (const auto& benchmark : Benchmarks::getCases()) {
+			std::cout << fmt::format("{:<16} {}{}", benchmark.name, benchmark.description, benchmark.needsWorld ? " (loads the world)" : "") << std::endl;
+		}
+		return 0;
+	}
+
+	const auto benchmarks = selectBenchmarks(bench);
+	if (!bench.empty() && benchmarks.empty()) {
+		std::cout << "[Error] Unknown benchmark " << bench << ", --bench list shows them" << std::endl;
+		return 1;
+	}
+
+	BlackTek::Console::Initialize();
+
+	// everything runs on this thread, the scheduler only orders events by simulated time
+	g_dispatcher.startInline();
+	g_utility_boss.startInline();
+	g_scheduler.startSimulation(SIMULATION_EPOCH);
+	setRandomSeed(options.seed);
+	// the profiler's own bookkeeping would be part of every benchmark measurement
+	Profiler::setEnabled(bench.empty());
+
+	if (!benchmarks.empty() && std::ranges::none_of(benchmarks, &Benchmarks::Case::needsWorld)) {
+		runBenchmarks(benchmarks, benchOptions);
+		g_scheduler.shutdown();
+		BlackTek::Console::Shutdown();
+		return 0;
+	}
+
+	if (!loadWorld()) {
+		BlackTek::Console::Shutdown();
+		return 1;
+	}
+
+	if (center) {
+		options.center = *center;
+	} else if (const auto& towns = g_game.map.towns.getTowns(); !towns.empty()) {
+		options.center = towns.begin()->second->getTemplePosition();
+	}
+
+	// loading queues startup tasks, they belong to the load and not to the first minute
+	g_dispatcher.runPending();
+	g_utility_boss.runPending();
+
+	if (!benchmarks.empty()) {
+		benchOptions.center = options.center;
+		benchOptions.radius = options.radius;
+		benchOptions.monsterName = options.monsterNames.front();
+		runBenchmarks(benchmarks, benchOptions);
+		g_scheduler.shutdown();
+		BlackTek::Console::Shutdown();
+		return 0;
+	}
+
+	Simulation simulation(std::move(options));
+	simulation.populate();
+	simulation.run();
+
+	g_scheduler.shutdown();
+	BlackTek::Console::Shutdown();
+	return 0;
+}